@@ -111,6 +111,7 @@ PdfAnnotation& PdfAnnotationCollection::createAnnotation(const type_info& typeIn
 
 PdfAnnotation& PdfAnnotationCollection::addAnnotation(unique_ptr<PdfAnnotation>&& annot)
 {
+    m_Page->ensureNotFlushed();
     initAnnotations();
     if (m_annotArray == nullptr)
         m_annotArray = &m_Page->GetDictionary().AddKey("Annots", PdfArray()).GetArray();
@@ -0,0 +1,123 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <pdfmm/private/PdfDeclarationsPrivate.h>
+#include "PdfArena.h"
+
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+using namespace mm;
+
+constexpr size_t ARENA_CHUNK_SIZE = 256 * 1024;
+// Bigger allocations are served by the global heap
+constexpr size_t MAX_ARENA_ALLOCATION_SIZE = ARENA_CHUNK_SIZE / 16;
+
+namespace
+{
+    // Every allocation is prefixed by the arena it belongs
+    // to, or nullptr if it was allocated from the global heap
+    struct alignas(max_align_t) AllocationHeader
+    {
+        PdfArena* Arena;
+    };
+
+    // The chunk where the current thread allocates
+    struct ThreadChunk
+    {
+        uint64_t ArenaId;
+        char* Cursor;
+        size_t Remaining;
+    };
+}
+
+static atomic<uint64_t> s_nextArenaId(1);
+static thread_local PdfArena* s_currentArena = nullptr;
+static thread_local ThreadChunk s_threadChunk = { 0, nullptr, 0 };
+
+PdfArena::PdfArena()
+    : m_id(s_nextArenaId.fetch_add(1, memory_order_relaxed))
+{
+}
+
+PdfArena::~PdfArena() { }
+
+void* PdfArena::AllocateObject(size_t size)
+{
+    size_t totalSize = sizeof(AllocationHeader) + size;
+    PdfArena* arena = s_currentArena;
+    void* block = nullptr;
+    if (arena != nullptr && totalSize <= MAX_ARENA_ALLOCATION_SIZE)
+    {
+        // Keep all the allocations aligned
+        totalSize = (totalSize + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+        block = arena->allocate(totalSize);
+    }
+    else
+    {
+        arena = nullptr;
+        block = ::operator new(totalSize);
+    }
+
+    auto header = new(block) AllocationHeader{ arena };
+    return header + 1;
+}
+
+void PdfArena::FreeObject(void* ptr) noexcept
+{
+    if (ptr == nullptr)
+        return;
+
+    auto header = static_cast<AllocationHeader*>(ptr) - 1;
+    if (header->Arena == nullptr)
+        ::operator delete(header);
+}
+
+PdfArena* PdfArena::GetCurrent()
+{
+    return s_currentArena;
+}
+
+size_t PdfArena::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks.size() * ARENA_CHUNK_SIZE;
+}
+
+void* PdfArena::allocate(size_t size)
+{
+    auto& chunk = s_threadChunk;
+    if (chunk.ArenaId != m_id || size > chunk.Remaining)
+    {
+        // The rest of the previous chunk of the thread is wasted
+        chunk.Cursor = allocateChunk();
+        chunk.Remaining = ARENA_CHUNK_SIZE;
+        chunk.ArenaId = m_id;
+    }
+
+    void* ret = chunk.Cursor;
+    chunk.Cursor += size;
+    chunk.Remaining -= size;
+    return ret;
+}
+
+char* PdfArena::allocateChunk()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_chunks.push_back(unique_ptr<char[]>(new char[ARENA_CHUNK_SIZE]));
+    return m_chunks.back().get();
+}
+
+PdfArenaScope::PdfArenaScope(PdfArena* arena)
+    : m_previous(s_currentArena)
+{
+    s_currentArena = arena;
+}
+
+PdfArenaScope::~PdfArenaScope()
+{
+    s_currentArena = m_previous;
+}
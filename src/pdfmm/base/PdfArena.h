@@ -0,0 +1,97 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef PDF_ARENA_H
+#define PDF_ARENA_H
+
+#include "PdfDeclarations.h"
+
+#include <mutex>
+
+namespace mm {
+
+/**
+ * A monotonic allocator for the objects of a document
+ *
+ * Memory for PdfObject instances and variant data instances
+ * (PdfArray, PdfDictionary, PdfName, PdfString...) is bump
+ * allocated in large chunks, so parsing doesn't contend on the
+ * global heap. Every thread allocates from its own chunk, so
+ * no lock is taken but when a new chunk is needed. Deleting
+ * an object doesn't free its memory: all the chunks are freed
+ * at once when the arena is destroyed, so the objects allocated
+ * from it must be deleted before.
+ *
+ * \remarks Only the object instances are allocated in the arena.
+ * The storage owned by them, such as the elements of arrays and
+ * dictionaries or the characters of names and strings, still
+ * comes from the global heap
+ */
+class PDFMM_API PdfArena final
+{
+public:
+    PdfArena();
+    ~PdfArena();
+
+    /** Allocate memory for an object. The memory is allocated from
+     * the arena set for the current thread, if any, otherwise from
+     * the global heap
+     * \see PdfArenaScope
+     */
+    static void* AllocateObject(size_t size);
+
+    /** Free memory allocated with AllocateObject. Memory
+     * allocated from an arena is freed with the arena
+     */
+    static void FreeObject(void* ptr) noexcept;
+
+    /** \returns the arena set for the current thread, or nullptr
+     */
+    static PdfArena* GetCurrent();
+
+    /** \returns the size of the chunks allocated by the arena
+     */
+    size_t GetSize() const;
+
+private:
+    PdfArena(const PdfArena&) = delete;
+    PdfArena& operator=(const PdfArena&) = delete;
+
+    void* allocate(size_t size);
+    char* allocateChunk();
+
+private:
+    // Identifies the arena in the chunks cached by the threads,
+    // as a new arena can be created at the address of a deleted one
+    uint64_t m_id;
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+};
+
+/**
+ * Set the arena used for object allocations in the current
+ * thread for the lifetime of the scope
+ */
+class PDFMM_API PdfArenaScope final
+{
+public:
+    /**
+     * \param arena the arena to use, or nullptr to
+     * allocate from the global heap
+     */
+    PdfArenaScope(PdfArena* arena);
+    ~PdfArenaScope();
+
+private:
+    PdfArenaScope(const PdfArenaScope&) = delete;
+    PdfArenaScope& operator=(const PdfArenaScope&) = delete;
+
+private:
+    PdfArena* m_previous;
+};
+
+}
+
+#endif // PDF_ARENA_H
@@ -12,8 +12,11 @@
 using namespace std;
 using namespace mm;
 
+// Size of the chunks of the streams decoded at time
+constexpr size_t ChunkSize = 65536;
+
 PdfCanvasInputDevice::PdfCanvasInputDevice(const PdfCanvas& canvas)
-    : m_eof(false), m_deviceSwitchOccurred(false)
+    : m_eof(false), m_readingStream(false), m_deviceSwitchOccurred(false)
 {
     auto contents = canvas.GetContentsObject();
     if (contents != nullptr)
@@ -180,6 +183,13 @@ bool PdfCanvasInputDevice::tryGetNextDevice(InputStreamDevice*& device)
         return true;
     }
 
+    // Continue with the next chunk of the same stream, if any
+    if (tryReadNextChunk())
+    {
+        device = m_currDevice.get();
+        return true;
+    }
+
     if (!tryPopNextDevice())
     {
         device = nullptr;
@@ -207,17 +217,46 @@ bool PdfCanvasInputDevice::tryPopNextDevice()
         if (contents == nullptr)
             continue;
 
-        contents->CopyTo(m_buffer);
-        if (m_buffer.size() == 0)
-            continue;
+        // NOTE: Reset the previous stream first, as the same
+        // stream may be listed more times in the contents
+        m_currStream = PdfObjectInputStream();
+        m_currStream = contents->GetInputStream();
+        m_readingStream = true;
+        if (m_currStream.GetMediaFilters().size() != 0)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFilter, "Unsupported expansion with media filters");
 
-        m_currDevice = std::make_unique<SpanStreamDevice>(m_buffer);
-        return true;
+        if (tryReadNextChunk())
+            return true;
     }
 
     return false;
 }
 
+// Returns true if a chunk of the current stream was
+// read, and it's available in the current device
+bool PdfCanvasInputDevice::tryReadNextChunk()
+{
+    if (!m_readingStream)
+        return false;
+
+    bool eof;
+    m_buffer.resize(ChunkSize);
+    size_t read = m_currStream.Read(m_buffer.data(), m_buffer.size(), eof);
+    m_buffer.resize(read);
+    if (eof)
+    {
+        // Release the stream as soon as possible
+        m_currStream = PdfObjectInputStream();
+        m_readingStream = false;
+    }
+
+    if (read == 0)
+        return false;
+
+    m_currDevice = std::make_unique<SpanStreamDevice>(m_buffer);
+    return true;
+}
+
 void PdfCanvasInputDevice::setEOF()
 {
     m_deviceSwitchOccurred = false;
@@ -8,6 +8,7 @@
 #define PDF_CANVAS_INPUT_DEVICE_H
 
 #include "PdfInputDevice.h"
+#include "PdfObjectStream.h"
 
 #include <list>
 
@@ -20,6 +21,9 @@ class PdfObject;
  * There are Pdfs spanning delimiters or begin/end tags into
  * contents streams. Let's create a device correctly spanning
  * I/O reads into these
+ *
+ * The streams are decoded incrementally, a chunk at time,
+ * so they are never fully loaded in memory
  */
 class PDFMM_API PdfCanvasInputDevice final : public InputStreamDevice
 {
@@ -32,6 +36,7 @@ public:
 private:
     bool tryGetNextDevice(InputStreamDevice*& device);
     bool tryPopNextDevice();
+    bool tryReadNextChunk();
     void setEOF();
 protected:
     size_t readBuffer(char* buffer, size_t size, bool& eof) override;
@@ -40,6 +45,8 @@ protected:
 private:
     bool m_eof;
     std::list<const PdfObject*> m_contents;
+    PdfObjectInputStream m_currStream;
+    bool m_readingStream;
     charbuff m_buffer;
     std::unique_ptr<InputStreamDevice> m_currDevice;
     bool m_deviceSwitchOccurred;
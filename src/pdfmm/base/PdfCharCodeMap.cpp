@@ -46,7 +46,8 @@ void PdfCharCodeMap::move(PdfCharCodeMap& map) noexcept
 {
     m_CodeUnitMap = std::move(map.m_CodeUnitMap);
     utls::move(map.m_Limits, m_Limits);
-    utls::move(map.m_MapDirty, m_MapDirty);
+    m_MapDirty.store(map.m_MapDirty.load(memory_order_relaxed), memory_order_relaxed);
+    map.m_MapDirty.store(false, memory_order_relaxed);
     utls::move(map.m_codePointMapHead, m_codePointMapHead);
     utls::move(map.m_depth, m_depth);
 }
@@ -211,7 +212,12 @@ const PdfCharCodeMap::CPMapNode* PdfCharCodeMap::findNode(const CPMapNode* node,
 
 void PdfCharCodeMap::reviseCPMap()
 {
-    if (!m_MapDirty)
+    if (!m_MapDirty.load(memory_order_acquire))
+        return;
+
+    // Check again, the map may have been revised while waiting for the lock
+    lock_guard<mutex> lock(m_cpMapMutex);
+    if (!m_MapDirty.load(memory_order_relaxed))
         return;
 
     if (m_codePointMapHead != nullptr)
@@ -252,7 +258,7 @@ void PdfCharCodeMap::reviseCPMap()
         found->CodeUnit = pair.first;
     }
 
-    m_MapDirty = false;
+    m_MapDirty.store(false, memory_order_release);
 }
 
 PdfCharCodeMap::CPMapNode* PdfCharCodeMap::findOrAddNode(CPMapNode*& node, codepoint codePoint)
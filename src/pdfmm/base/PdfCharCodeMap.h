@@ -8,6 +8,10 @@
 #define PDF_CHAR_CODE_MAP_H
 
 #include "PdfDeclarations.h"
+
+#include <atomic>
+#include <mutex>
+
 #include "PdfEncodingCommon.h"
 
 namespace mm
@@ -112,7 +116,10 @@ namespace mm
     private:
         PdfEncodingLimits m_Limits;
         CodeUnitMap m_CodeUnitMap;
-        bool m_MapDirty;
+        // The code points lookup BST is built lazily by const
+        // methods, which may be called by concurrent readers
+        std::atomic<bool> m_MapDirty;
+        std::mutex m_cpMapMutex;
         CPMapNode* m_codePointMapHead;           // Head of a BST to lookup code points
         int m_depth;
     };
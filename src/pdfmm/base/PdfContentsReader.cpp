@@ -12,10 +12,16 @@
 #include "PdfCanvasInputDevice.h"
 #include "PdfData.h"
 #include "PdfDictionary.h"
+#include "PdfStreamDevice.h"
 
 using namespace std;
 using namespace mm;
 
+// Maximum size of the decoded form contents cached by a reader
+constexpr size_t MaxCachedContentsSize = 16 * 1048576;
+
+static bool tryReadContents(const PdfObjectStream& stream, size_t maxSize, charbuff& buffer);
+
 PdfContentsReader::PdfContentsReader(const PdfCanvas& canvas,
         nullable<const PdfContentReaderArgs&> args) :
     PdfContentsReader(std::make_shared<PdfCanvasInputDevice>(canvas),
@@ -31,12 +37,13 @@ PdfContentsReader::PdfContentsReader(const shared_ptr<InputStreamDevice>& device
     m_buffer(std::make_shared<charbuff>(PdfTokenizer::BufferSize)),
     m_tokenizer(m_buffer),
     m_readingInlineImgData(false),
+    m_cachedContentsSize(0),
     m_temp{ }
 {
     if (device == nullptr)
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Device must be non null");
 
-    m_inputs.push_back({ nullptr, device, canvas });
+    m_inputs.push_back({ nullptr, device, canvas, nullptr });
 }
 
 bool PdfContentsReader::TryReadNext(PdfContent& content)
@@ -321,18 +328,18 @@ void PdfContentsReader::tryFollowXObject(PdfContent& content)
     PDFMM_ASSERT(m_inputs.back().Canvas != nullptr);
     const PdfResources* resources;
     const PdfObject* xobjraw = nullptr;
-    unique_ptr<PdfXObject> xobj;
+    const CachedXObject* cached;
     if (content.Stack.GetSize() != 1
         || !content.Stack[0].TryGetName(content.Name)
         || (resources = m_inputs.back().Canvas->GetResources()) == nullptr
         || (xobjraw = resources->GetResource("XObject", *content.Name)) == nullptr
-        || !PdfXObject::TryCreateFromObject(const_cast<PdfObject&>(*xobjraw), xobj))
+        || (cached = getXObject(*xobjraw)) == nullptr)
     {
         content.Warnings |= PdfContentWarnings::InvalidXObject;
         return;
     }
 
-    content.XObject.reset(xobj.release());
+    content.XObject = cached->XObject;
     content.Type = PdfContentType::DoXObject;
 
     if (isCalledRecursively(xobjraw))
@@ -344,13 +351,59 @@ void PdfContentsReader::tryFollowXObject(PdfContent& content)
     if (content.XObject->GetType() == PdfXObjectType::Form
         && (m_args.Flags & PdfContentReaderFlags::DontFollowXObjectForms) == PdfContentReaderFlags::None)
     {
-        m_inputs.push_back({
-            content.XObject,
-            std::make_shared<PdfCanvasInputDevice>(static_cast<const PdfXObjectForm&>(*content.XObject)),
-            dynamic_cast<const PdfCanvas*>(content.XObject.get()) });
+        auto canvas = dynamic_cast<const PdfCanvas*>(content.XObject.get());
+        auto contents = getFormContents(*xobjraw);
+        shared_ptr<InputStreamDevice> device;
+        if (contents == nullptr)
+        {
+            // The form is too big to be cached, read it incrementally
+            device = std::make_shared<PdfCanvasInputDevice>(*canvas);
+        }
+        else
+        {
+            device = std::make_shared<SpanStreamDevice>(*contents);
+        }
+
+        m_inputs.push_back({ content.XObject, device, canvas, contents });
     }
 }
 
+// Returns nullptr if the object is not a valid XObject
+const PdfContentsReader::CachedXObject* PdfContentsReader::getXObject(const PdfObject& obj)
+{
+    auto found = m_xobjects.find(&obj);
+    if (found != m_xobjects.end())
+        return found->second.XObject == nullptr ? nullptr : &found->second;
+
+    // NOTE: Invalid XObjects are cached as well
+    unique_ptr<PdfXObject> xobj;
+    (void)PdfXObject::TryCreateFromObject(const_cast<PdfObject&>(obj), xobj);
+    auto& cached = m_xobjects[&obj];
+    cached.XObject.reset(xobj.release());
+    return cached.XObject == nullptr ? nullptr : &cached;
+}
+
+// Returns nullptr if the form contents don't fit the cache
+shared_ptr<const charbuff> PdfContentsReader::getFormContents(const PdfObject& obj)
+{
+    auto& cached = m_xobjects[&obj];
+    if (cached.FormContents != nullptr || cached.FormContentsTooBig)
+        return cached.FormContents;
+
+    // Decode the contents only up to the space left in the cache
+    auto contents = std::make_shared<charbuff>();
+    auto stream = obj.GetStream();
+    if (stream != nullptr && !tryReadContents(*stream, MaxCachedContentsSize - m_cachedContentsSize, *contents))
+    {
+        cached.FormContentsTooBig = true;
+        return nullptr;
+    }
+
+    cached.FormContents = contents;
+    m_cachedContentsSize += contents->size();
+    return contents;
+}
+
 // Returns false in case of EOF
 bool PdfContentsReader::tryReadInlineImgData(charbuff& data)
 {
@@ -440,3 +493,25 @@ bool PdfContentsReader::isCalledRecursively(const PdfObject* xobj)
 
     return false;
 }
+
+// Returns false if the decoded stream is bigger than maxSize
+bool tryReadContents(const PdfObjectStream& stream, size_t maxSize, charbuff& buffer)
+{
+    constexpr size_t ChunkSize = 65536;
+    auto input = stream.GetInputStream();
+    if (input.GetMediaFilters().size() != 0)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFilter, "Unsupported expansion with media filters");
+
+    bool eof = false;
+    while (!eof)
+    {
+        size_t size = buffer.size();
+        if (size > maxSize)
+            return false;
+
+        buffer.resize(size + ChunkSize);
+        buffer.resize(size + input.Read(buffer.data() + size, ChunkSize, eof));
+    }
+
+    return buffer.size() <= maxSize;
+}
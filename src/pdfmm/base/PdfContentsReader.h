@@ -14,6 +14,8 @@
 #include "PdfVariantStack.h"
 #include "PdfPostScriptTokenizer.h"
 
+#include <unordered_map>
+
 namespace mm {
 
 /** Type of the content read from a content stream
@@ -75,6 +77,11 @@ struct PdfContentReaderArgs
 };
 
 /** Reader class to read content streams
+ *
+ * XObjects invoked more times are created only once, and the decoded
+ * contents of the forms are cached up to a size limit, so repeated
+ * invocations of the same form don't decode it again. Forms that
+ * don't fit the cache are decoded incrementally every time
  */
 class PdfContentsReader final
 {
@@ -109,6 +116,19 @@ private:
 
     bool isCalledRecursively(const PdfObject* xobj);
 
+private:
+    struct CachedXObject
+    {
+        std::shared_ptr<const PdfXObject> XObject;
+        std::shared_ptr<const charbuff> FormContents;
+        bool FormContentsTooBig = false;
+    };
+
+private:
+    const CachedXObject* getXObject(const PdfObject& obj);
+
+    std::shared_ptr<const charbuff> getFormContents(const PdfObject& obj);
+
 private:
     struct Storage
     {
@@ -123,6 +143,7 @@ private:
         std::shared_ptr<const PdfXObject> Form;
         std::shared_ptr<InputStreamDevice> Device;
         const PdfCanvas* Canvas;
+        std::shared_ptr<const charbuff> Contents;
     };
 
 private:
@@ -131,6 +152,8 @@ private:
     std::shared_ptr<charbuff> m_buffer;
     PdfPostScriptTokenizer m_tokenizer;
     bool m_readingInlineImgData;  // A state of reading inline image data
+    std::unordered_map<const PdfObject*, CachedXObject> m_xobjects;
+    size_t m_cachedContentsSize;
 
     // Temp storage
     Storage m_temp;
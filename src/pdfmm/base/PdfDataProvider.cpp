@@ -6,6 +6,8 @@
 
 #include <pdfmm/private/PdfDeclarationsPrivate.h>
 #include "PdfDataProvider.h"
+
+#include "PdfArena.h"
 #include "PdfStreamDevice.h"
 
 using namespace std;
@@ -15,6 +17,16 @@ PdfDataProvider::PdfDataProvider() { }
 
 PdfDataProvider::~PdfDataProvider() { }
 
+void* PdfDataProvider::operator new(size_t size)
+{
+    return PdfArena::AllocateObject(size);
+}
+
+void PdfDataProvider::operator delete(void* ptr) noexcept
+{
+    PdfArena::FreeObject(ptr);
+}
+
 string PdfDataProvider::ToString() const
 {
     string ret;
@@ -30,6 +30,12 @@ protected:
 public:
     virtual ~PdfDataProvider();
 
+    /** Variant data is allocated in the arena
+     * of the document when it's enabled
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr) noexcept;
+
     /** Converts the current object into a string representation
      *  which can be written directly to a PDF file on disc.
      *  \param str the object string is returned in this object.
@@ -194,6 +194,20 @@ enum class PdfFilterType : uint8_t
     Crypt
 };
 
+/**
+ * Compression level used when encoding streams with the Flate filter.
+ * Any value between PdfCompressionLevel::NoCompression and
+ * PdfCompressionLevel::BestCompression is accepted, higher levels
+ * trade speed for a smaller output
+ */
+enum class PdfCompressionLevel : int8_t
+{
+    Default = -1,              ///< Use the default level of the deflate backend, or inherit the level of the document
+    NoCompression = 0,
+    BestSpeed = 1,
+    BestCompression = 9,
+};
+
 enum class PdfExportFormat
 {
     Png = 1,        ///< NOTE: Not yet supported
@@ -426,6 +440,8 @@ enum class PdfSaveOptions
     NoCollectGarbage = 8,
     NoModifyDateUpdate = 16,
     Clean = 32,
+    ObjectStreams = 64,     ///< Compress objects in object streams, also enabling the XRef stream. Requires PDF 1.5. Ignored on incremental updates
+    ParallelCompress = 128, ///< Flate compress the streams on worker threads, ahead of writing them. The output is the same as the one of a sequential save
 };
 
 /**
@@ -15,9 +15,8 @@ using namespace mm;
 PdfDictionary::PdfDictionary() { }
 
 PdfDictionary::PdfDictionary(const PdfDictionary& rhs)
-    : m_Map(rhs.m_Map)
 {
-    setChildrenParent();
+    copyFrom(rhs);
 }
 
 PdfDictionary::PdfDictionary(PdfDictionary&& rhs) noexcept
@@ -28,8 +27,10 @@ PdfDictionary::PdfDictionary(PdfDictionary&& rhs) noexcept
 
 PdfDictionary& PdfDictionary::operator=(const PdfDictionary& rhs)
 {
-    m_Map = rhs.m_Map;
-    setChildrenParent();
+    if (this == &rhs)
+        return *this;
+
+    copyFrom(rhs);
     return *this;
 }
 
@@ -46,7 +47,10 @@ bool PdfDictionary::operator==(const PdfDictionary& rhs) const
         return true;
 
     // We don't check owner
-    return m_Map == rhs.m_Map;
+    return std::equal(m_Map.begin(), m_Map.end(), rhs.m_Map.begin(), rhs.m_Map.end(),
+        [](const PdfDictionaryMap::value_type& lhs, const PdfDictionaryMap::value_type& rhs) {
+            return *lhs == *rhs;
+        });
 }
 
 bool PdfDictionary::operator!=(const PdfDictionary& rhs) const
@@ -55,7 +59,7 @@ bool PdfDictionary::operator!=(const PdfDictionary& rhs) const
         return true;
 
     // We don't check owner
-    return m_Map != rhs.m_Map;
+    return !(*this == rhs);
 }
 
 void PdfDictionary::Clear()
@@ -102,33 +106,115 @@ PdfObject& PdfDictionary::addKey(const PdfName& key, PdfObject&& obj)
     return added.first->second;
 }
 
-pair<PdfDictionaryMap::iterator, bool> PdfDictionary::AddKey(const PdfName& key, PdfObject&& obj, bool noDirtySet)
+void PdfDictionary::copyFrom(const PdfDictionary& rhs)
+{
+    PdfDictionaryMap map;
+    map.reserve(rhs.m_Map.size());
+    for (auto& pair : rhs.m_Map)
+        map.push_back(std::make_unique<PdfDictionaryMap::value_type::element_type>(*pair));
+
+    m_Map = std::move(map);
+    setChildrenParent();
+}
+
+void PdfDictionary::appendKey(const PdfName& key, PdfObject&& obj)
+{
+    // NOTE: The order of the keys is restored by sortKeys()
+    m_Map.push_back(std::make_unique<PdfDictionaryMap::value_type::element_type>(key, std::move(obj)));
+    m_Map.back()->second.SetParent(*this);
+}
+
+void PdfDictionary::sortKeys()
+{
+    auto less = [](const PdfDictionaryMap::value_type& lhs, const PdfDictionaryMap::value_type& rhs) {
+        return lhs->first.GetRawData() < rhs->first.GetRawData();
+    };
+
+    // Keys are read from files usually in sorted order already
+    if (std::is_sorted(m_Map.begin(), m_Map.end(), less))
+    {
+        if (std::adjacent_find(m_Map.begin(), m_Map.end(),
+            [](const PdfDictionaryMap::value_type& lhs, const PdfDictionaryMap::value_type& rhs) {
+                return lhs->first == rhs->first;
+            }) == m_Map.end())
+        {
+            return;
+        }
+    }
+    else
+    {
+        std::stable_sort(m_Map.begin(), m_Map.end(), less);
+    }
+
+    // Keep only the last value of repeated keys, as AddKey() does
+    auto dst = m_Map.begin();
+    for (auto it = m_Map.begin(); it != m_Map.end(); it++)
+    {
+        auto next = it + 1;
+        if (next != m_Map.end() && (*next)->first == (*it)->first)
+            continue;
+
+        if (dst != it)
+            *dst = std::move(*it);
+
+        dst++;
+    }
+
+    m_Map.erase(dst, m_Map.end());
+}
+
+pair<PdfDictionary::iterator, bool> PdfDictionary::AddKey(const PdfName& key, PdfObject&& obj, bool noDirtySet)
 {
     // NOTE: Empty PdfNames are legal according to the PDF specification.
     // Don't check for it
 
-    pair<PdfDictionaryMap::iterator, bool> inserted = m_Map.try_emplace(key, std::move(obj));
-    if (!inserted.second)
+    auto it = lowerBound(key);
+    if (it != m_Map.end() && (*it)->first == key)
     {
+        auto& value = (*it)->second;
         if (noDirtySet)
-            inserted.first->second.Assign(obj);
+            value.Assign(obj);
         else
-            inserted.first->second = obj;
+            value = obj;
+
+        value.SetParent(*this);
+        return { iterator(it), false };
     }
 
-    inserted.first->second.SetParent(*this);
-    return inserted;
+    // Only the pointers to the entries are shifted, the
+    // values are not moved and keep the parent
+    it = m_Map.insert(it, std::make_unique<PdfDictionaryMap::value_type::element_type>(key, std::move(obj)));
+    (*it)->second.SetParent(*this);
+    return { iterator(it), true };
+}
+
+PdfDictionaryMap::iterator PdfDictionary::lowerBound(const string_view& key) const
+{
+    auto& map = const_cast<PdfDictionaryMap&>(m_Map);
+    return std::lower_bound(map.begin(), map.end(), key,
+        [](const PdfDictionaryMap::value_type& pair, const string_view& key) {
+            return pair->first.GetRawData() < key;
+        });
+}
+
+PdfDictionaryMap::iterator PdfDictionary::findEntry(const string_view& key) const
+{
+    auto it = lowerBound(key);
+    if (it == m_Map.end() || (*it)->first.GetRawData() != key)
+        return const_cast<PdfDictionaryMap&>(m_Map).end();
+
+    return it;
 }
 
 PdfObject* PdfDictionary::getKey(const string_view& key) const
 {
     // NOTE: Empty PdfNames are legal according to the PDF,
     // specification don't check for it
-    auto it = m_Map.find(key);
+    auto it = findEntry(key);
     if (it == m_Map.end())
         return nullptr;
 
-    return &const_cast<PdfObject&>(it->second);
+    return &(*it)->second;
 }
 
 PdfObject* PdfDictionary::findKey(const string_view& key) const
@@ -173,12 +259,12 @@ bool PdfDictionary::HasKey(const string_view& key) const
 {
     // NOTE: Empty PdfNames are legal according to the PDF,
     // specification don't check for it
-    return m_Map.find(key) != m_Map.end();
+    return findEntry(key) != m_Map.end();
 }
 
 bool PdfDictionary::RemoveKey(const string_view& key)
 {
-    PdfDictionaryMap::iterator found = m_Map.find(key);
+    auto found = findEntry(key);
     if (found == m_Map.end())
         return false;
 
@@ -209,7 +295,7 @@ void PdfDictionary::Write(OutputStreamDevice& device, PdfWriteFlags writeMode,
             device.Write('\n');
     }
 
-    for (auto& pair : m_Map)
+    for (auto& pair : *this)
     {
         if (pair.first != PdfName::KeyType)
         {
@@ -230,14 +316,14 @@ void PdfDictionary::ResetDirtyInternal()
 {
     // Propagate state to all sub objects
     for (auto& pair : m_Map)
-        pair.second.ResetDirty();
+        pair->second.ResetDirty();
 }
 
 void PdfDictionary::setChildrenParent()
 {
     // Set parent for all children
     for (auto& pair : m_Map)
-        pair.second.SetParent(*this);
+        pair->second.SetParent(*this);
 }
 
 const PdfObject* PdfDictionary::GetKey(const string_view& key) const
@@ -341,22 +427,22 @@ PdfObject& PdfDictionary::MustGetKey(const string_view& key)
 
 PdfDictionary::iterator PdfDictionary::begin()
 {
-    return m_Map.begin();
+    return iterator(m_Map.begin());
 }
 
 PdfDictionary::iterator PdfDictionary::end()
 {
-    return m_Map.end();
+    return iterator(m_Map.end());
 }
 
 PdfDictionary::const_iterator PdfDictionary::begin() const
 {
-    return m_Map.begin();
+    return const_iterator(m_Map.begin());
 }
 
 PdfDictionary::const_iterator PdfDictionary::end() const
 {
-    return m_Map.end();
+    return const_iterator(m_Map.end());
 }
 
 size_t PdfDictionary::size() const
@@ -14,27 +14,57 @@ namespace mm {
 
 class PdfDictionary;
 
-// Compartor to enable heterogeneous lookup in
-// PdfDictionary with both PdfName and string_view
-// See https://stackoverflow.com/a/31924435/213871
-struct PdfDictionaryComparator final
+// Flat map of the dictionary entries, sorted by the key raw data.
+// Dictionaries are usually small, so a vector has better locality
+// and a lower memory footprint than a node based map. The entries
+// are allocated separately, so the values never move and handles
+// to them stay valid when keys are added or removed
+using PdfDictionaryMap = std::vector<std::unique_ptr<std::pair<PdfName, PdfObject>>>;
+
+/**
+ * Iterator on the entries of a PdfDictionary, dereferencing
+ * the underlying map items
+ */
+template <typename TPair, typename TMapIterator>
+class PdfDictionaryIteratorBase final
 {
-    using is_transparent = std::true_type;
-    bool operator()(const PdfName& lhs, const PdfName& rhs) const
-    {
-        return lhs < rhs;
-    }
-    bool operator()(const PdfName& lhs, const std::string_view& rhs) const
+public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = TPair;
+    using pointer = TPair*;
+    using reference = TPair&;
+    using iterator_category = std::forward_iterator_tag;
+public:
+    PdfDictionaryIteratorBase() { }
+    explicit PdfDictionaryIteratorBase(const TMapIterator& iterator)
+        : m_iterator(iterator) { }
+    template <typename TOtherPair, typename TOtherMapIterator>
+    PdfDictionaryIteratorBase(const PdfDictionaryIteratorBase<TOtherPair, TOtherMapIterator>& iterator)
+        : m_iterator(iterator.m_iterator) { }
+public:
+    bool operator==(const PdfDictionaryIteratorBase& rhs) const { return m_iterator == rhs.m_iterator; }
+    bool operator!=(const PdfDictionaryIteratorBase& rhs) const { return m_iterator != rhs.m_iterator; }
+    PdfDictionaryIteratorBase& operator++()
     {
-        return lhs.GetRawData() < rhs;
+        m_iterator++;
+        return *this;
     }
-    bool operator()(const std::string_view& lhs, const PdfName& rhs) const
+    PdfDictionaryIteratorBase operator++(int)
     {
-        return lhs < rhs.GetRawData();
+        auto ret = *this;
+        m_iterator++;
+        return ret;
     }
+    reference operator*() const { return **m_iterator; }
+    pointer operator->() const { return &**m_iterator; }
+private:
+    template <typename, typename>
+    friend class PdfDictionaryIteratorBase;
+    TMapIterator m_iterator;
 };
 
-using PdfDictionaryMap = std::map<PdfName, PdfObject, PdfDictionaryComparator>;
+using PdfDictionaryIterator = PdfDictionaryIteratorBase<std::pair<PdfName, PdfObject>, PdfDictionaryMap::iterator>;
+using PdfDictionaryConstIterator = PdfDictionaryIteratorBase<const std::pair<PdfName, PdfObject>, PdfDictionaryMap::const_iterator>;
 
 /**
  * Helper class to iterate through indirect objects
@@ -88,8 +118,8 @@ private:
     PdfDictionary* m_dict;
 };
 
-using PdfDictionaryIndirectIterable = PdfDictionaryIndirectIterableBase<PdfObject, PdfDictionaryMap::iterator>;
-using PdfDictionaryConstIndirectIterable = PdfDictionaryIndirectIterableBase<const PdfObject, PdfDictionaryMap::const_iterator>;
+using PdfDictionaryIndirectIterable = PdfDictionaryIndirectIterableBase<PdfObject, PdfDictionaryIterator>;
+using PdfDictionaryConstIndirectIterable = PdfDictionaryIndirectIterableBase<const PdfObject, PdfDictionaryConstIterator>;
 
 /** The PDF dictionary data type of pdfmm (inherits from PdfDataContainer,
  * the base class for such representations)
@@ -98,6 +128,10 @@ using PdfDictionaryConstIndirectIterable = PdfDictionaryIndirectIterableBase<con
  * since we do lookup with both types. We also assume doing
  * lookups with strings will only use characters compatible
  * with PdfDocEncoding
+ *
+ * Entries are stored in a vector sorted by key: adding or removing
+ * keys invalidates iterators, but not pointers to the values of
+ * the other keys in the dictionary
  */
 class PDFMM_API PdfDictionary final : public PdfDataContainer
 {
@@ -302,7 +336,7 @@ public:
         const PdfStatefulEncrypt& encrypt, charbuff& buffer) const override;
 
     /**
-     * \returns the size of the internal map
+     * \returns the number of keys in the dictionary
      */
     unsigned GetSize() const;
 
@@ -311,8 +345,8 @@ public:
     PdfDictionaryConstIndirectIterable GetIndirectIterator() const;
 
 public:
-    using iterator = PdfDictionaryMap::iterator;
-    using const_iterator = PdfDictionaryMap::const_iterator;
+    using iterator = PdfDictionaryIterator;
+    using const_iterator = PdfDictionaryConstIterator;
 
 public:
     iterator begin();
@@ -330,6 +364,11 @@ private:
 
 private:
     PdfObject& addKey(const PdfName& key, PdfObject&& obj);
+    void appendKey(const PdfName& key, PdfObject&& obj);
+    void sortKeys();
+    void copyFrom(const PdfDictionary& rhs);
+    PdfDictionaryMap::iterator lowerBound(const std::string_view& key) const;
+    PdfDictionaryMap::iterator findEntry(const std::string_view& key) const;
     PdfObject* getKey(const std::string_view& key) const;
     PdfObject* findKey(const std::string_view& key) const;
     PdfObject* findKeyParent(const std::string_view& key) const;
@@ -2383,6 +2383,10 @@ static struct {
     {0xFFFF, nullptr}
 };
 
+static const vector<unsigned>& getNameToUnicodeIndex();
+static const vector<unsigned>& getUnicodeToNameIndex();
+static const vector<unsigned>& getNameToUnicodeCodePointIndex();
+
 PdfDifferenceList::PdfDifferenceList() { }
 
 void PdfDifferenceList::AddDifference(unsigned char code, char32_t codePoint)
@@ -2649,11 +2653,13 @@ char32_t PdfDifferenceEncoding::NameToCodePoint(const PdfName& name)
 
 char32_t PdfDifferenceEncoding::NameToCodePoint(const string_view& name)
 {
-    for (unsigned i = 0; nameToUnicodeTab[i].name != nullptr; i++)
-    {
-        if (nameToUnicodeTab[i].name == name)
-            return nameToUnicodeTab[i].u;
-    }
+    auto& nameIndex = getNameToUnicodeIndex();
+    auto found = std::lower_bound(nameIndex.begin(), nameIndex.end(), name,
+        [](unsigned index, const string_view& name) {
+            return nameToUnicodeTab[index].name < name;
+        });
+    if (found != nameIndex.end() && nameToUnicodeTab[*found].name == name)
+        return nameToUnicodeTab[*found].u;
 
     // if we get here, then we might be looking up an undefined codepoint
     // so try looking for our special format..
@@ -2673,18 +2679,22 @@ char32_t PdfDifferenceEncoding::NameToCodePoint(const string_view& name)
 
 PdfName PdfDifferenceEncoding::CodePointToName(char32_t inCodePoint)
 {
-    for (unsigned i = 0; UnicodeToNameTab[i].name; i++)
-    {
-        if (UnicodeToNameTab[i].u == inCodePoint)
-            return PdfName(UnicodeToNameTab[i].name);
-    }
+    auto& unicodeIndex = getUnicodeToNameIndex();
+    auto found = std::lower_bound(unicodeIndex.begin(), unicodeIndex.end(), inCodePoint,
+        [](unsigned index, char32_t codePoint) {
+            return UnicodeToNameTab[index].u < codePoint;
+        });
+    if (found != unicodeIndex.end() && UnicodeToNameTab[*found].u == inCodePoint)
+        return PdfName(UnicodeToNameTab[*found].name);
 
     // if we can't find in the canonical list, look in the complete list
-    for (unsigned i = 0; nameToUnicodeTab[i].name; i++)
-    {
-        if (nameToUnicodeTab[i].u == inCodePoint)
-            return PdfName(nameToUnicodeTab[i].name);
-    }
+    auto& codePointIndex = getNameToUnicodeCodePointIndex();
+    found = std::lower_bound(codePointIndex.begin(), codePointIndex.end(), inCodePoint,
+        [](unsigned index, char32_t codePoint) {
+            return nameToUnicodeTab[index].u < codePoint;
+        });
+    if (found != codePointIndex.end() && nameToUnicodeTab[*found].u == inCodePoint)
+        return PdfName(nameToUnicodeTab[*found].name);
 
     // if we get here, then we are looking up an undefined codepoint
     // so we'll just give it an arbitrary name..
@@ -2692,3 +2702,43 @@ PdfName PdfDifferenceEncoding::CodePointToName(char32_t inCodePoint)
     utls::FormatTo(buffer, "uni{:04x}", (unsigned)inCodePoint);
     return PdfName(buffer);
 }
+
+// The glyph list tables are indexed once, sorting the entries by
+// name or by code point. Sorting is stable, so lookups still find
+// the first entry of the table, in case of duplicates
+template <typename TTable, typename TLess>
+static vector<unsigned> createIndex(const TTable& table, const TLess& less)
+{
+    vector<unsigned> ret;
+    for (unsigned i = 0; table[i].name != nullptr; i++)
+        ret.push_back(i);
+
+    std::stable_sort(ret.begin(), ret.end(), [&table, &less](unsigned lhs, unsigned rhs) {
+        return less(table[lhs], table[rhs]);
+    });
+    return ret;
+}
+
+const vector<unsigned>& getNameToUnicodeIndex()
+{
+    static vector<unsigned> s_index = createIndex(nameToUnicodeTab, [](auto& lhs, auto& rhs) {
+        return string_view(lhs.name) < string_view(rhs.name);
+    });
+    return s_index;
+}
+
+const vector<unsigned>& getUnicodeToNameIndex()
+{
+    static vector<unsigned> s_index = createIndex(UnicodeToNameTab, [](auto& lhs, auto& rhs) {
+        return lhs.u < rhs.u;
+    });
+    return s_index;
+}
+
+const vector<unsigned>& getNameToUnicodeCodePointIndex()
+{
+    static vector<unsigned> s_index = createIndex(nameToUnicodeTab, [](auto& lhs, auto& rhs) {
+        return lhs.u < rhs.u;
+    });
+    return s_index;
+}
@@ -9,7 +9,9 @@
 #include "PdfDocument.h"
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <thread>
 
 #include "PdfArray.h"
 #include "PdfDictionary.h"
@@ -34,7 +36,9 @@ using namespace mm;
 PdfDocument::PdfDocument(bool empty) :
     m_Objects(*this),
     m_Metadata(*this),
-    m_FontManager(*this)
+    m_FontManager(*this),
+    m_CompressionLevel(PdfCompressionLevel::Default),
+    m_frozen(false)
 {
     if (!empty)
     {
@@ -58,7 +62,9 @@ PdfDocument::PdfDocument(bool empty) :
 PdfDocument::PdfDocument(const PdfDocument& doc) :
     m_Objects(*this, doc.m_Objects),
     m_Metadata(*this),
-    m_FontManager(*this)
+    m_FontManager(*this),
+    m_CompressionLevel(doc.m_CompressionLevel),
+    m_frozen(false)
 {
     SetTrailer(std::make_unique<PdfObject>(doc.GetTrailer().GetObject()));
     Init();
@@ -71,6 +77,7 @@ PdfDocument::~PdfDocument()
 
 void PdfDocument::Clear() 
 {
+    m_frozen = false;
     m_FontManager.Clear();
     m_Catalog = nullptr;
     m_Info = nullptr;
@@ -82,6 +89,132 @@ void PdfDocument::Clear()
     m_Objects.SetCanReuseObjectNumbers(true);
 }
 
+void PdfDocument::SetCompressionLevel(PdfCompressionLevel level)
+{
+    if (level < PdfCompressionLevel::Default || level > PdfCompressionLevel::BestCompression)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Invalid flate compression level");
+
+    m_CompressionLevel = level;
+}
+
+void PdfDocument::Freeze()
+{
+    if (m_frozen)
+        return;
+
+    // Fill the page cache, so pages can be
+    // retrieved by index without modifications
+    auto& pages = GetPages();
+    for (unsigned i = 0, count = pages.GetCount(); i < count; i++)
+        (void)pages.GetPageAt(i);
+
+    m_frozen = true;
+}
+
+void PdfDocument::ExtractTextTo(vector<PdfTextEntry>& entries, const string_view& pattern,
+    const PdfTextExtractParams& params, unsigned threadCount)
+{
+    ExtractTextTo(entries, 0, GetPages().GetCount(), pattern, params, threadCount);
+}
+
+void PdfDocument::ExtractTextTo(vector<PdfTextEntry>& entries, unsigned pageIndex, unsigned pageCount,
+    const string_view& pattern, const PdfTextExtractParams& params, unsigned threadCount)
+{
+    auto& pages = GetPages();
+    if (pageIndex > pages.GetCount() || pageCount > pages.GetCount() - pageIndex)
+        PDFMM_RAISE_ERROR(PdfErrorCode::PageNotFound);
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, thread::hardware_concurrency());
+
+    threadCount = std::min(threadCount, pageCount);
+
+    // Fonts and objects loaded by the threads are shared, the
+    // document must be frozen for the duration of the extraction.
+    // The previous state is restored also when an error is raised
+    struct FreezeScope
+    {
+        FreezeScope(PdfDocument& doc)
+            : Document(doc), WasFrozen(doc.m_frozen)
+        {
+            doc.Freeze();
+        }
+
+        ~FreezeScope()
+        {
+            Document.m_frozen = WasFrozen;
+        }
+
+        PdfDocument& Document;
+        bool WasFrozen;
+    };
+    FreezeScope freezeScope(*this);
+
+    // Pages are fetched one at a time, since their
+    // complexity may vary a lot in the same document
+    // The pattern is compiled once for all the pages
+    PdfTextSearchPattern searchPattern(pattern, params.Flags);
+    vector<vector<PdfTextEntry>> pageEntries(pageCount);
+    atomic<unsigned> nextIndex(0);
+    exception_ptr exception;
+    mutex exceptionMutex;
+    auto extractPages = [&]()
+    {
+        while (true)
+        {
+            unsigned index = nextIndex.fetch_add(1);
+            if (index >= pageCount)
+                break;
+
+            try
+            {
+                pages.GetPageAt(pageIndex + index).ExtractTextTo(pageEntries[index], searchPattern, params);
+            }
+            catch (...)
+            {
+                // Stop the other threads and report the first error
+                nextIndex = pageCount;
+                unique_lock<mutex> lock(exceptionMutex);
+                if (exception == nullptr)
+                    exception = std::current_exception();
+                break;
+            }
+        }
+    };
+
+    // The calling thread performs extraction as well
+    vector<thread> threads;
+    if (threadCount > 1)
+        threads.reserve(threadCount - 1);
+    try
+    {
+        for (unsigned i = 1; i < threadCount; i++)
+            threads.emplace_back(extractPages);
+    }
+    catch (...)
+    {
+        // Stop and join the threads already started
+        nextIndex = pageCount;
+        for (auto& thread : threads)
+            thread.join();
+
+        throw;
+    }
+
+    extractPages();
+    for (auto& thread : threads)
+        thread.join();
+
+    if (exception != nullptr)
+        std::rethrow_exception(exception);
+
+    for (auto& extracted : pageEntries)
+    {
+        entries.insert(entries.end(), std::make_move_iterator(extracted.begin()),
+            std::make_move_iterator(extracted.end()));
+    }
+}
+
 void PdfDocument::Init()
 {
     auto pagesRootObj = m_Catalog->GetDictionary().FindKey("Pages");
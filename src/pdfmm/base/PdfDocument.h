@@ -7,6 +7,8 @@
 #ifndef PDF_DOCUMENT_H
 #define PDF_DOCUMENT_H
 
+#include <mutex>
+
 #include "PdfTrailer.h"
 #include "PdfCatalog.h"
 #include "PdfIndirectObjectList.h"
@@ -46,6 +48,9 @@ class PDFMM_API PdfDocument
     friend class PdfMetadata;
     friend class PdfXObjectForm;
     friend class PdfPageCollection;
+    friend class PdfObject;
+    friend class PdfParserObject;
+    friend class PdfFontManager;
 
 public:
     /** Close down/destruct the PdfDocument
@@ -180,6 +185,72 @@ public:
      */
     bool IsHighPrintAllowed() const;
 
+    /** Set the level used when Flate-encoding the streams of the document,
+     * both when writing data to them and when compressing them on save.
+     * Streams with a level different than PdfCompressionLevel::Default
+     * keep their own level
+     * \see PdfObjectStream::SetCompressionLevel
+     */
+    void SetCompressionLevel(PdfCompressionLevel level);
+
+    PdfCompressionLevel GetCompressionLevel() const { return m_CompressionLevel; }
+
+    /** Freeze the document for concurrent read access
+     *
+     * After this call multiple threads can read the document at
+     * the same time. All the pages are cached, every object is
+     * lazily loaded only once, without blocking the loads of other
+     * objects, and object streams can be read by multiple threads.
+     * Loads read the input device at independent positions when it
+     * exposes its buffer, such as with memory mapped files, otherwise
+     * the device reads are serialized. Font loading is serialized. The document shall not be modified anymore,
+     * until it's loaded again. The reads that are safe are:
+     * - retrieving pages with GetPageAt() and reading their objects,
+     *   including names, which are immutable once constructed;
+     * - reading and decoding streams with PdfObjectStream;
+     * - retrieving fonts with PdfFontManager::GetLoadedFont() and
+     *   converting text with their encodings, including the lazily
+     *   built lookup tables of PdfCharCodeMap and PdfBuiltInEncoding;
+     * - extracting text with PdfPage::ExtractTextTo() or ExtractTextTo().
+     *
+     * Other operations, such as drawing on pages, creating fonts or
+     * saving, are not safe. Direct access to FreeType faces returned
+     * by PdfFontMetrics::GetOrLoadFace() is not synchronized
+     */
+    void Freeze();
+
+    /** \returns true if the document was frozen for concurrent read access
+     * \see Freeze
+     */
+    bool IsFrozen() const { return m_frozen; }
+
+    /** Extract the text of all the pages, processing them concurrently
+     * \param entries the extracted text entries, ordered by page
+     * \param pattern extract only the text matching this pattern
+     * \param params the extraction parameters, used for all the pages
+     * \param threadCount number of threads to use, 0 to use all the
+     *      available hardware threads
+     * \remarks The document is frozen while extracting and shall
+     *      not be modified by other threads in the meantime. Fonts
+     *      and their encodings are loaded once and shared by the threads
+     * \see PdfPage::ExtractTextTo, Freeze
+     */
+    void ExtractTextTo(std::vector<PdfTextEntry>& entries,
+        const std::string_view& pattern = { },
+        const PdfTextExtractParams& params = { },
+        unsigned threadCount = 0);
+
+    /** Extract the text of a range of pages, processing them concurrently
+     * \param pageIndex index of the first page
+     * \param pageCount number of pages to extract
+     * \see ExtractTextTo
+     */
+    void ExtractTextTo(std::vector<PdfTextEntry>& entries,
+        unsigned pageIndex, unsigned pageCount,
+        const std::string_view& pattern = { },
+        const PdfTextExtractParams& params = { },
+        unsigned threadCount = 0);
+
 public:
     virtual const PdfEncrypt* GetEncrypt() const = 0;
 
@@ -335,6 +406,11 @@ private:
     std::unique_ptr<PdfAcroForm> m_AcroForm;
     std::unique_ptr<PdfOutlines> m_Outlines;
     std::unique_ptr<PdfNameTree> m_NameTree;
+    PdfCompressionLevel m_CompressionLevel;
+    bool m_frozen;
+    // Serializes the reads from the input device of frozen documents,
+    // when it doesn't allow reading at independent positions
+    std::mutex m_deviceMutex;
 };
 
 };
@@ -530,9 +530,6 @@ PdfBuiltInEncoding::PdfBuiltInEncoding(const PdfName& name)
 
 void PdfBuiltInEncoding::InitEncodingTable()
 {
-    if (!m_EncodingTable.empty())
-        return;
-
     const char32_t* cpUnicodeTable = this->GetToUnicodeTable();
     for (size_t i = 0; i < 256; i++)
     {
@@ -544,7 +541,8 @@ void PdfBuiltInEncoding::InitEncodingTable()
 
 bool PdfBuiltInEncoding::tryGetCharCode(char32_t codePoint, PdfCharCode& codeUnit) const
 {
-    const_cast<PdfBuiltInEncoding*>(this)->InitEncodingTable();
+    auto& rthis = const_cast<PdfBuiltInEncoding&>(*this);
+    std::call_once(rthis.m_EncodingTableInit, &PdfBuiltInEncoding::InitEncodingTable, &rthis);
     auto found = m_EncodingTable.find(codePoint);
     if (found == m_EncodingTable.end())
     {
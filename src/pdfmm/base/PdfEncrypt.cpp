@@ -216,7 +216,7 @@ private:
 /** An OutputStream that encrypt all data written
  *  using the RC4 encryption algorithm
  */
-class PdfRC4OutputStream : public OutputStream
+class PdfRC4OutputStream : public PdfEncryptOutputStream
 {
 public:
     PdfRC4OutputStream(OutputStream& outputStream, unsigned char rc4key[256],
@@ -394,6 +394,113 @@ private:
     size_t m_drainLeft;
 };
 
+/** An OutputStream that encrypts all data written using
+ *  the AES encryption algorithm. The initialization vector
+ *  is written first, the padding when the stream is finished
+ */
+class PdfAESOutputStream : public PdfEncryptOutputStream
+{
+public:
+    PdfAESOutputStream(OutputStream& outputStream, const unsigned char* key, unsigned keylen,
+            const unsigned char* iv) :
+        m_OutputStream(&outputStream)
+    {
+        m_ctx = EVP_CIPHER_CTX_new();
+        if (m_ctx == nullptr)
+            PDFMM_RAISE_ERROR(PdfErrorCode::OutOfMemory);
+
+        const EVP_CIPHER* cipher;
+        switch (keylen)
+        {
+            case (size_t)PdfKeyLength::L128 / 8:
+            {
+                cipher = EVP_aes_128_cbc();
+                break;
+            }
+#ifdef PDFMM_HAVE_LIBIDN
+            case (size_t)PdfKeyLength::L256 / 8:
+            {
+                cipher = EVP_aes_256_cbc();
+                break;
+            }
+#endif
+            default:
+            {
+                EVP_CIPHER_CTX_free(m_ctx);
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Invalid AES key length");
+            }
+        }
+
+        if (EVP_EncryptInit_ex(m_ctx, cipher, nullptr, key, iv) != 1)
+        {
+            EVP_CIPHER_CTX_free(m_ctx);
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error initializing AES encryption engine");
+        }
+
+        m_OutputStream->Write((const char*)iv, AES_IV_LENGTH);
+    }
+
+    ~PdfAESOutputStream()
+    {
+        // NOTE: The last block is written only by Finish(), since
+        // writing may throw. An unfinished stream is just dropped
+        if (m_ctx != nullptr)
+            EVP_CIPHER_CTX_free(m_ctx);
+    }
+
+public:
+    void Finish() override
+    {
+        if (m_ctx == nullptr)
+            return;
+
+        // Write the last block, including the padding
+        unsigned char lastBlock[AES_BLOCK_SIZE];
+        int outlen;
+        int rc = EVP_EncryptFinal_ex(m_ctx, lastBlock, &outlen);
+        EVP_CIPHER_CTX_free(m_ctx);
+        m_ctx = nullptr;
+        if (rc != 1)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error AES-encrypting data");
+
+        m_OutputStream->Write((const char*)lastBlock, (size_t)outlen);
+    }
+
+protected:
+    void writeBuffer(const char* buffer, size_t size) override;
+
+private:
+    EVP_CIPHER_CTX* m_ctx;
+    OutputStream* m_OutputStream;
+    vector<unsigned char> m_tempBuffer;
+};
+
+void PdfAESOutputStream::writeBuffer(const char* buffer, size_t size)
+{
+    if (m_ctx == nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Writing a finished AES stream");
+
+    // Encrypt in chunks, as OpenSSL counts the input with an int
+    constexpr size_t ChunkSize = 65536;
+    while (size != 0)
+    {
+        size_t chunkSize = std::min(size, ChunkSize);
+        m_tempBuffer.resize(chunkSize + AES_BLOCK_SIZE);
+        int outlen;
+        if (EVP_EncryptUpdate(m_ctx, m_tempBuffer.data(), &outlen, (const unsigned char*)buffer, (int)chunkSize) != 1)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error AES-encrypting data");
+
+        m_OutputStream->Write((const char*)m_tempBuffer.data(), (size_t)outlen);
+        buffer += chunkSize;
+        size -= chunkSize;
+    }
+}
+
+}
+
+void PdfEncryptOutputStream::Finish()
+{
+    // Do nothing
 }
 
 PdfEncrypt::~PdfEncrypt() { }
@@ -1150,12 +1257,12 @@ PdfEncryptRC4::PdfEncryptRC4(const string_view& userPassword, const string_view&
 PdfEncryptRC4::PdfEncryptRC4(const PdfEncrypt& rhs)
     : PdfEncryptMD5Base(rhs) {}
 
-unique_ptr<OutputStream> PdfEncryptRC4::CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref)
+unique_ptr<PdfEncryptOutputStream> PdfEncryptRC4::CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref)
 {
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
     this->CreateObjKey(objkey, keylen, objref);
-    return unique_ptr<OutputStream>(new PdfRC4OutputStream(outputStream, m_rc4key, m_rc4last, objkey, keylen));
+    return unique_ptr<PdfEncryptOutputStream>(new PdfRC4OutputStream(outputStream, m_rc4key, m_rc4last, objkey, keylen));
 }
     
 PdfEncryptAESBase::PdfEncryptAESBase()
@@ -1378,16 +1485,14 @@ unique_ptr<InputStream> PdfEncryptAESV2::CreateEncryptionInputStream(InputStream
     return unique_ptr<InputStream>(new PdfAESInputStream(inputStream, inputLen, objkey, keylen));
 }
     
-unique_ptr<OutputStream> PdfEncryptAESV2::CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref)
+unique_ptr<PdfEncryptOutputStream> PdfEncryptAESV2::CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref)
 {
-    (void)outputStream;
-    (void)objref;
-    /*unsigned char objkey[MD5_DIGEST_LENGTH];
-     int keylen;
-
-     this->CreateObjKey( objkey, &keylen );*/
-
-    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "CreateEncryptionOutputStream does not yet support AESV2");
+    unsigned char objkey[MD5_DIGEST_LENGTH];
+    unsigned keylen;
+    this->CreateObjKey(objkey, keylen, objref);
+    unsigned char iv[AES_IV_LENGTH];
+    this->GenerateInitialVector(iv);
+    return unique_ptr<PdfEncryptOutputStream>(new PdfAESOutputStream(outputStream, objkey, keylen, iv));
 }
     
 #ifdef PDFMM_HAVE_LIBIDN
@@ -1868,11 +1973,12 @@ unique_ptr<InputStream> PdfEncryptAESV3::CreateEncryptionInputStream(InputStream
     return unique_ptr<InputStream>(new PdfAESInputStream(inputStream, inputLen, m_encryptionKey, 32));
 }
 
-unique_ptr<OutputStream> PdfEncryptAESV3::CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref)
+unique_ptr<PdfEncryptOutputStream> PdfEncryptAESV3::CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref)
 {
-    (void)outputStream;
     (void)objref;
-    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "CreateEncryptionOutputStream does not yet support AESV3");
+    unsigned char iv[AES_IV_LENGTH];
+    this->GenerateInitialVector(iv);
+    return unique_ptr<PdfEncryptOutputStream>(new PdfAESOutputStream(outputStream, m_encryptionKey, 32, iv));
 }
     
 #endif // PDFMM_HAVE_LIBIDN
@@ -10,6 +10,7 @@
 #include "PdfDeclarations.h"
 #include "PdfString.h"
 #include "PdfReference.h"
+#include "PdfOutputStream.h"
 
 namespace mm
 {
@@ -17,7 +18,6 @@ namespace mm
 class PdfDictionary;
 class InputStream;
 class PdfObject;
-class OutputStream;
 class AESCryptoEngine;
 class RC4CryptoEngine;
 
@@ -59,6 +59,18 @@ enum class PdfAESV3Revision
 };
 #endif //PDFMM_HAVE_LIBIDN
 
+/** An OutputStream that encrypts all data written to it
+ */
+class PDFMM_API PdfEncryptOutputStream : public OutputStream
+{
+public:
+    /** Write the encrypted data still held, such as the last
+     *  padded block. It must be called after all data has been
+     *  written: it's not done on destruction, since it may throw
+     */
+    virtual void Finish();
+};
+
 /** Set user permissions/restrictions on a document
  */
 enum class PdfPermissions
@@ -215,14 +227,13 @@ public:
     /** Create an OutputStream that encrypts all data written to
      *  it using the current settings of the PdfEncrypt object.
      *
-     *  Warning: Currently only RC4 based encryption is supported using output streams!
-     *
      *  \param outputStream the created OutputStream writes all encrypted
      *         data to this output stream.
      *
-     *  \returns a OutputStream that encrypts all data.
+     *  \returns a OutputStream that encrypts all data. PdfEncryptOutputStream::Finish()
+     *         must be called after all data has been written
      */
-    virtual std::unique_ptr<OutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) = 0;
+    virtual std::unique_ptr<PdfEncryptOutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) = 0;
 
     /**
      * Tries to authenticate a user using either the user or owner password
@@ -595,7 +606,7 @@ public:
     PdfEncryptAESV2(const PdfEncrypt& rhs);
 
     std::unique_ptr<InputStream> CreateEncryptionInputStream(InputStream& inputStream, size_t inputLen, const PdfReference& objref) override;
-    std::unique_ptr<OutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) override;
+    std::unique_ptr<PdfEncryptOutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) override;
 
     void Encrypt(const char* inStr, size_t inLen, const PdfReference& objref,
         char* outStr, size_t outLen) const override;
@@ -630,7 +641,7 @@ public:
     PdfEncryptAESV3(const PdfEncrypt& rhs);
 
     std::unique_ptr<InputStream> CreateEncryptionInputStream(InputStream& inputStream, size_t inputLen, const PdfReference& objref) override;
-    std::unique_ptr<OutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) override;
+    std::unique_ptr<PdfEncryptOutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) override;
 
     // Encrypt a character string
     void Encrypt(const char* inStr, size_t inLen, const PdfReference& objref,
@@ -675,7 +686,7 @@ public:
 
     std::unique_ptr<InputStream> CreateEncryptionInputStream(InputStream& inputStream, size_t inputLen, const PdfReference& objref) override;
 
-    std::unique_ptr<OutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) override;
+    std::unique_ptr<PdfEncryptOutputStream> CreateEncryptionOutputStream(OutputStream& outputStream, const PdfReference& objref) override;
 
     size_t CalculateStreamOffset() const override;
 
@@ -294,11 +294,14 @@ public:
      *  with it.
      *
      *  \param filterType return value of GetType() for filter to be created
+     *  \param level the compression level used when encoding, only
+     *         considered by PdfFilterType::FlateDecode
      *
      *  \returns a new PdfFilter allocated using new, or nullptr if no
      *           filter is available for this type.
      */
-    static std::unique_ptr<PdfFilter> Create(PdfFilterType filterType);
+    static std::unique_ptr<PdfFilter> Create(PdfFilterType filterType,
+        PdfCompressionLevel level = PdfCompressionLevel::Default);
 
     /** Create an OutputStream that applies a list of filters
      *  on all data written to it.
@@ -306,12 +309,13 @@ public:
      *  \param filters a list of filters
      *  \param stream write all data to this OutputStream after it has been
      *         encoded
+     *  \param level the compression level used by Flate filters
      *  \returns a new OutputStream that has to be deleted by the caller.
      *
      *  \see PdfFilterFactory::CreateFilterList
      */
     static std::unique_ptr<OutputStream> CreateEncodeStream(const std::shared_ptr<OutputStream>& stream,
-        const PdfFilterList& filters);
+        const PdfFilterList& filters, PdfCompressionLevel level = PdfCompressionLevel::Default);
 
     /** Create an InputStream that applies a list of filters
      *  on all data written to it.
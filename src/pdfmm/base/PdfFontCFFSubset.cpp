@@ -0,0 +1,1102 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+// See "The Compact Font Format Specification", Adobe Technical Note #5176
+// and "The Type 2 Charstring Format", Adobe Technical Note #5177
+
+#include <pdfmm/private/PdfDeclarationsPrivate.h>
+#include "PdfFontCFFSubset.h"
+
+#include <cstdlib>
+
+using namespace std;
+using namespace mm;
+
+// Top DICT and Private DICT operators. Two byte
+// operators are escaped with 12 in the high byte
+enum class CFFOperator : unsigned
+{
+    UniqueID = 13,
+    XUID = 14,
+    Charset = 15,
+    Encoding = 16,
+    CharStrings = 17,
+    Private = 18,
+    Subrs = 19,
+    CharstringType = (12 << 8) | 6,
+    ROS = (12 << 8) | 30,
+    CIDCount = (12 << 8) | 34,
+    UIDBase = (12 << 8) | 35,
+    FDArray = (12 << 8) | 36,
+    FDSelect = (12 << 8) | 37,
+};
+
+// Type 2 charstring operators
+enum class CharStringOperator : unsigned char
+{
+    HStem = 1,
+    VStem = 3,
+    CallSubr = 10,
+    Return = 11,
+    Escape = 12,
+    EndChar = 14,
+    HStemHM = 18,
+    HintMask = 19,
+    CntrMask = 20,
+    VStemHM = 23,
+    ShortInt = 28,
+    CallGSubr = 29,
+};
+
+static constexpr unsigned STANDARD_STRING_COUNT = 391;
+static constexpr unsigned MAX_SUBR_NESTING = 10;
+static constexpr uint32_t CFF_TABLE_TAG = 0x43464620;   // "CFF "
+static constexpr uint32_t OPENTYPE_CFF_TAG = 0x4F54544F; // "OTTO"
+
+// Unused subroutines are replaced by a single "return"
+static const char s_stubSubr[] = { (char)CharStringOperator::Return };
+
+// SIDs of the glyph names in the StandardEncoding, used to
+// resolve the accent components of the "seac" endchar
+static const unsigned char s_standardEncodingSIDs[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,  16,
+     17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,  32,
+     33,  34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,  48,
+     49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,  64,
+     65,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,  77,  78,  79,  80,
+     81,  82,  83,  84,  85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,  96,  97,  98,  99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110,
+      0, 111, 112, 113, 114,   0, 115, 116, 117, 118, 119, 120, 121, 122,   0, 123,
+      0, 124, 125, 126, 127, 128, 129, 130, 131,   0, 132, 133,   0, 134, 135, 136,
+    137,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0, 138,   0, 139,   0,   0,   0,   0, 140, 141, 142, 143,   0,   0,   0,   0,
+      0, 144,   0,   0,   0, 145,   0,   0, 146, 147, 148, 149,   0,   0,   0,   0,
+};
+
+static bufferview getCFFTable(const bufferview& data);
+static unsigned getSubrBias(size_t subrCount);
+static void writeIndex(string& output, const vector<bufferview>& index);
+static void writeOperator(string& output, unsigned op);
+static void writeInt(string& output, int value);
+static void writeFixedInt(string& output, unsigned value);
+static void writeCard16(string& output, unsigned value);
+static double readReal(const unsigned char* data, size_t size, size_t& offset);
+
+PdfFontCFFSubset::PdfFontCFFSubset(const bufferview& data) :
+    m_data(data),
+    m_isCIDKeyed(false),
+    m_charStringType(2)
+{
+}
+
+void PdfFontCFFSubset::BuildFont(string& output, const PdfFontMetrics& metrics,
+    const CIDToGIDMap& cidToGidMap)
+{
+    if (metrics.GetFontFileType() != PdfFontFileType::Type1CCF)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "The font to be subsetted is not a CFF font");
+
+    PdfFontCFFSubset subset(getCFFTable(metrics.GetOrLoadFontFileData()));
+    subset.BuildFont(output, cidToGidMap);
+}
+
+void PdfFontCFFSubset::BuildFont(string& output, const CIDToGIDMap& cidToGidMap)
+{
+    Init();
+    LoadGlyphs(cidToGidMap);
+    WriteFont(output);
+}
+
+void PdfFontCFFSubset::Init()
+{
+    // Header: major, minor, hdrSize, offSize
+    auto header = GetData(0, 4);
+    if (header[0] != 1)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFontFormat, "Unsupported CFF major version {}", (unsigned)header[0]);
+
+    size_t offset = (unsigned char)header[2];
+    ReadIndex(offset, m_nameIndex);
+    vector<bufferview> topDicts;
+    ReadIndex(offset, topDicts);
+    ReadIndex(offset, m_stringIndex);
+    ReadIndex(offset, m_globalSubrs);
+    if (m_nameIndex.size() != 1 || topDicts.size() != 1)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFontFormat, "CFF font sets are not supported");
+
+    ReadDict(topDicts[0], m_topDict);
+    m_isCIDKeyed = findDictEntry(m_topDict, (unsigned)CFFOperator::ROS) != nullptr;
+
+    auto entry = findDictEntry(m_topDict, (unsigned)CFFOperator::CharstringType);
+    if (entry != nullptr && entry->Values.size() == 1)
+        m_charStringType = (unsigned)entry->Values[0];
+
+    entry = findDictEntry(m_topDict, (unsigned)CFFOperator::CharStrings);
+    if (entry == nullptr || entry->Values.size() != 1)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Missing CFF CharStrings");
+
+    offset = (size_t)entry->Values[0];
+    ReadIndex(offset, m_charStrings);
+    if (m_charStrings.size() == 0)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "CFF font with no glyphs");
+
+    if (m_isCIDKeyed)
+    {
+        entry = findDictEntry(m_topDict, (unsigned)CFFOperator::FDArray);
+        if (entry == nullptr || entry->Values.size() != 1)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Missing CFF FDArray");
+
+        offset = (size_t)entry->Values[0];
+        vector<bufferview> fontDicts;
+        ReadIndex(offset, fontDicts);
+        m_fontDatas.resize(fontDicts.size());
+        for (unsigned i = 0; i < fontDicts.size(); i++)
+        {
+            auto& fontData = m_fontDatas[i];
+            ReadDict(fontDicts[i], fontData.FontDict);
+            ReadPrivateDict(fontData, fontData.FontDict);
+        }
+
+        entry = findDictEntry(m_topDict, (unsigned)CFFOperator::FDSelect);
+        if (entry == nullptr || entry->Values.size() != 1)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Missing CFF FDSelect");
+
+        ReadFDSelect((size_t)entry->Values[0]);
+    }
+    else
+    {
+        m_fontDatas.resize(1);
+        ReadPrivateDict(m_fontDatas[0], m_topDict);
+
+        // The default charset is ISOAdobe
+        entry = findDictEntry(m_topDict, (unsigned)CFFOperator::Charset);
+        ReadCharset(entry == nullptr || entry->Values.size() != 1 ? 0 : (size_t)entry->Values[0]);
+    }
+
+    m_usedGlobalSubrs.resize(m_globalSubrs.size());
+    m_loadedGIDs.resize(m_charStrings.size());
+}
+
+void PdfFontCFFSubset::ReadIndex(size_t& offset, vector<bufferview>& index) const
+{
+    index.clear();
+    uint16_t count;
+    utls::ReadUInt16BE(GetData(offset, 2).data(), count);
+    offset += 2;
+    if (count == 0)
+        return;
+
+    unsigned offSize = (unsigned char)GetData(offset, 1)[0];
+    if (offSize == 0 || offSize > 4)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Invalid CFF INDEX offset size");
+
+    offset += 1;
+    auto offsets = GetData(offset, ((size_t)count + 1) * offSize);
+    auto readOffset = [&](unsigned i) {
+        size_t ret = 0;
+        for (unsigned j = 0; j < offSize; j++)
+            ret = (ret << 8) | (unsigned char)offsets[i * offSize + j];
+        return ret;
+    };
+
+    // Offsets are relative to the byte preceding the object data
+    size_t dataOffset = offset + offsets.size() - 1;
+    index.reserve(count);
+    for (unsigned i = 0; i < count; i++)
+    {
+        size_t start = readOffset(i);
+        size_t end = readOffset(i + 1);
+        if (start == 0 || end < start)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Invalid CFF INDEX offsets");
+
+        index.push_back(GetData(dataOffset + start, end - start));
+    }
+
+    offset = dataOffset + readOffset(count);
+}
+
+void PdfFontCFFSubset::ReadDict(const bufferview& data, Dict& dict) const
+{
+    auto buffer = (const unsigned char*)data.data();
+    size_t operandsStart = 0;
+    size_t offset = 0;
+    DictEntry entry;
+    while (offset < data.size())
+    {
+        unsigned char b0 = buffer[offset];
+        if (b0 <= 21)
+        {
+            unsigned op = b0;
+            offset++;
+            if (b0 == 12)
+            {
+                if (offset == data.size())
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Truncated CFF DICT");
+
+                op = (12 << 8) | buffer[offset];
+                offset++;
+            }
+
+            entry.Operator = op;
+            entry.Operands = bufferview(data.data() + operandsStart, offset - operandsStart - (op > 0xFF ? 2 : 1));
+            dict.push_back(std::move(entry));
+            entry = { };
+            operandsStart = offset;
+            continue;
+        }
+
+        double value;
+        if (b0 >= 32 && b0 <= 246)
+        {
+            value = (int)b0 - 139;
+            offset += 1;
+        }
+        else if (b0 >= 247 && b0 <= 254 && offset + 1 < data.size())
+        {
+            int b1 = buffer[offset + 1];
+            if (b0 <= 250)
+                value = ((int)b0 - 247) * 256 + b1 + 108;
+            else
+                value = -((int)b0 - 251) * 256 - b1 - 108;
+
+            offset += 2;
+        }
+        else if (b0 == 28 && offset + 2 < data.size())
+        {
+            value = (int16_t)((buffer[offset + 1] << 8) | buffer[offset + 2]);
+            offset += 3;
+        }
+        else if (b0 == 29 && offset + 4 < data.size())
+        {
+            value = (int32_t)(((uint32_t)buffer[offset + 1] << 24) | ((uint32_t)buffer[offset + 2] << 16)
+                | ((uint32_t)buffer[offset + 3] << 8) | (uint32_t)buffer[offset + 4]);
+            offset += 5;
+        }
+        else if (b0 == 30)
+        {
+            offset += 1;
+            value = readReal(buffer, data.size(), offset);
+        }
+        else
+        {
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Invalid CFF DICT data");
+        }
+
+        entry.Values.push_back(value);
+    }
+}
+
+void PdfFontCFFSubset::ReadPrivateDict(FontDictData& fontData, const Dict& parentDict) const
+{
+    auto entry = findDictEntry(parentDict, (unsigned)CFFOperator::Private);
+    if (entry == nullptr || entry->Values.size() != 2)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Missing CFF Private DICT");
+
+    size_t size = (size_t)entry->Values[0];
+    size_t offset = (size_t)entry->Values[1];
+    ReadDict(GetData(offset, size), fontData.PrivateDict);
+
+    // The local subroutines offset is relative to the Private DICT
+    entry = findDictEntry(fontData.PrivateDict, (unsigned)CFFOperator::Subrs);
+    if (entry != nullptr && entry->Values.size() == 1)
+    {
+        size_t subrsOffset = offset + (size_t)entry->Values[0];
+        ReadIndex(subrsOffset, fontData.LocalSubrs);
+    }
+
+    fontData.UsedLocalSubrs.resize(fontData.LocalSubrs.size());
+}
+
+void PdfFontCFFSubset::ReadFDSelect(size_t offset)
+{
+    size_t glyphCount = m_charStrings.size();
+    m_fdSelect.resize(glyphCount);
+    unsigned format = (unsigned char)GetData(offset, 1)[0];
+    offset++;
+    switch (format)
+    {
+        case 0:
+        {
+            auto fds = GetData(offset, glyphCount);
+            for (size_t i = 0; i < glyphCount; i++)
+                m_fdSelect[i] = (unsigned char)fds[i];
+            break;
+        }
+        case 3:
+        {
+            uint16_t rangeCount;
+            utls::ReadUInt16BE(GetData(offset, 2).data(), rangeCount);
+            offset += 2;
+            auto ranges = GetData(offset, (size_t)rangeCount * 3 + 2);
+            for (unsigned i = 0; i < rangeCount; i++)
+            {
+                uint16_t first;
+                uint16_t next;
+                utls::ReadUInt16BE(ranges.data() + i * 3, first);
+                utls::ReadUInt16BE(ranges.data() + (i + 1) * 3, next);
+                unsigned fd = (unsigned char)ranges[i * 3 + 2];
+                for (unsigned gid = first; gid < next && gid < glyphCount; gid++)
+                    m_fdSelect[gid] = fd;
+            }
+            break;
+        }
+        default:
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFontFormat, "Unsupported CFF FDSelect format {}", format);
+    }
+
+    for (unsigned fd : m_fdSelect)
+    {
+        if (fd >= m_fontDatas.size())
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Invalid CFF FDSelect font dict index");
+    }
+}
+
+void PdfFontCFFSubset::ReadCharset(size_t offset)
+{
+    size_t glyphCount = m_charStrings.size();
+    m_charsetSIDs.resize(glyphCount);
+    if (offset == 0)
+    {
+        // ISOAdobe charset: GIDs are the SIDs of the glyph names
+        for (size_t i = 0; i < glyphCount; i++)
+            m_charsetSIDs[i] = (unsigned)i;
+
+        return;
+    }
+    else if (offset <= 2)
+    {
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFontFormat, "Unsupported CFF Expert charset");
+    }
+
+    unsigned format = (unsigned char)GetData(offset, 1)[0];
+    offset++;
+    size_t gid = 1;
+    uint16_t sid;
+    switch (format)
+    {
+        case 0:
+        {
+            auto sids = GetData(offset, (glyphCount - 1) * 2);
+            for (; gid < glyphCount; gid++)
+            {
+                utls::ReadUInt16BE(sids.data() + (gid - 1) * 2, sid);
+                m_charsetSIDs[gid] = sid;
+            }
+            break;
+        }
+        case 1:
+        case 2:
+        {
+            size_t rangeSize = format == 1 ? 3 : 4;
+            while (gid < glyphCount)
+            {
+                auto range = GetData(offset, rangeSize);
+                unsigned left;
+                utls::ReadUInt16BE(range.data(), sid);
+                if (format == 1)
+                {
+                    left = (unsigned char)range[2];
+                }
+                else
+                {
+                    uint16_t left16;
+                    utls::ReadUInt16BE(range.data() + 2, left16);
+                    left = left16;
+                }
+
+                for (unsigned i = 0; i <= left && gid < glyphCount; i++, gid++)
+                    m_charsetSIDs[gid] = sid + i;
+
+                offset += rangeSize;
+            }
+            break;
+        }
+        default:
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnsupportedFontFormat, "Unsupported CFF charset format {}", format);
+    }
+}
+
+bufferview PdfFontCFFSubset::GetData(size_t offset, size_t size) const
+{
+    if (offset > m_data.size() || size > m_data.size() - offset)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "CFF data out of bounds");
+
+    return bufferview(m_data.data() + offset, size);
+}
+
+void PdfFontCFFSubset::LoadGlyphs(const CIDToGIDMap& cidToGidMap)
+{
+    // For any fonts, assume that glyph 0 is needed
+    m_orderedGIDs.push_back(0);
+    m_orderedCIDs.push_back(0);
+    unsigned nextCid = 1;
+    for (auto& pair : cidToGidMap)
+    {
+        // CID 0 is reserved for .notdef
+        if (pair.first == 0)
+            continue;
+
+        if (pair.second >= m_charStrings.size())
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "GID {} is out of range", pair.second);
+
+        if (!m_isCIDKeyed)
+        {
+            // CIDs are used directly as GIDs in name-keyed
+            // fonts: fill gaps with .notdef glyphs
+            for (; nextCid < pair.first; nextCid++)
+                m_orderedGIDs.push_back(0);
+
+            nextCid++;
+        }
+
+        m_orderedGIDs.push_back(pair.second);
+        m_orderedCIDs.push_back(pair.first);
+    }
+
+    // NOTE: Accent components of "seac" glyphs may be
+    // appended to the list while it's being iterated
+    for (size_t i = 0; i < m_orderedGIDs.size(); i++)
+        LoadGID(m_orderedGIDs[i]);
+}
+
+void PdfFontCFFSubset::LoadGID(unsigned gid)
+{
+    if (m_loadedGIDs[gid])
+        return;
+
+    m_loadedGIDs[gid] = true;
+    if (m_charStringType != 2)
+    {
+        // We can't determine used subroutines in other
+        // charstring formats: just keep all of them
+        m_usedGlobalSubrs.assign(m_usedGlobalSubrs.size(), true);
+        for (auto& fontData : m_fontDatas)
+            fontData.UsedLocalSubrs.assign(fontData.UsedLocalSubrs.size(), true);
+
+        return;
+    }
+
+    CharStringContext ctx;
+    ctx.FontData = &m_fontDatas[m_isCIDKeyed ? m_fdSelect[gid] : 0];
+    ScanCharString(ctx, m_charStrings[gid], 0);
+
+    if (m_isCIDKeyed)
+        return;
+
+    // Add the base and accent glyphs of "seac" glyphs, which are
+    // looked up by name through the StandardEncoding
+    for (unsigned code : ctx.SeacCodes)
+    {
+        unsigned sid = code < 256 ? s_standardEncodingSIDs[code] : 0;
+        if (sid == 0)
+            continue;
+
+        for (unsigned componentGid = 0; componentGid < m_charsetSIDs.size(); componentGid++)
+        {
+            if (m_charsetSIDs[componentGid] != sid)
+                continue;
+
+            if (std::find(m_orderedGIDs.begin(), m_orderedGIDs.end(), componentGid) == m_orderedGIDs.end())
+                m_orderedGIDs.push_back(componentGid);
+
+            break;
+        }
+    }
+}
+
+void PdfFontCFFSubset::ScanCharString(CharStringContext& ctx, const bufferview& charString, unsigned depth)
+{
+    if (depth > MAX_SUBR_NESTING)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Exceeded CFF subroutine nesting limit");
+
+    auto buffer = (const unsigned char*)charString.data();
+    size_t size = charString.size();
+    size_t offset = 0;
+    while (offset < size && !ctx.Ended)
+    {
+        unsigned char b0 = buffer[offset];
+        if (b0 >= 32)
+        {
+            // Numbers. We just need the integer part
+            if (b0 <= 246)
+            {
+                ctx.Stack.push_back((int)b0 - 139);
+                offset += 1;
+            }
+            else if (b0 <= 254)
+            {
+                if (offset + 2 > size)
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Truncated CFF charstring");
+
+                int b1 = buffer[offset + 1];
+                if (b0 <= 250)
+                    ctx.Stack.push_back(((int)b0 - 247) * 256 + b1 + 108);
+                else
+                    ctx.Stack.push_back(-((int)b0 - 251) * 256 - b1 - 108);
+
+                offset += 2;
+            }
+            else
+            {
+                // 16.16 fixed point number
+                if (offset + 5 > size)
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Truncated CFF charstring");
+
+                ctx.Stack.push_back((int16_t)((buffer[offset + 1] << 8) | buffer[offset + 2]));
+                offset += 5;
+            }
+
+            continue;
+        }
+
+        switch ((CharStringOperator)b0)
+        {
+            case CharStringOperator::ShortInt:
+            {
+                if (offset + 3 > size)
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Truncated CFF charstring");
+
+                ctx.Stack.push_back((int16_t)((buffer[offset + 1] << 8) | buffer[offset + 2]));
+                offset += 3;
+                break;
+            }
+            case CharStringOperator::HStem:
+            case CharStringOperator::VStem:
+            case CharStringOperator::HStemHM:
+            case CharStringOperator::VStemHM:
+            {
+                // An odd argument is the glyph width
+                ctx.StemCount += (unsigned)ctx.Stack.size() / 2;
+                ctx.Stack.clear();
+                offset++;
+                break;
+            }
+            case CharStringOperator::HintMask:
+            case CharStringOperator::CntrMask:
+            {
+                // Arguments are implicit vstem hints. The
+                // mask has one bit for each stem hint
+                ctx.StemCount += (unsigned)ctx.Stack.size() / 2;
+                ctx.Stack.clear();
+                offset += 1 + (ctx.StemCount + 7) / 8;
+                break;
+            }
+            case CharStringOperator::CallSubr:
+            case CharStringOperator::CallGSubr:
+            {
+                if (ctx.Stack.empty())
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Missing CFF subroutine index");
+
+                bool local = (CharStringOperator)b0 == CharStringOperator::CallSubr;
+                auto& subrs = local ? ctx.FontData->LocalSubrs : m_globalSubrs;
+                auto& usedSubrs = local ? ctx.FontData->UsedLocalSubrs : m_usedGlobalSubrs;
+                int index = ctx.Stack.back() + (int)getSubrBias(subrs.size());
+                ctx.Stack.pop_back();
+                if (index < 0 || (size_t)index >= subrs.size())
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Invalid CFF subroutine index");
+
+                // NOTE: Always execute the subroutine, even if already
+                // visited, since hints affect following hint masks
+                usedSubrs[index] = true;
+                offset++;
+                ScanCharString(ctx, subrs[index], depth + 1);
+                break;
+            }
+            case CharStringOperator::Return:
+            {
+                return;
+            }
+            case CharStringOperator::EndChar:
+            {
+                // Four arguments (plus the optional width) are
+                // the deprecated "seac" accented character
+                if (ctx.Stack.size() >= 4)
+                {
+                    ctx.SeacCodes.push_back((unsigned)ctx.Stack[ctx.Stack.size() - 2]);
+                    ctx.SeacCodes.push_back((unsigned)ctx.Stack[ctx.Stack.size() - 1]);
+                }
+
+                ctx.Ended = true;
+                return;
+            }
+            case CharStringOperator::Escape:
+            {
+                ctx.Stack.clear();
+                offset += 2;
+                break;
+            }
+            default:
+            {
+                ctx.Stack.clear();
+                offset++;
+                break;
+            }
+        }
+    }
+}
+
+void PdfFontCFFSubset::WriteFont(string& output)
+{
+    // Add the strings needed for the Adobe-Identity-0 ordering
+    vector<bufferview> strings = m_stringIndex;
+    if (m_isCIDKeyed)
+    {
+        strings.push_back(bufferview("Adobe", 5));
+        strings.push_back(bufferview("Identity", 8));
+    }
+
+    vector<bufferview> globalSubrs(m_globalSubrs.size());
+    for (size_t i = 0; i < m_globalSubrs.size(); i++)
+        globalSubrs[i] = m_usedGlobalSubrs[i] ? m_globalSubrs[i] : bufferview(s_stubSubr, 1);
+
+    vector<bufferview> charStrings;
+    charStrings.reserve(m_orderedGIDs.size());
+    for (unsigned gid : m_orderedGIDs)
+        charStrings.push_back(m_charStrings[gid]);
+
+    string charset;
+    WriteCharset(charset);
+    string fdSelect;
+    if (m_isCIDKeyed)
+        WriteFDSelect(fdSelect);
+
+    string charStringsIndex;
+    writeIndex(charStringsIndex, charStrings);
+
+    vector<string> privateDicts(m_fontDatas.size());
+    vector<string> localSubrsIndices(m_fontDatas.size());
+    for (size_t i = 0; i < m_fontDatas.size(); i++)
+    {
+        auto& fontData = m_fontDatas[i];
+        WritePrivateDict(privateDicts[i], fontData);
+        vector<bufferview> localSubrs(fontData.LocalSubrs.size());
+        for (size_t j = 0; j < fontData.LocalSubrs.size(); j++)
+            localSubrs[j] = fontData.UsedLocalSubrs[j] ? fontData.LocalSubrs[j] : bufferview(s_stubSubr, 1);
+
+        writeIndex(localSubrsIndices[i], localSubrs);
+    }
+
+    // Offsets are written with fixed size integers, so DICT sizes
+    // are known in advance and the layout can be computed with
+    // placeholder values. Offsets in order are: charset, FDSelect,
+    // CharStrings, FDArray, followed by the Private DICTs
+    vector<unsigned> offsets(4 + m_fontDatas.size());
+    auto writeFontDicts = [&](string& fdArrayIndex) {
+        vector<string> fontDicts(m_fontDatas.size());
+        for (size_t i = 0; i < m_fontDatas.size(); i++)
+        {
+            for (auto& entry : m_fontDatas[i].FontDict)
+            {
+                if ((CFFOperator)entry.Operator == CFFOperator::Private)
+                    continue;
+
+                fontDicts[i].append(entry.Operands.data(), entry.Operands.size());
+                writeOperator(fontDicts[i], entry.Operator);
+            }
+
+            writeFixedInt(fontDicts[i], (unsigned)privateDicts[i].size());
+            writeFixedInt(fontDicts[i], offsets[4 + i]);
+            writeOperator(fontDicts[i], (unsigned)CFFOperator::Private);
+        }
+
+        vector<bufferview> views;
+        for (auto& fontDict : fontDicts)
+            views.push_back(fontDict);
+
+        writeIndex(fdArrayIndex, views);
+    };
+
+    string nameIndex;
+    writeIndex(nameIndex, m_nameIndex);
+    string stringIndex;
+    writeIndex(stringIndex, strings);
+    string globalSubrsIndex;
+    writeIndex(globalSubrsIndex, globalSubrs);
+
+    string topDict;
+    WriteTopDict(topDict, offsets, (unsigned)privateDicts[0].size());
+    string topDictIndex;
+    writeIndex(topDictIndex, { bufferview(topDict) });
+
+    string fdArrayIndex;
+    if (m_isCIDKeyed)
+        writeFontDicts(fdArrayIndex);
+
+    size_t offset = 4 + nameIndex.size() + topDictIndex.size()
+        + stringIndex.size() + globalSubrsIndex.size();
+    offsets[0] = (unsigned)offset;
+    offset += charset.size();
+    offsets[1] = (unsigned)offset;
+    offset += fdSelect.size();
+    offsets[2] = (unsigned)offset;
+    offset += charStringsIndex.size();
+    offsets[3] = (unsigned)offset;
+    offset += fdArrayIndex.size();
+    for (size_t i = 0; i < m_fontDatas.size(); i++)
+    {
+        offsets[4 + i] = (unsigned)offset;
+        offset += privateDicts[i].size() + localSubrsIndices[i].size();
+    }
+
+    // Write again the DICTs with actual offsets
+    topDict.clear();
+    WriteTopDict(topDict, offsets, (unsigned)privateDicts[0].size());
+    topDictIndex.clear();
+    writeIndex(topDictIndex, { bufferview(topDict) });
+    if (m_isCIDKeyed)
+    {
+        fdArrayIndex.clear();
+        writeFontDicts(fdArrayIndex);
+    }
+
+    output.clear();
+    output.reserve(offset);
+
+    // Header: version 1.0, header size 4, offset size 4
+    output.push_back(1);
+    output.push_back(0);
+    output.push_back(4);
+    output.push_back(4);
+    output.append(nameIndex);
+    output.append(topDictIndex);
+    output.append(stringIndex);
+    output.append(globalSubrsIndex);
+    output.append(charset);
+    output.append(fdSelect);
+    output.append(charStringsIndex);
+    output.append(fdArrayIndex);
+    for (size_t i = 0; i < m_fontDatas.size(); i++)
+    {
+        output.append(privateDicts[i]);
+        output.append(localSubrsIndices[i]);
+    }
+
+    PDFMM_ASSERT(output.size() == offset);
+}
+
+void PdfFontCFFSubset::WriteTopDict(string& output, const vector<unsigned>& offsets, unsigned privateDictSize)
+{
+    if (m_isCIDKeyed)
+    {
+        // ROS must be the first operator
+        writeInt(output, (int)(STANDARD_STRING_COUNT + m_stringIndex.size()));
+        writeInt(output, (int)(STANDARD_STRING_COUNT + m_stringIndex.size() + 1));
+        writeInt(output, 0);
+        writeOperator(output, (unsigned)CFFOperator::ROS);
+    }
+
+    for (auto& entry : m_topDict)
+    {
+        switch ((CFFOperator)entry.Operator)
+        {
+            // Skip entries being rewritten. Unique identifiers
+            // are removed as the subset is a different font
+            case CFFOperator::UniqueID:
+            case CFFOperator::XUID:
+            case CFFOperator::Charset:
+            case CFFOperator::Encoding:
+            case CFFOperator::CharStrings:
+            case CFFOperator::Private:
+            case CFFOperator::ROS:
+            case CFFOperator::CIDCount:
+            case CFFOperator::UIDBase:
+            case CFFOperator::FDArray:
+            case CFFOperator::FDSelect:
+                continue;
+            default:
+                output.append(entry.Operands.data(), entry.Operands.size());
+                writeOperator(output, entry.Operator);
+                break;
+        }
+    }
+
+    if (m_isCIDKeyed)
+    {
+        writeInt(output, (int)m_orderedCIDs.back() + 1);
+        writeOperator(output, (unsigned)CFFOperator::CIDCount);
+    }
+
+    writeFixedInt(output, offsets[0]);
+    writeOperator(output, (unsigned)CFFOperator::Charset);
+    writeFixedInt(output, offsets[2]);
+    writeOperator(output, (unsigned)CFFOperator::CharStrings);
+    if (m_isCIDKeyed)
+    {
+        writeFixedInt(output, offsets[3]);
+        writeOperator(output, (unsigned)CFFOperator::FDArray);
+        writeFixedInt(output, offsets[1]);
+        writeOperator(output, (unsigned)CFFOperator::FDSelect);
+    }
+    else
+    {
+        writeFixedInt(output, privateDictSize);
+        writeFixedInt(output, offsets[4]);
+        writeOperator(output, (unsigned)CFFOperator::Private);
+    }
+}
+
+void PdfFontCFFSubset::WritePrivateDict(string& output, const FontDictData& fontData)
+{
+    for (auto& entry : fontData.PrivateDict)
+    {
+        if ((CFFOperator)entry.Operator == CFFOperator::Subrs)
+            continue;
+
+        output.append(entry.Operands.data(), entry.Operands.size());
+        writeOperator(output, entry.Operator);
+    }
+
+    if (fontData.LocalSubrs.size() != 0)
+    {
+        // The local subroutines immediately follow the Private DICT
+        writeFixedInt(output, (unsigned)output.size() + 6);
+        writeOperator(output, (unsigned)CFFOperator::Subrs);
+    }
+}
+
+void PdfFontCFFSubset::WriteCharset(string& output)
+{
+    // The charset maps GIDs to SIDs in name-keyed
+    // fonts, or to CIDs in CID-keyed fonts
+    vector<unsigned> values;
+    values.reserve(m_orderedGIDs.size() - 1);
+    for (size_t i = 1; i < m_orderedGIDs.size(); i++)
+    {
+        if (m_isCIDKeyed)
+            values.push_back(i < m_orderedCIDs.size() ? m_orderedCIDs[i] : 0);
+        else
+            values.push_back(m_charsetSIDs[m_orderedGIDs[i]]);
+    }
+
+    // Use ranges (format 2) if they are more compact
+    unsigned rangeCount = 0;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (i == 0 || values[i] != values[i - 1] + 1)
+            rangeCount++;
+    }
+
+    if (rangeCount * 4 < values.size() * 2)
+    {
+        output.push_back(2);
+        size_t start = 0;
+        for (size_t i = 1; i <= values.size(); i++)
+        {
+            if (i == values.size() || values[i] != values[i - 1] + 1)
+            {
+                writeCard16(output, values[start]);
+                writeCard16(output, (unsigned)(i - start - 1));
+                start = i;
+            }
+        }
+    }
+    else
+    {
+        output.push_back(0);
+        for (unsigned value : values)
+            writeCard16(output, value);
+    }
+}
+
+void PdfFontCFFSubset::WriteFDSelect(string& output)
+{
+    // Format 3: ranges of glyphs with the same font dict
+    vector<pair<unsigned, unsigned>> ranges;
+    for (unsigned i = 0; i < m_orderedGIDs.size(); i++)
+    {
+        unsigned fd = m_fdSelect[m_orderedGIDs[i]];
+        if (ranges.empty() || ranges.back().second != fd)
+            ranges.push_back({ i, fd });
+    }
+
+    output.push_back(3);
+    writeCard16(output, (unsigned)ranges.size());
+    for (auto& range : ranges)
+    {
+        writeCard16(output, range.first);
+        output.push_back((char)range.second);
+    }
+
+    // Sentinel
+    writeCard16(output, (unsigned)m_orderedGIDs.size());
+}
+
+const PdfFontCFFSubset::DictEntry* PdfFontCFFSubset::findDictEntry(const Dict& dict, unsigned op)
+{
+    for (auto& entry : dict)
+    {
+        if (entry.Operator == op)
+            return &entry;
+    }
+
+    return nullptr;
+}
+
+// Return the bare CFF data, extracting it from
+// the "CFF " table of OpenType fonts
+bufferview getCFFTable(const bufferview& data)
+{
+    if (data.size() < 12)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Invalid CFF font data");
+
+    uint32_t tag;
+    utls::ReadUInt32BE(data.data(), tag);
+    if (tag != OPENTYPE_CFF_TAG)
+        return data;
+
+    uint16_t tableCount;
+    utls::ReadUInt16BE(data.data() + 4, tableCount);
+    for (unsigned i = 0; i < tableCount; i++)
+    {
+        size_t recordOffset = 12 + (size_t)i * 16;
+        if (recordOffset + 16 > data.size())
+            break;
+
+        uint32_t offset;
+        uint32_t length;
+        utls::ReadUInt32BE(data.data() + recordOffset, tag);
+        utls::ReadUInt32BE(data.data() + recordOffset + 8, offset);
+        utls::ReadUInt32BE(data.data() + recordOffset + 12, length);
+        if (tag != CFF_TABLE_TAG)
+            continue;
+
+        if (offset > data.size() || length > data.size() - offset)
+            break;
+
+        return bufferview(data.data() + offset, length);
+    }
+
+    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontFile, "Missing OpenType CFF table");
+}
+
+unsigned getSubrBias(size_t subrCount)
+{
+    if (subrCount < 1240)
+        return 107;
+    else if (subrCount < 33900)
+        return 1131;
+    else
+        return 32768;
+}
+
+void writeIndex(string& output, const vector<bufferview>& index)
+{
+    writeCard16(output, (unsigned)index.size());
+    if (index.size() == 0)
+        return;
+
+    size_t dataSize = 0;
+    for (auto& item : index)
+        dataSize += item.size();
+
+    // Offsets start from 1
+    unsigned offSize;
+    if (dataSize + 1 <= 0xFF)
+        offSize = 1;
+    else if (dataSize + 1 <= 0xFFFF)
+        offSize = 2;
+    else if (dataSize + 1 <= 0xFFFFFF)
+        offSize = 3;
+    else
+        offSize = 4;
+
+    output.push_back((char)offSize);
+    size_t offset = 1;
+    auto writeOffset = [&]() {
+        for (unsigned i = offSize; i > 0; i--)
+            output.push_back((char)((offset >> ((i - 1) * 8)) & 0xFF));
+    };
+
+    writeOffset();
+    for (auto& item : index)
+    {
+        offset += item.size();
+        writeOffset();
+    }
+
+    for (auto& item : index)
+        output.append(item.data(), item.size());
+}
+
+void writeOperator(string& output, unsigned op)
+{
+    if (op > 0xFF)
+        output.push_back(12);
+
+    output.push_back((char)(op & 0xFF));
+}
+
+void writeInt(string& output, int value)
+{
+    if (value >= -107 && value <= 107)
+    {
+        output.push_back((char)(value + 139));
+    }
+    else if (value >= 108 && value <= 1131)
+    {
+        value -= 108;
+        output.push_back((char)((value >> 8) + 247));
+        output.push_back((char)(value & 0xFF));
+    }
+    else if (value >= -1131 && value <= -108)
+    {
+        value = -value - 108;
+        output.push_back((char)((value >> 8) + 251));
+        output.push_back((char)(value & 0xFF));
+    }
+    else if (value >= -32768 && value <= 32767)
+    {
+        output.push_back(28);
+        output.push_back((char)((value >> 8) & 0xFF));
+        output.push_back((char)(value & 0xFF));
+    }
+    else
+    {
+        writeFixedInt(output, (unsigned)value);
+    }
+}
+
+void writeFixedInt(string& output, unsigned value)
+{
+    // Always use the 5 bytes integer encoding
+    output.push_back(29);
+    output.push_back((char)((value >> 24) & 0xFF));
+    output.push_back((char)((value >> 16) & 0xFF));
+    output.push_back((char)((value >> 8) & 0xFF));
+    output.push_back((char)(value & 0xFF));
+}
+
+void writeCard16(string& output, unsigned value)
+{
+    output.push_back((char)((value >> 8) & 0xFF));
+    output.push_back((char)(value & 0xFF));
+}
+
+double readReal(const unsigned char* data, size_t size, size_t& offset)
+{
+    static const char* nibbles[] = { "0", "1", "2", "3", "4", "5", "6", "7",
+        "8", "9", ".", "E", "E-", "", "-", "" };
+
+    string str;
+    while (offset < size)
+    {
+        unsigned char b = data[offset];
+        offset++;
+        unsigned high = b >> 4;
+        unsigned low = b & 0xF;
+        if (high == 0xF)
+            break;
+
+        str.append(nibbles[high]);
+        if (low == 0xF)
+            break;
+
+        str.append(nibbles[low]);
+    }
+
+    return std::strtod(str.c_str(), nullptr);
+}
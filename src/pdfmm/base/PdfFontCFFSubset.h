@@ -0,0 +1,116 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef PDF_FONT_CFF_SUBSET_H
+#define PDF_FONT_CFF_SUBSET_H
+
+#include "PdfDeclarations.h"
+#include "PdfFontMetrics.h"
+
+namespace mm {
+
+/**
+ * This class is able to build a new CFF font with only
+ * certain glyphs from an existing CFF font, either bare
+ * or wrapped in an OpenType font.
+ *
+ * Only the charstrings of the selected glyphs are copied,
+ * global and local subroutines not called by them are
+ * replaced with empty stubs, so the subroutine numbering
+ * of the original font is preserved
+ */
+class PDFMM_API PdfFontCFFSubset final
+{
+private:
+    PdfFontCFFSubset(const bufferview& data);
+
+public:
+    /**
+     * Actually generate the subsetted font. The glyphs in the
+     * subset will be the .notdef glyph followed by the glyphs
+     * of the map ordered by CID. CID-keyed fonts will use the
+     * Adobe-Identity-0 ordering with a charset mapping the glyphs
+     * to the CIDs of the map. Name-keyed fonts will stay such, the
+     * CIDs to be used directly as GIDs of the subset
+     *
+     * \param output write the bare CFF font to this buffer
+     * \param metrics font metrics object for this font
+     * \param cidToGidMap a map of CIDs to GIDs of the original font
+     */
+    static void BuildFont(std::string& output, const PdfFontMetrics& metrics,
+        const CIDToGIDMap& cidToGidMap);
+
+private:
+    PdfFontCFFSubset(const PdfFontCFFSubset& rhs) = delete;
+    PdfFontCFFSubset& operator=(const PdfFontCFFSubset& rhs) = delete;
+
+    void BuildFont(std::string& output, const CIDToGIDMap& cidToGidMap);
+
+private:
+    struct DictEntry
+    {
+        unsigned Operator = 0;
+        bufferview Operands;
+        std::vector<double> Values;
+    };
+
+    using Dict = std::vector<DictEntry>;
+
+    struct FontDictData
+    {
+        Dict FontDict;
+        Dict PrivateDict;
+        std::vector<bufferview> LocalSubrs;
+        std::vector<bool> UsedLocalSubrs;
+    };
+
+    struct CharStringContext
+    {
+        FontDictData* FontData = nullptr;
+        std::vector<int> Stack;
+        unsigned StemCount = 0;
+        bool Ended = false;
+        std::vector<unsigned> SeacCodes;
+    };
+
+    void Init();
+    void ReadIndex(size_t& offset, std::vector<bufferview>& index) const;
+    void ReadDict(const bufferview& data, Dict& dict) const;
+    void ReadPrivateDict(FontDictData& fontData, const Dict& parentDict) const;
+    void ReadFDSelect(size_t offset);
+    void ReadCharset(size_t offset);
+    bufferview GetData(size_t offset, size_t size) const;
+    static const DictEntry* findDictEntry(const Dict& dict, unsigned op);
+
+    void LoadGlyphs(const CIDToGIDMap& cidToGidMap);
+    void LoadGID(unsigned gid);
+    void ScanCharString(CharStringContext& ctx, const bufferview& charString, unsigned depth);
+    void WriteFont(std::string& output);
+    void WriteTopDict(std::string& output, const std::vector<unsigned>& offsets, unsigned privateDictSize);
+    void WritePrivateDict(std::string& output, const FontDictData& fontData);
+    void WriteCharset(std::string& output);
+    void WriteFDSelect(std::string& output);
+
+private:
+    bufferview m_data;
+    bool m_isCIDKeyed;
+    unsigned m_charStringType;
+    std::vector<bufferview> m_nameIndex;
+    std::vector<bufferview> m_stringIndex;
+    std::vector<bufferview> m_globalSubrs;
+    std::vector<bufferview> m_charStrings;
+    Dict m_topDict;
+    std::vector<FontDictData> m_fontDatas;
+    std::vector<unsigned> m_fdSelect;     // Font dict index of each glyph, CID-keyed fonts only
+    std::vector<unsigned> m_charsetSIDs;  // Glyph name SID of each glyph, name-keyed fonts only
+    std::vector<bool> m_usedGlobalSubrs;
+    std::vector<unsigned> m_orderedGIDs;  // Ordered list of original GIDs as they will appear in the subset
+    std::vector<unsigned> m_orderedCIDs;  // CIDs of the glyphs in the subset, CID-keyed fonts only
+    std::vector<bool> m_loadedGIDs;
+};
+
+};
+
+#endif // PDF_FONT_CFF_SUBSET_H
@@ -128,6 +128,35 @@ void PdfFontCID::createWidths(PdfDictionary& fontDict, const CIDToGIDMap& cidToG
     }
 }
 
+void PdfFontCID::createCIDSet()
+{
+    // NOTE: The CIDSet entry is optional and it's actually
+    // deprecated in PDF 2.0 but it's required for PDFA/1 compliance
+    auto& usedGIDs = GetUsedGIDs();
+    string cidSetData;
+    for (auto& pair : usedGIDs)
+    {
+        // ISO 32000-1:2008: Table 124 – Additional font descriptor entries for CIDFonts
+        // CIDSet "The stream’s data shall be organized as a table of bits
+        // indexed by CID. The bits shall be stored in bytes with the
+        // high - order bit first.Each bit shall correspond to a CID.
+        // The most significant bit of the first byte shall correspond
+        // to CID 0, the next bit to CID 1, and so on"
+
+        static const char bits[] = { '\x80', '\x40', '\x20', '\x10', '\x08', '\x04', '\x02', '\x01' };
+        unsigned gid = pair.second.Id;
+        unsigned dataIndex = gid >> 3;
+        if (cidSetData.size() < dataIndex + 1)
+            cidSetData.resize(dataIndex + 1);
+
+        cidSetData[dataIndex] |= bits[gid & 7];
+    }
+
+    auto& cidSetObj = this->GetObject().GetDocument()->GetObjects().CreateDictionaryObject();
+    cidSetObj.GetOrCreateStream().SetData(cidSetData);
+    GetDescriptor().GetDictionary().AddKeyIndirect("CIDSet", cidSetObj);
+}
+
 CIDToGIDMap PdfFontCID::getIdentityCIDToGIDMap()
 {
     PDFMM_ASSERT(!IsSubsettingEnabled());
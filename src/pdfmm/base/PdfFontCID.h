@@ -28,6 +28,7 @@ protected:
     void embedFont() override;
     PdfObject* getDescendantFontObject() override;
     void createWidths(PdfDictionary& fontDict, const CIDToGIDMap& glyphWidths);
+    void createCIDSet();
     static CIDToGIDMap getCIDToGIDMapSubset(const UsedGIDsMap& usedGIDs);
 
 private:
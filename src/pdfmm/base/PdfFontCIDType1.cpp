@@ -7,6 +7,8 @@
 #include <pdfmm/private/PdfDeclarationsPrivate.h>
 #include "PdfFontCIDType1.h"
 
+#include "PdfFontCFFSubset.h"
+
 using namespace std;
 using namespace mm;
 
@@ -15,8 +17,11 @@ PdfFontCIDType1::PdfFontCIDType1(PdfDocument& doc, const PdfFontMetricsConstPtr&
 
 bool PdfFontCIDType1::SupportsSubsetting() const
 {
-    // Not yet supported
-    return false;
+    // Only CFF fonts, bare or wrapped in OpenType, are supported.
+    // Subset CIDs are assigned sequentially, so the encoding
+    // must also be dynamically generated
+    return GetMetrics().GetFontFileType() == PdfFontFileType::Type1CCF
+        && GetEncoding().IsDynamicEncoding();
 }
 
 PdfFontType PdfFontCIDType1::GetType() const
@@ -26,5 +31,13 @@ PdfFontType PdfFontCIDType1::GetType() const
 
 void PdfFontCIDType1::embedFontSubset()
 {
-    PDFMM_RAISE_ERROR(PdfErrorCode::NotImplemented);
+    auto& usedGIDs = GetUsedGIDs();
+    CIDToGIDMap cidToGidMap = getCIDToGIDMapSubset(usedGIDs);
+    createWidths(GetDescendantFont().GetDictionary(), cidToGidMap);
+    m_Encoding->ExportToFont(*this);
+
+    charbuff buffer;
+    PdfFontCFFSubset::BuildFont(buffer, GetMetrics(), cidToGidMap);
+    EmbedFontFileType1CCF(GetDescriptor(), buffer);
+    createCIDSet();
 }
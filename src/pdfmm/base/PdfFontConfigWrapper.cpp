@@ -34,6 +34,24 @@ PdfFontConfigWrapper::~PdfFontConfigWrapper()
 string PdfFontConfigWrapper::GetFontConfigFontPath(const string_view fontName,
     PdfFontStyle style, unsigned& faceIndex)
 {
+    auto key = make_pair(string(fontName), style);
+    lock_guard<mutex> lock(m_mutex);
+    auto found = m_matchCache.find(key);
+    if (found != m_matchCache.end())
+    {
+        faceIndex = found->second.FaceIndex;
+        return found->second.Path;
+    }
+
+    string path = getFontConfigFontPath(key.first, style, faceIndex);
+    m_matchCache.emplace(std::move(key), MatchResult{ path, faceIndex });
+    return path;
+}
+
+string PdfFontConfigWrapper::getFontConfigFontPath(const string& fontName,
+    PdfFontStyle style, unsigned& faceIndex)
+{
+    faceIndex = 0;
     FcPattern* pattern;
     FcPattern* matched;
     FcResult result = FcResultMatch;
@@ -43,7 +61,7 @@ string PdfFontConfigWrapper::GetFontConfigFontPath(const string_view fontName,
     bool isBold = (style & PdfFontStyle::Bold) == PdfFontStyle::Bold;
 
     // Build a pattern to search using postscript name, bold and italic
-    pattern = FcPatternBuild(0, FC_POSTSCRIPT_NAME, FcTypeString, fontName.data(),
+    pattern = FcPatternBuild(0, FC_POSTSCRIPT_NAME, FcTypeString, fontName.c_str(),
         FC_WEIGHT, FcTypeInteger, (isBold ? FC_WEIGHT_BOLD : FC_WEIGHT_MEDIUM),
         FC_SLANT, FcTypeInteger, (isItalic ? FC_SLANT_ITALIC : FC_SLANT_ROMAN),
         static_cast<char*>(0));
@@ -78,8 +96,12 @@ string PdfFontConfigWrapper::GetFontConfigFontPath(const string_view fontName,
 
 void PdfFontConfigWrapper::AddFontDirectory(const string_view& path)
 {
+    lock_guard<mutex> lock(m_mutex);
     if (!FcConfigAppFontAddDir(m_FcConfig, (const FcChar8*)path.data()))
         throw runtime_error("Unable to add font directory");
+
+    // New fonts may give better matches
+    m_matchCache.clear();
 }
 
 FcConfig* PdfFontConfigWrapper::GetFcConfig()
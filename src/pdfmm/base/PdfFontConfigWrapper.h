@@ -9,6 +9,9 @@
 
 #include "PdfDeclarations.h"
 
+#include <map>
+#include <mutex>
+
 FORWARD_DECLARE_FCONFIG();
 
 namespace mm {
@@ -24,6 +27,9 @@ namespace mm {
  * will destroy the fontconfig handle.
  *
  * The fontconfig library is initialized on first used (lazy loading!)
+ *
+ * Font matches are cached and the wrapper can be safely used by
+ * multiple threads
  */
 class PDFMM_API PdfFontConfigWrapper final
 {
@@ -38,8 +44,8 @@ public:
     /** Get the path of a font file on a Unix system using fontconfig
      *
      *  This method is only available if pdfmm was compiled with
-     *  fontconfig support. Make sure to lock any FontConfig mutexes before
-     *  calling this method by yourself!
+     *  fontconfig support. The result is cached, so following calls
+     *  with the same parameters don't query fontconfig again
      *
      *  \param fontName name of the requested font
      *  \param style font style
@@ -58,8 +64,21 @@ private:
 
     void createDefaultConfig();
 
+    std::string getFontConfigFontPath(const std::string& fontName, PdfFontStyle style, unsigned& faceIndex);
+
+private:
+    struct MatchResult
+    {
+        std::string Path;
+        unsigned FaceIndex;
+    };
+
+    using MatchCache = std::map<std::pair<std::string, PdfFontStyle>, MatchResult>;
+
 private:
     FcConfig* m_FcConfig;
+    std::mutex m_mutex;
+    MatchCache m_matchCache;
 };
 
 };
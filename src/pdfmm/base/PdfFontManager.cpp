@@ -8,6 +8,8 @@
 #include "PdfFontManager.h"
 
 #include <algorithm>
+#include <mutex>
+#include <set>
 
 #if defined(_WIN32) && defined(PDFMM_HAVE_WIN32GDI)
 #include <pdfmm/private/WindowsLeanMean.h>
@@ -18,6 +20,7 @@
 #include <utfcpp/utf8.h>
 
 #include "PdfDictionary.h"
+#include "PdfDocument.h"
 #include "PdfInputDevice.h"
 #include "PdfOutputDevice.h"
 #include "PdfFont.h"
@@ -43,8 +46,32 @@ static PdfFont* matchFont(const mspan<PdfFont*>& fonts, const string_view& fontN
 
 #if defined(PDFMM_HAVE_FONTCONFIG)
 shared_ptr<PdfFontConfigWrapper> PdfFontManager::m_fontConfig;
+static mutex s_fontConfigMutex;
 #endif
 
+namespace
+{
+    using FontFileKey = pair<string, unsigned>;
+
+    // Process wide cache of metrics of fonts loaded from files,
+    // keyed by file path and face index. Font data is immutable
+    // so it can be shared among all the documents
+    struct FontMetricsCache
+    {
+        mutex Mutex;
+        map<FontFileKey, PdfFontMetricsConstPtr> Metrics;
+        // Files that failed to load, so they are not tried again
+        set<FontFileKey> Failures;
+    };
+}
+
+static FontMetricsCache& getFontMetricsCache();
+
+// When the cache is full metrics not used by any document are
+// dropped, so the cache doesn't grow forever in long running processes
+static constexpr size_t MAX_CACHED_FONT_METRICS = 256;
+static constexpr size_t MAX_CACHED_FONT_FAILURES = 1024;
+
 static constexpr unsigned SUBSET_PREFIX_LEN = 6;
 
 PdfFontManager::PdfFontManager(PdfDocument& doc)
@@ -101,6 +128,11 @@ PdfFont* PdfFontManager::GetLoadedFont(const PdfObject& obj)
     if (!obj.IsIndirect())
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Object is not indirect");
 
+    // Fonts of frozen documents may be requested by multiple threads
+    unique_lock<recursive_mutex> lock;
+    if (m_doc->IsFrozen())
+        lock = unique_lock<recursive_mutex>(m_loadedFontsMutex);
+
     auto found = m_fonts.find(obj.GetIndirectReference());
     if (found != m_fonts.end())
     {
@@ -115,6 +147,10 @@ PdfFont* PdfFontManager::GetLoadedFont(const PdfObject& obj)
     if (!PdfFont::TryCreateFromObject(const_cast<PdfObject&>(obj), font))
         return nullptr;
 
+    // Lazily computed data must be ready before sharing the font
+    if (m_doc->IsFrozen())
+        font->initWordSpacingLength();
+
     auto inserted = m_fonts.emplace(obj.GetIndirectReference(), Storage{ true, std::move(font) });
     return inserted.first->second.Font.get();
 }
@@ -182,11 +218,10 @@ PdfFont* PdfFontManager::getImportedFont(const string_view& fontName, const stri
     if (found != m_importedFonts.end())
         return matchFont(found->second, fontName, searchParams);
 
-    shared_ptr<charbuff> buffer = getFontData(baseFontName, searchParams);
-    if (buffer == nullptr)
+    auto metrics = searchFontMetrics(baseFontName, searchParams);
+    if (metrics == nullptr)
         return nullptr;
 
-    shared_ptr<PdfFontMetrics> metrics = PdfFontMetricsFreetype::FromBuffer(buffer);
     return getImportedFont(metrics, createParams,
         [&searchParams,&fontName](const mspan<PdfFont*>& fonts) {
             return matchFont(fonts, fontName, searchParams);
@@ -205,11 +240,7 @@ PdfFontMetricsConstPtr PdfFontManager::GetFontMetrics(const string_view& fontNam
     }
 
     PdfFontSearchParams newParams = params;
-    auto fontData = getFontData(adaptSearchParams(fontName, newParams), newParams);
-    if (fontData == nullptr)
-        return nullptr;
-
-    return PdfFontMetricsFreetype::FromBuffer(std::move(fontData));
+    return searchFontMetrics(adaptSearchParams(fontName, newParams), newParams);
 }
 
 void PdfFontManager::AddFontDirectory(const string_view& path)
@@ -250,35 +281,76 @@ void PdfFontManager::AddFontDirectory(const string_view& path)
 #endif
 }
 
-unique_ptr<charbuff> PdfFontManager::getFontData(const string_view& fontName,
+PdfFontMetricsConstPtr PdfFontManager::searchFontMetrics(const string_view& fontName,
     const PdfFontSearchParams& params)
 {
-    return getFontData(fontName, { }, 0, params);
-}
-
-unique_ptr<charbuff> PdfFontManager::getFontData(const string_view& fontName,
-    string filepath, unsigned faceIndex, const PdfFontSearchParams& params)
-{
-    if (filepath.empty())
-    {
+    string filepath;
+    unsigned faceIndex = 0;
 #ifdef PDFMM_HAVE_FONTCONFIG
-        auto& fc = GetFontConfigWrapper();
-        filepath = fc.GetFontConfigFontPath(fontName, params.Style, faceIndex);
+    auto& fc = GetFontConfigWrapper();
+    filepath = fc.GetFontConfigFontPath(fontName, params.Style, faceIndex);
 #endif
-    }
 
-    unique_ptr<charbuff> ret;
+    PdfFontMetricsConstPtr ret;
     if (!filepath.empty())
-        ret = ::getFontData(filepath, faceIndex);
+        ret = getFontMetrics(filepath, faceIndex);
 
 #if defined(_WIN32) && defined(PDFMM_HAVE_WIN32GDI)
     if (ret == nullptr)
-        ret = getWin32FontData(fontName, params);
+    {
+        shared_ptr<charbuff> buffer = getWin32FontData(fontName, params);
+        if (buffer != nullptr)
+            ret = PdfFontMetricsFreetype::FromBuffer(buffer);
+    }
 #endif
 
     return ret;
 }
 
+PdfFontMetricsConstPtr PdfFontManager::getFontMetrics(const string& filepath, unsigned faceIndex)
+{
+    // NOTE: The lock is held while loading the font so
+    // the same file is never loaded twice concurrently
+    auto& cache = getFontMetricsCache();
+    lock_guard<mutex> lock(cache.Mutex);
+    FontFileKey key(filepath, faceIndex);
+    auto found = cache.Metrics.find(key);
+    if (found != cache.Metrics.end())
+        return found->second;
+
+    if (cache.Failures.find(key) != cache.Failures.end())
+        return nullptr;
+
+    shared_ptr<charbuff> buffer = ::getFontData(filepath, faceIndex);
+    if (buffer == nullptr)
+    {
+        if (cache.Failures.size() == MAX_CACHED_FONT_FAILURES)
+            cache.Failures.clear();
+
+        cache.Failures.insert(std::move(key));
+        return nullptr;
+    }
+
+    auto metrics = PdfFontMetricsFreetype::FromBuffer(buffer);
+    // Compute the lazily evaluated style before sharing the metrics
+    (void)metrics->GetStyle();
+
+    if (cache.Metrics.size() >= MAX_CACHED_FONT_METRICS)
+    {
+        for (auto it = cache.Metrics.begin(); it != cache.Metrics.end(); )
+        {
+            if (it->second.use_count() == 1)
+                it = cache.Metrics.erase(it);
+            else
+                it++;
+        }
+    }
+
+    PdfFontMetricsConstPtr ret = std::move(metrics);
+    cache.Metrics.emplace(std::move(key), ret);
+    return ret;
+}
+
 PdfFont* PdfFontManager::GetFont(FT_Face face, const PdfFontCreateParams& params)
 {
     string fontName = FT_Get_Postscript_Name(face);
@@ -432,12 +504,10 @@ PdfFont* PdfFontManager::getImportedFont(const PdfFontMetricsConstPtr& metrics,
 
 void PdfFontManager::SetFontConfigWrapper(const shared_ptr<PdfFontConfigWrapper>& fontConfig)
 {
-    if (m_fontConfig == fontConfig)
-        return;
-
     if (fontConfig == nullptr)
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Fontconfig wrapper can't be null");
 
+    lock_guard<mutex> lock(s_fontConfigMutex);
     m_fontConfig = fontConfig;
 }
 
@@ -449,6 +519,7 @@ PdfFontConfigWrapper& PdfFontManager::GetFontConfigWrapper()
 
 shared_ptr<PdfFontConfigWrapper> PdfFontManager::ensureInitializedFontConfig()
 {
+    lock_guard<mutex> lock(s_fontConfigMutex);
     auto ret = m_fontConfig;
     if (ret == nullptr)
     {
@@ -480,6 +551,15 @@ bool PdfFontManager::EqualElement::operator()(const Descriptor& lhs, const Descr
     return lhs.EncodingId == rhs.EncodingId && lhs.Style == rhs.Style && lhs.FontName == rhs.FontName;
 }
 
+FontMetricsCache& getFontMetricsCache()
+{
+    // Initialize the FreeType library before the cache, so
+    // the cached faces are released before the library
+    (void)mm::GetFreeTypeLibrary();
+    static FontMetricsCache s_cache;
+    return s_cache;
+}
+
 unique_ptr<charbuff> getFontData(const string_view& filename, unsigned short faceIndex)
 {
     FT_Error rc;
@@ -9,6 +9,8 @@
 
 #include "PdfDeclarations.h"
 
+#include <mutex>
+
 #include "PdfFont.h"
 #include "PdfEncodingFactory.h"
 
@@ -98,6 +100,10 @@ public:
     PdfFont* GetFont(FT_Face face, const PdfFontCreateParams& params = { });
 
     /** Try to search for fontmetrics from the given fontname and parameters
+     *
+     * Metrics of fonts loaded from files are cached process wide
+     * and shared among all the documents, so the returned instance
+     * may be used concurrently by other threads
      *
      * \returns the found metrics. Null if not found
      */
@@ -187,10 +193,9 @@ private:
     static std::shared_ptr<PdfFontConfigWrapper> ensureInitializedFontConfig();
 #endif // PDFMM_HAVE_FONTCONFIG
 
-    static std::unique_ptr<charbuff> getFontData(const std::string_view& fontName,
+    static PdfFontMetricsConstPtr searchFontMetrics(const std::string_view& fontName,
         const PdfFontSearchParams& params);
-    static std::unique_ptr<charbuff> getFontData(const std::string_view& fontName,
-        std::string filepath, unsigned faceIndex, const PdfFontSearchParams& params);
+    static PdfFontMetricsConstPtr getFontMetrics(const std::string& filepath, unsigned faceIndex);
     PdfFont* getImportedFont(const std::string_view& fontName, const std::string_view& baseFontName,
         const PdfFontSearchParams& searchParams, const PdfFontCreateParams& createParams);
     static std::string adaptSearchParams(const std::string_view& fontName,
@@ -212,6 +217,8 @@ private:
     ImportedFontMap m_importedFonts;
     // Map of all fonts
     FontMap m_fonts;
+    // Guards the loaded fonts of documents with concurrent read access
+    std::recursive_mutex m_loadedFontsMutex;
 
 #ifdef PDFMM_HAVE_FONTCONFIG
     static std::shared_ptr<PdfFontConfigWrapper> m_fontConfig;
@@ -273,12 +273,9 @@ bool PdfFontMetrics::TryGetImplicitEncoding(PdfEncodingMapConstPtr& encoding) co
     {
         // 2.1) An encoding stored in the font program (Type1)
         // ISO 32000-1:2008 9.6.6.2 "Encodings for Type 1 Fonts"
-        FT_Face face;
-        if (TryGetOrLoadFace(face))
-        {
-            encoding = getFontType1Encoding(face);
+        encoding = getImplicitType1Encoding();
+        if (encoding != nullptr)
             return true;
-        }
     }
     else if (IsTrueTypeKind())
     {
@@ -325,35 +322,38 @@ const PdfCIDToGIDMapConstPtr& PdfFontMetrics::getCIDToGIDMap() const
     return s_null;
 }
 
-PdfFontMetricsBase::PdfFontMetricsBase()
-    : m_dataInit(false), m_faceInit(false) { }
+PdfEncodingMapConstPtr PdfFontMetrics::getImplicitType1Encoding() const
+{
+    FT_Face face;
+    if (!TryGetOrLoadFace(face))
+        return nullptr;
+
+    return getFontType1Encoding(face);
+}
+
+PdfFontMetricsBase::PdfFontMetricsBase() { }
 
 const datahandle& PdfFontMetricsBase::GetFontFileDataHandle() const
 {
-    if (!m_dataInit)
+    auto& rthis = const_cast<PdfFontMetricsBase&>(*this);
+    std::call_once(rthis.m_dataInit, [&rthis]()
     {
-        auto& rthis = const_cast<PdfFontMetricsBase&>(*this);
-        rthis.m_Data = getFontFileDataHandle();
-        rthis.m_dataInit = true;
-    }
+        rthis.m_Data = rthis.getFontFileDataHandle();
+    });
 
     return m_Data;
 }
 
 const FreeTypeFacePtr& PdfFontMetricsBase::GetFaceHandle() const
 {
-    if (!m_faceInit)
+    auto& rthis = const_cast<PdfFontMetricsBase&>(*this);
+    std::call_once(rthis.m_faceInit, [&rthis]()
     {
-        auto& rthis = const_cast<PdfFontMetricsBase&>(*this);
-        auto view = GetFontFileDataHandle().view();
+        auto view = rthis.GetFontFileDataHandle().view();
         FT_Face face;
         if (view.size() != 0 && mm::TryCreateFreeTypeFace(view, face))
             rthis.m_Face = FreeTypeFacePtr(face);
-        else
-            rthis.m_Face = FreeTypeFacePtr();
-
-        rthis.m_faceInit = true;
-    }
+    });
 
     return m_Face;
 }
@@ -9,6 +9,8 @@
 
 #include "PdfDeclarations.h"
 
+#include <mutex>
+
 #include "PdfString.h"
 #include "PdfCMapEncoding.h"
 #include "PdfCIDToGIDMap.h"
@@ -120,6 +122,10 @@ public:
     /** Get direct access to the internal FreeType handle
      *
      *  \returns the internal freetype handle
+     *  \remarks Metrics of fonts loaded from files are shared among
+     *  documents and may be used concurrently: the access to the face
+     *  is not synchronized, so it must not be modified (eg. by changing
+     *  the selected charmap or by loading glyphs)
      */
     bool TryGetOrLoadFace(FT_Face& face) const;
     FT_Face GetOrLoadFace() const;
@@ -303,17 +309,20 @@ public:
 
 protected:
     virtual const PdfCIDToGIDMapConstPtr& getCIDToGIDMap() const;
+    /** Get the encoding stored in the Type1 font program, or nullptr
+     */
+    virtual PdfEncodingMapConstPtr getImplicitType1Encoding() const;
     virtual bool getIsBoldHint() const = 0;
     virtual bool getIsItalicHint() const = 0;
     virtual const datahandle& GetFontFileDataHandle() const = 0;
     virtual const FreeTypeFacePtr& GetFaceHandle() const = 0;
 
+    static PdfEncodingMapConstPtr getFontType1Encoding(FT_Face face);
+
 private:
     PdfFontMetrics(const PdfFontMetrics& rhs) = delete;
     PdfFontMetrics& operator=(const PdfFontMetrics& rhs) = delete;
 
-    static PdfEncodingMapConstPtr getFontType1Encoding(FT_Face face);
-
 private:
     nullable<PdfFontStyle> m_Style;
 };
@@ -329,9 +338,11 @@ protected:
     virtual datahandle getFontFileDataHandle() const = 0;
 
 private:
-    bool m_dataInit;
+    // Data and face are loaded lazily by const methods,
+    // which may be called by concurrent readers
+    std::once_flag m_dataInit;
     datahandle m_Data;
-    bool m_faceInit;
+    std::once_flag m_faceInit;
     FreeTypeFacePtr m_Face;
 };
 
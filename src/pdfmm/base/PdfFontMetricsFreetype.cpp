@@ -22,6 +22,9 @@
 using namespace std;
 using namespace mm;
 
+// Value of the glyph widths not read yet
+constexpr double UNCACHED_WIDTH = -2;
+
 static PdfFontFileType determineTrueTypeFormat(FT_Face face);
 static int determineType1FontWeight(const string_view& weight);
 
@@ -38,6 +41,11 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype(const datahandle& data, const Fre
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The buffer can't be null");
 
     initFromFace(refMetrics);
+
+    unsigned glyphCount = GetGlyphCount();
+    m_glyphWidths.reset(new atomic<double>[glyphCount]);
+    for (unsigned i = 0; i < glyphCount; i++)
+        m_glyphWidths[i].store(UNCACHED_WIDTH, memory_order_relaxed);
 }
 
 PdfFontMetricsFreetype::PdfFontMetricsFreetype(const datahandle& data, const FreeTypeFacePtr& face)
@@ -47,8 +55,11 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype(const datahandle& data, const Fre
 
 unique_ptr<PdfFontMetricsFreetype> PdfFontMetricsFreetype::FromMetrics(const PdfFontMetrics& metrics)
 {
-    return unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(metrics.GetFontFileDataHandle(),
-        metrics.GetFaceHandle(), &metrics));
+    // NOTE: Don't share the face of the source metrics,
+    // as they may be used concurrently by other documents
+    auto& data = metrics.GetFontFileDataHandle();
+    FreeTypeFacePtr face = mm::CreateFreeTypeFace(data.view());
+    return unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(data, face, &metrics));
 }
 
 unique_ptr<PdfFontMetricsFreetype> PdfFontMetricsFreetype::FromBuffer(const charbuff::const_ptr& buffer)
@@ -226,6 +237,7 @@ void PdfFontMetricsFreetype::initFromFace(const PdfFontMetrics* refMetrics)
 
 void PdfFontMetricsFreetype::ensureLengthsReady()
 {
+    lock_guard<mutex> lock(m_FaceMutex);
     if (m_LengthsReady)
         return;
 
@@ -343,15 +355,37 @@ unsigned PdfFontMetricsFreetype::GetGlyphCount() const
 
 bool PdfFontMetricsFreetype::TryGetGlyphWidth(unsigned gid, double& width) const
 {
-    if (FT_Load_Glyph(m_Face.get(), gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
+    if (gid >= GetGlyphCount())
     {
         width = -1;
         return false;
     }
 
-    // zero return code is success!
-    width = m_Face.get()->glyph->metrics.horiAdvance / (double)m_Face.get()->units_per_EM;
-    return true;
+    width = m_glyphWidths[gid].load(memory_order_relaxed);
+    if (width == UNCACHED_WIDTH)
+    {
+        lock_guard<mutex> lock(m_FaceMutex);
+        // zero return code is success!
+        if (FT_Load_Glyph(m_Face.get(), gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) == 0)
+            width = m_Face.get()->glyph->metrics.horiAdvance / (double)m_Face.get()->units_per_EM;
+        else
+            width = -1;
+
+        m_glyphWidths[gid].store(width, memory_order_relaxed);
+    }
+
+    return width != -1;
+}
+
+PdfEncodingMapConstPtr PdfFontMetricsFreetype::getImplicitType1Encoding() const
+{
+    // The encoding is read by switching the charmaps
+    // of the face, so compute it once with the face locked
+    lock_guard<mutex> lock(m_FaceMutex);
+    if (m_Type1Encoding == nullptr)
+        m_Type1Encoding = getFontType1Encoding(m_Face.get());
+
+    return m_Type1Encoding;
 }
 
 bool PdfFontMetricsFreetype::HasUnicodeMapping() const
@@ -364,9 +398,38 @@ bool PdfFontMetricsFreetype::TryGetGID(char32_t codePoint, unsigned& gid) const
     if (m_HasSymbolCharset)
         codePoint = codePoint | 0xF000;
 
-    // NOTE: FT_Get_Char_Index returns 0 when no map is selected
-    gid = FT_Get_Char_Index(m_Face.get(), codePoint);
-    return gid != 0;
+    std::call_once(m_charMapFlag, &PdfFontMetricsFreetype::initCharMap, this);
+    auto found = std::lower_bound(m_charMap.begin(), m_charMap.end(), codePoint,
+        [](const pair<char32_t, unsigned>& mapping, char32_t codePoint) {
+            return mapping.first < codePoint;
+        });
+    if (found == m_charMap.end() || found->first != codePoint)
+    {
+        gid = 0;
+        return false;
+    }
+
+    gid = found->second;
+    return true;
+}
+
+void PdfFontMetricsFreetype::initCharMap() const
+{
+    // Read once all the mappings of the selected charmap, the
+    // same used by FT_Get_Char_Index. No mappings are read
+    // if no charmap is selected
+    FT_UInt gid;
+    lock_guard<mutex> lock(m_FaceMutex);
+    FT_ULong charcode = FT_Get_First_Char(m_Face.get(), &gid);
+    while (gid != 0)
+    {
+        m_charMap.push_back({ (char32_t)charcode, gid });
+        charcode = FT_Get_Next_Char(m_Face.get(), charcode, &gid);
+    }
+
+    // NOTE: Charcodes are usually returned in increasing order
+    if (!std::is_sorted(m_charMap.begin(), m_charMap.end()))
+        std::sort(m_charMap.begin(), m_charMap.end());
 }
 
 
@@ -376,6 +439,7 @@ unique_ptr<PdfCMapEncoding> PdfFontMetricsFreetype::CreateToUnicodeMap(const Pdf
     FT_ULong charcode;
     FT_UInt gid;
 
+    lock_guard<mutex> lock(m_FaceMutex);
     charcode = FT_Get_First_Char(m_Face.get(), &gid);
     while (gid != 0)
     {
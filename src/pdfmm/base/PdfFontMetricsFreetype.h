@@ -9,6 +9,9 @@
 
 #include "PdfDeclarations.h"
 
+#include <atomic>
+#include <mutex>
+
 #include "PdfFontMetrics.h"
 #include "PdfString.h"
 
@@ -108,6 +111,8 @@ protected:
 
     const PdfCIDToGIDMapConstPtr& getCIDToGIDMap() const override;
 
+    PdfEncodingMapConstPtr getImplicitType1Encoding() const override;
+
 private:
     PdfFontMetricsFreetype(const datahandle& data, const FreeTypeFacePtr& face, const PdfFontMetrics* refMetrics);
 
@@ -120,6 +125,8 @@ private:
 
     void ensureLengthsReady();
 
+    void initCharMap() const;
+
     void initType1Lengths(const bufferview& view);
 
 private:
@@ -155,6 +162,15 @@ private:
     double m_StrikeOutThickness;
     double m_StrikeOutPosition;
 
+    // Metrics may be shared among documents used by different
+    // threads: serialize the access to the FreeType face
+    mutable std::mutex m_FaceMutex;
+    // Widths and GIDs are cached, so the face is locked
+    // only when they are requested for the first time
+    std::unique_ptr<std::atomic<double>[]> m_glyphWidths;
+    mutable std::once_flag m_charMapFlag;
+    mutable std::vector<std::pair<char32_t, unsigned>> m_charMap;   // Sorted by code point
+    mutable PdfEncodingMapConstPtr m_Type1Encoding;
     bool m_LengthsReady;
     unsigned m_Length1;
     unsigned m_Length2;
@@ -7,21 +7,30 @@
 #include "PdfImmediateWriter.h"
 
 #include "PdfStreamedObjectStream.h"
+#include "PdfArray.h"
+#include "PdfDictionary.h"
 #include "PdfMemoryObjectStream.h"
 #include "PdfObject.h"
 #include "PdfXRef.h"
 #include "PdfXRefStream.h"
 
+#include <pdfmm/private/PdfSpillStream.h>
+
 using namespace std;
 using namespace mm;
 
+// Maximum size of the data of a spilled stream that is kept in
+// memory before moving it to a temporary file
+constexpr size_t SPILL_THRESHOLD = 1048576;
+
+static void releaseObject(PdfObject& obj);
+
 PdfImmediateWriter::PdfImmediateWriter(PdfIndirectObjectList& objects, const PdfObject& trailer,
         OutputStreamDevice& device, PdfVersion version, PdfEncrypt* encrypt, PdfSaveOptions opts) :
     PdfWriter(objects, trailer),
     m_attached(true),
     m_Device(&device),
-    m_Last(nullptr),
-    m_OpenStream(false)
+    m_openObject(nullptr)
 {
     // register as observer for PdfIndirectObjectList
     GetObjects().Attach(*this);
@@ -35,11 +44,14 @@ PdfImmediateWriter::PdfImmediateWriter(PdfIndirectObjectList& objects, const Pdf
     // setup encryption
     if (encrypt != nullptr)
     {
+        // NOTE: The key must be generated on the
+        // copy, which is the one used for writing
         this->SetEncrypt(*encrypt);
-        encrypt->GenerateEncryptionKey(GetIdentifier());
+        GetEncrypt()->GenerateEncryptionKey(GetIdentifier());
     }
 
-    // start with writing the header
+    // start with writing the header. Save options
+    // may enable the XRef stream, raising the version
     this->SetPdfVersion(version);
     this->SetSaveOptions(opts);
     this->WritePdfHeader(*m_Device);
@@ -50,7 +62,10 @@ PdfImmediateWriter::PdfImmediateWriter(PdfIndirectObjectList& objects, const Pdf
 PdfImmediateWriter::~PdfImmediateWriter()
 {
     if (m_attached)
+    {
         GetObjects().Detach(*this);
+        GetObjects().SetStreamFactory(nullptr);
+    }
 }
 
 PdfWriteFlags PdfImmediateWriter::GetWriteFlags() const
@@ -63,28 +78,64 @@ PdfVersion PdfImmediateWriter::GetPdfVersion() const
     return PdfWriter::GetPdfVersion();
 }
 
-void PdfImmediateWriter::WriteObject(const PdfObject& obj)
+void PdfImmediateWriter::FlushObject(PdfObject& obj)
 {
-    const int endObjLenght = 7;
+    if (!m_attached)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The document is already finished");
 
-    this->FinishLastObject();
+    if (m_flushedObjects.find(&obj) != m_flushedObjects.end())
+        return;
 
-    m_xRef->AddInUseObject(obj.GetIndirectReference(), m_Device->GetPosition());
-    obj.Write(*m_Device, this->GetWriteFlags(), GetEncrypt(), m_buffer);
+    if (GetObjects().GetObject(obj.GetIndirectReference()) != &obj)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The object doesn't belong to the document or it's already written");
 
-    // Let's cheat a bit:
-    // obj has written an "endobj\n" as last data to the file.
-    // we simply overwrite this string with "stream\n" which 
-    // has excatly the same length.
-    m_Device->Seek(m_Device->GetPosition() - endObjLenght);
-    m_Device->Write("stream\n");
-    m_Last = const_cast<PdfObject*>(&obj);
+    if (obj.HasStream())
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Objects with a stream are written when their stream is closed");
+
+    m_flushedObjects.insert(&obj);
+    if (m_openObject == nullptr)
+    {
+        writeFlushedObject(obj);
+    }
+    else
+    {
+        // The device is busy with a stream, write
+        // the object when the device is available
+        m_pendingObjects.push_back(&obj);
+    }
+}
+
+void PdfImmediateWriter::WriteObject(const PdfObject& obj)
+{
+    auto& stream = static_cast<PdfStreamedObjectStream&>(
+        const_cast<PdfObject&>(obj).MustGetStream().GetProvider());
+    if (m_openObject == nullptr)
+    {
+        // The device is free, the data of the stream
+        // will be written right after the object
+        writeObjectBegin(obj);
+        m_openObject = const_cast<PdfObject*>(&obj);
+    }
+    else
+    {
+        // Another stream is being written to the device: hold the
+        // data and write the object when the device is available
+        stream.m_Spill.reset(new PdfSpillStream(SPILL_THRESHOLD));
+    }
 }
 
 void PdfImmediateWriter::Finish()
 {
-    // write all objects which are still in RAM
-    this->FinishLastObject();
+    writeUnopenedStreams();
+
+    // Streams created from now on, such as the
+    // XRef stream, are just kept in memory
+    GetObjects().SetStreamFactory(nullptr);
+
+    // Remove the flushed objects, so they are not written again
+    for (auto obj : m_flushedObjects)
+        m_writtenObjects.push_back(GetObjects().RemoveObject(obj->GetIndirectReference(), false));
+    m_flushedObjects.clear();
 
     // setup encrypt dictionary
     if (GetEncrypt() != nullptr)
@@ -94,29 +145,11 @@ void PdfImmediateWriter::Finish()
         GetEncrypt()->CreateEncryptionDictionary(GetEncryptObj()->GetDictionary());
     }
 
+    // write all objects which are still in RAM
     this->WritePdfObjects(*m_Device, GetObjects(), *m_xRef);
 
-    // write the XRef
-    uint64_t lXRefOffset = static_cast<uint64_t>(m_Device->GetPosition());
+    // write the XRef, followed by the trailer
     m_xRef->Write(*m_Device, m_buffer);
-
-    // FIX-ME: The following is already done by PdfXRef now
-    PDFMM_RAISE_ERROR(PdfErrorCode::NotImplemented);
-
-    // XRef streams contain the trailer in the XRef
-    if (!GetUseXRefStream())
-    {
-        PdfObject trailer;
-
-        // if we have a dummy offset we write also a prev entry to the trailer
-        FillTrailerObject(trailer, m_xRef->GetSize(), false);
-
-        m_Device->Write("trailer\n");
-        trailer.Write(*m_Device, this->GetWriteFlags(), nullptr, m_buffer);
-    }
-
-    utls::FormatTo(m_buffer, "startxref\n{}\n%%EOF\n", lXRefOffset);
-    m_Device->Write(m_buffer);
     m_Device->Flush();
 
     // we are done now
@@ -126,45 +159,142 @@ void PdfImmediateWriter::Finish()
 
 unique_ptr<PdfObjectStreamProvider> PdfImmediateWriter::CreateStream()
 {
-    return unique_ptr<PdfObjectStreamProvider>(m_OpenStream ?
-        static_cast<PdfObjectStreamProvider*>(new PdfMemoryObjectStream()) :
-        static_cast<PdfObjectStreamProvider*>(new PdfStreamedObjectStream(*m_Device)));
+    return unique_ptr<PdfObjectStreamProvider>(new PdfStreamedObjectStream(*m_Device));
 }
 
-void PdfImmediateWriter::FinishLastObject()
+void PdfImmediateWriter::BeginAppendStream(PdfObjectStream& stream)
 {
-    if (m_Last == nullptr)
+    auto streamedObjectStream = dynamic_cast<PdfStreamedObjectStream*>(&stream.GetProvider());
+    if (streamedObjectStream != nullptr)
+    {
+        auto encrypt = GetEncrypt();
+        if (encrypt != nullptr)
+            streamedObjectStream->SetEncrypted(*encrypt);
+    }
+}
+
+void PdfImmediateWriter::EndAppendStream(PdfObjectStream& stream)
+{
+    auto streamedObjectStream = dynamic_cast<PdfStreamedObjectStream*>(&stream.GetProvider());
+    if (streamedObjectStream == nullptr)
         return;
 
+    auto& obj = stream.GetParent();
+    if (&obj == m_openObject)
+    {
+        writeObjectEnd(obj, *streamedObjectStream);
+        m_openObject = nullptr;
+    }
+    else
+    {
+        m_pendingObjects.push_back(&obj);
+    }
+
+    if (m_openObject == nullptr)
+        writePendingObjects();
+}
+
+void PdfImmediateWriter::writeObjectBegin(const PdfObject& obj)
+{
+    const int endObjLenght = 7;
+
+    m_xRef->AddInUseObject(obj.GetIndirectReference(), m_Device->GetPosition());
+
+    // The stream data is written as is, after the object
+    obj.Write(*m_Device, this->GetWriteFlags() | PdfWriteFlags::NoFlateCompress, GetEncrypt(), m_buffer);
+
+    // Let's cheat a bit:
+    // obj has written an "endobj\n" as last data to the file.
+    // we simply overwrite this string with "stream\n" which 
+    // has excatly the same length.
+    m_Device->Seek(m_Device->GetPosition() - endObjLenght);
+    m_Device->Write("stream\n");
+}
+
+void PdfImmediateWriter::writeObjectEnd(PdfObject& obj, PdfStreamedObjectStream& stream)
+{
     m_Device->Write("\nendstream\n");
     m_Device->Write("endobj\n");
 
-    GetObjects().RemoveObject(m_Last->GetIndirectReference(), false);
-    m_Last = nullptr;
+    // The length is known now, so its object can be written
+    // and deleted. Nothing else should refer to it
+    auto& lengthObj = *stream.m_LengthObj;
+    m_xRef->AddInUseObject(lengthObj.GetIndirectReference(), m_Device->GetPosition());
+    lengthObj.Write(*m_Device, this->GetWriteFlags(), GetEncrypt(), m_buffer);
+    stream.m_LengthObj = nullptr;
+    GetObjects().RemoveObject(lengthObj.GetIndirectReference(), false);
+
+    releaseObject(obj);
+    m_writtenObjects.push_back(GetObjects().RemoveObject(obj.GetIndirectReference(), false));
 }
 
-void PdfImmediateWriter::BeginAppendStream(PdfObjectStream& stream)
+void PdfImmediateWriter::writeFlushedObject(PdfObject& obj)
 {
-    auto streamedObjectStream = dynamic_cast<PdfStreamedObjectStream*>(&stream.GetProvider());
-    if (streamedObjectStream != nullptr)
+    m_xRef->AddInUseObject(obj.GetIndirectReference(), m_Device->GetPosition());
+    obj.Write(*m_Device, this->GetWriteFlags(), GetEncrypt(), m_buffer);
+    releaseObject(obj);
+}
+
+void PdfImmediateWriter::writePendingObjects()
+{
+    for (auto obj : m_pendingObjects)
     {
-        // Only one open file stream is allowed at a time
-        PDFMM_ASSERT(!m_OpenStream);
-        m_OpenStream = true;
+        if (m_flushedObjects.find(obj) != m_flushedObjects.end())
+        {
+            writeFlushedObject(*obj);
+            continue;
+        }
+
+        auto& stream = static_cast<PdfStreamedObjectStream&>(obj->MustGetStream().GetProvider());
+        writeObjectBegin(*obj);
+        stream.m_Spill->CopyTo(*m_Device);
+        stream.m_Spill = nullptr;
+        writeObjectEnd(*obj, stream);
+    }
 
-        auto encrypt = GetEncrypt();
-        if (encrypt != nullptr)
-            streamedObjectStream->SetEncrypted(*encrypt);
+    m_pendingObjects.clear();
+}
+
+void PdfImmediateWriter::writeUnopenedStreams()
+{
+    vector<PdfObject*> unopened;
+    for (auto obj : GetObjects())
+    {
+        auto stream = obj->GetStream();
+        if (stream == nullptr)
+            continue;
+
+        auto streamedObjectStream = dynamic_cast<const PdfStreamedObjectStream*>(&stream->GetProvider());
+        if (streamedObjectStream == nullptr)
+            continue;
+
+        if (streamedObjectStream->m_Written)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The stream of object {} is still open", obj->GetIndirectReference().ToString());
+
+        unopened.push_back(obj);
     }
+
+    // Write empty streams. The list is not iterated
+    // directly, since written objects are removed
+    for (auto obj : unopened)
+        (void)obj->GetOrCreateStream().GetOutputStreamRaw();
 }
 
-void PdfImmediateWriter::EndAppendStream(PdfObjectStream& stream)
+// Drop the content of a written object, keeping only the /Type,
+// which is needed to traverse the page tree
+void releaseObject(PdfObject& obj)
 {
-    auto fileStream = dynamic_cast<const PdfStreamedObjectStream*>(&stream);
-    if (fileStream != nullptr)
+    PdfDictionary* dict;
+    PdfArray* arr;
+    if (obj.TryGetDictionary(dict))
+    {
+        auto type = dict->FindKeyAs<PdfName>(PdfName::KeyType, PdfName());
+        dict->Clear();
+        if (!type.IsNull())
+            dict->AddKey(PdfName::KeyType, type);
+    }
+    else if (obj.TryGetArray(arr))
     {
-        // A PdfFileStream has to be opened before
-        PDFMM_ASSERT(m_OpenStream);
-        m_OpenStream = false;
+        arr->Clear();
     }
 }
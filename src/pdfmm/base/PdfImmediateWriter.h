@@ -15,9 +15,23 @@ namespace mm {
 class PdfEncrypt;
 class OutputStreamDevice;
 class PdfXRef;
+class PdfStreamedObjectStream;
 
 /** A kind of PdfWriter that writes objects with streams immediately to
  *  an OutputStreamDevice
+ *
+ *  The data of the streams is written to the device as soon as it's
+ *  produced. Streams opened while the device is busy with another stream
+ *  are spilled to temporary storage and written when the device is free.
+ *  After an object with a stream is written it's removed from the object
+ *  list and further changes to it are not written. Objects without a
+ *  stream are written when finishing the document, unless they are
+ *  flushed earlier with FlushObject()
+ *
+ *  Written objects are released: only an empty placeholder, keeping the
+ *  /Type of the object, stays in memory. Handles to the written objects
+ *  themselves stay valid, but handles to values inside them, such as a
+ *  direct /Resources dictionary, are destroyed with their content
  */
 class PDFMM_API PdfImmediateWriter : private PdfWriter,
     private PdfIndirectObjectList::Observer,
@@ -61,6 +75,13 @@ public:
      */
     PdfVersion GetPdfVersion() const;
 
+    /** Write an object without a stream immediately, or as soon as the
+     *  device is available, then release it. Further changes to the
+     *  object are not written. Objects already flushed are skipped
+     *  \param obj an object of the document without a stream
+     */
+    void FlushObject(PdfObject& obj);
+
 private:
     void WriteObject(const PdfObject& obj) override;
     void Finish() override;
@@ -68,20 +89,43 @@ private:
     void EndAppendStream(PdfObjectStream& stream) override;
     std::unique_ptr<PdfObjectStreamProvider> CreateStream() override;
 
-    /** Assume the stream for the last object has
-     *  been written complete.
-     *  Therefore close the stream of the object
-     *  now so that the next object can be written
-     *  to disk
+    /** Write the object up to the "stream" keyword, so the
+     *  stream data can follow
+     */
+    void writeObjectBegin(const PdfObject& obj);
+
+    /** Terminate the object after the stream data and write its
+     *  length, then remove the object from the list
+     */
+    void writeObjectEnd(PdfObject& obj, PdfStreamedObjectStream& stream);
+
+    /** Write an object without a stream and release it
+     */
+    void writeFlushedObject(PdfObject& obj);
+
+    /** Write the completed streams that have been spilled
+     *  and the objects flushed while the device was busy
+     */
+    void writePendingObjects();
+
+    /** Write the streams that have been created but never
+     *  opened, ensuring no stream is still open
      */
-    void FinishLastObject();
+    void writeUnopenedStreams();
 
 private:
     bool m_attached;
     OutputStreamDevice* m_Device;
     std::unique_ptr<PdfXRef> m_xRef;
-    PdfObject* m_Last;
-    bool m_OpenStream;
+    PdfObject* m_openObject;                    // The object whose stream is being written to the device
+    std::vector<PdfObject*> m_pendingObjects;   // Objects with completed spilled streams or flushed ones
+    // Flushed objects without a stream. They stay in the list,
+    // so the page tree can still be traversed, and they are
+    // removed when finishing the document
+    std::unordered_set<PdfObject*> m_flushedObjects;
+    // Written objects removed from the list. Handles to them may
+    // still be held, so they are kept alive as placeholders
+    std::vector<std::unique_ptr<PdfObject>> m_writtenObjects;
 };
 
 };
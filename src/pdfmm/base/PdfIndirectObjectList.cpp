@@ -9,12 +9,14 @@
 
 #include <algorithm>
 
+#include "PdfArena.h"
 #include "PdfArray.h"
 #include "PdfDictionary.h"
 #include "PdfMemoryObjectStream.h"
 #include "PdfObject.h"
 #include "PdfReference.h"
 #include "PdfObjectStream.h"
+#include "PdfObjectStreamParser.h"
 #include "PdfDocument.h"
 
 using namespace std;
@@ -23,15 +25,6 @@ using namespace mm;
 static constexpr size_t MaxReserveSize = 8388607; // cf. Table C.1 in section C.2 of PDF32000_2008.pdf
 static constexpr unsigned MaxXRefGenerationNum = 65535;
 
-struct ObjectComparatorPredicate
-{
-public:
-    inline bool operator()(const PdfObject* obj1, const PdfObject* obj2) const
-    {
-        return obj1->GetIndirectReference() < obj2->GetIndirectReference();
-    }
-};
-
 struct ReferenceComparatorPredicate
 {
 public:
@@ -41,32 +34,11 @@ public:
     }
 };
 
-//RG: 1) Should this class not be moved to the header file
-class ObjectsComparator
-{
-public:
-    ObjectsComparator(const PdfReference& ref)
-        : m_ref(ref) { }
-
-    bool operator()(const PdfObject* p1) const
-    {
-        return p1 ? (p1->GetIndirectReference() == m_ref) : false;
-    }
-
-private:
-    ObjectsComparator() = delete;
-    ObjectsComparator(const ObjectsComparator& rhs) = delete;
-    ObjectsComparator& operator=(const ObjectsComparator& rhs) = delete;
-
-private:
-    const PdfReference m_ref;
-};
-
 PdfIndirectObjectList::PdfIndirectObjectList() :
     m_Document(nullptr),
     m_CanReuseObjectNumbers(true),
-    m_Objects(CompareObject),
     m_ObjectCount(0),
+    m_Size(0),
     m_StreamFactory(nullptr)
 {
 }
@@ -74,8 +46,8 @@ PdfIndirectObjectList::PdfIndirectObjectList() :
 PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document) :
     m_Document(&document),
     m_CanReuseObjectNumbers(true),
-    m_Objects(CompareObject),
     m_ObjectCount(1),
+    m_Size(0),
     m_StreamFactory(nullptr)
 {
 }
@@ -83,19 +55,20 @@ PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document) :
 PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document, const PdfIndirectObjectList& rhs)  :
     m_Document(&document),
     m_CanReuseObjectNumbers(rhs.m_CanReuseObjectNumbers),
-    m_Objects(CompareObject),
+    m_Objects(rhs.m_Objects.size()),
     m_ObjectCount(rhs.m_ObjectCount),
+    m_Size(rhs.m_Size),
     m_FreeObjects(rhs.m_FreeObjects),
     m_unavailableObjects(rhs.m_unavailableObjects),
     m_StreamFactory(nullptr)
 {
     // Copy all objects from source, resetting parent and indirect reference
-    for (auto obj : rhs.m_Objects)
+    for (auto obj : rhs)
     {
         auto newObj = new PdfObject(*obj);
         newObj->SetIndirectReference(obj->GetIndirectReference());
         newObj->SetDocument(&document);
-        m_Objects.insert(newObj);
+        m_Objects[obj->GetIndirectReference().ObjectNumber()] = newObj;
     }
 }
 
@@ -111,7 +84,26 @@ void PdfIndirectObjectList::Clear()
 
     m_Objects.clear();
     m_ObjectCount = 1;
+    m_Size = 0;
     m_StreamFactory = nullptr;
+
+    // Compressed objects removed from the list must
+    // not read anymore from the objects of the list
+    for (auto& parser : m_objectStreamParsers)
+    {
+        auto lockedParser = parser.lock();
+        if (lockedParser != nullptr)
+            lockedParser->detachObjects();
+    }
+    m_objectStreamParsers.clear();
+
+    // The objects allocated in the arena have been deleted
+    m_arena = nullptr;
+}
+
+void PdfIndirectObjectList::CreateArena()
+{
+    m_arena.reset(new PdfArena());
 }
 
 PdfObject& PdfIndirectObjectList::MustGetObject(const PdfReference& ref) const
@@ -125,11 +117,16 @@ PdfObject& PdfIndirectObjectList::MustGetObject(const PdfReference& ref) const
 
 PdfObject* PdfIndirectObjectList::GetObject(const PdfReference& ref) const
 {
-    auto it = std::lower_bound(m_Objects.begin(), m_Objects.end(), ref, CompareReference);
-    if (it == m_Objects.end() || (*it)->GetIndirectReference() != ref)
+    uint32_t objectNum = ref.ObjectNumber();
+    if (objectNum >= m_Objects.size())
+        return nullptr;
+
+    // Check the generation number of the object in the slot
+    auto obj = m_Objects[objectNum];
+    if (obj == nullptr || obj->GetIndirectReference().GenerationNumber() != ref.GenerationNumber())
         return nullptr;
 
-    return *it;
+    return obj;
 }
 
 unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const PdfReference& ref)
@@ -139,16 +136,15 @@ unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const PdfReference& re
 
 unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const PdfReference& ref, bool markAsFree)
 {
-    auto it = std::lower_bound(m_Objects.begin(), m_Objects.end(), ref, CompareReference);
-    if (it == m_Objects.end() || (*it)->GetIndirectReference() != ref)
+    if (GetObject(ref) == nullptr)
         return nullptr;
 
-    return removeObject(it, markAsFree);
+    return removeObject(m_Objects[ref.ObjectNumber()], markAsFree);
 }
 
 unique_ptr<PdfObject> PdfIndirectObjectList::RemoveObject(const iterator& it)
 {
-    return removeObject(it, true);
+    return removeObject(m_Objects[(*it)->GetIndirectReference().ObjectNumber()], true);
 }
 
 unique_ptr<PdfObject> PdfIndirectObjectList::ReplaceObject(const PdfReference& ref, PdfObject* obj)
@@ -156,28 +152,28 @@ unique_ptr<PdfObject> PdfIndirectObjectList::ReplaceObject(const PdfReference& r
     if (obj == nullptr)
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Object must be non null");
 
-    auto it = std::lower_bound(m_Objects.begin(), m_Objects.end(), ref, CompareReference);
-    if (it == m_Objects.end())
+    if (GetObject(ref) == nullptr)
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Unable to find object with reference {}", ref.ToString());
 
-    auto node = m_Objects.extract(it);
-    unique_ptr<PdfObject> ret(node.value());
-    node.value() = obj;
+    auto& slot = m_Objects[ref.ObjectNumber()];
+    unique_ptr<PdfObject> ret(slot);
+    slot = obj;
     obj->SetIndirectReference(ref);
-    pushObject(node, obj);
+    obj->SetDocument(m_Document);
     return ret;
 }
 
-unique_ptr<PdfObject> PdfIndirectObjectList::removeObject(const iterator& it, bool markAsFree)
+unique_ptr<PdfObject> PdfIndirectObjectList::removeObject(PdfObject*& slot, bool markAsFree)
 {
-    auto obj = *it;
+    auto obj = slot;
     if (m_objectStreams.find(obj->GetIndirectReference().ObjectNumber()) != m_objectStreams.end())
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Can't remove a compressed object stream");
 
     if (markAsFree)
         SafeAddFreeObject(obj->GetIndirectReference());
 
-    m_Objects.erase(it);
+    slot = nullptr;
+    m_Size--;
     return unique_ptr<PdfObject>(obj);
 }
 
@@ -192,7 +188,7 @@ PdfReference PdfIndirectObjectList::getNextFreeObject()
     }
 
     // If no free objects are available, create a new object with generation 0
-    uint16_t nextObjectNum = static_cast<uint16_t>(m_ObjectCount);
+    uint32_t nextObjectNum = m_ObjectCount;
     while (true)
     {
         if ((size_t)(nextObjectNum + 1) == MaxReserveSize)
@@ -274,7 +270,7 @@ int32_t PdfIndirectObjectList::tryAddFreeObject(uint32_t objnum, uint32_t gennum
     // NOTE: gennum is uint32 to accomodate overflows from callers
     if (gennum >= MaxXRefGenerationNum)
     {
-        m_unavailableObjects.insert(gennum);
+        m_unavailableObjects.insert(objnum);
         return -1;
     }
 
@@ -306,6 +302,11 @@ void PdfIndirectObjectList::AddObjectStream(uint32_t objectNum)
     m_objectStreams.insert(objectNum);
 }
 
+void PdfIndirectObjectList::AddObjectStreamParser(const shared_ptr<PdfObjectStreamParser>& parser)
+{
+    m_objectStreamParsers.push_back(parser);
+}
+
 void PdfIndirectObjectList::addNewObject(PdfObject* obj)
 {
     PdfReference ref = getNextFreeObject();
@@ -317,27 +318,33 @@ void PdfIndirectObjectList::PushObject(PdfObject* obj)
 {
     obj->SetDocument(m_Document);
 
-    ObjectList::node_type node;
-    auto it = m_Objects.find(obj);
-    if (it != m_Objects.end())
+    auto& slot = getSlot(obj->GetIndirectReference().ObjectNumber());
+    if (slot == nullptr)
     {
-        // Delete existing object and replace
-        // the pointer on its node
-        node = m_Objects.extract(it);
-        delete node.value();
-        node.value() = obj;
+        m_Size++;
+    }
+    else
+    {
+        // Delete the existing object with the
+        // same object number and replace it
+        delete slot;
     }
 
-    pushObject(node, obj);
+    slot = obj;
+    TryIncrementObjectCount(obj->GetIndirectReference());
 }
 
-void PdfIndirectObjectList::pushObject(ObjectList::node_type& node, PdfObject* obj)
+void PdfIndirectObjectList::Reserve(unsigned objectCount)
 {
-    if (node.empty())
-        m_Objects.insert(obj);
-    else
-        m_Objects.insert(std::move(node));
-    TryIncrementObjectCount(obj->GetIndirectReference());
+    m_Objects.reserve(objectCount);
+}
+
+PdfObject*& PdfIndirectObjectList::getSlot(uint32_t objectNum)
+{
+    if (objectNum >= m_Objects.size())
+        m_Objects.resize((size_t)objectNum + 1);
+
+    return m_Objects[objectNum];
 }
 
 void PdfIndirectObjectList::CollectGarbage()
@@ -347,26 +354,21 @@ void PdfIndirectObjectList::CollectGarbage()
 
     unordered_set<PdfReference> referencedOjects;
     visitObject(m_Document->GetTrailer().GetObject(), referencedOjects);
-    vector<PdfObject*> objectsToDelete;
-    ObjectList newlist(CompareObject);
-    for (PdfObject* obj : m_Objects)
+    for (auto& slot : m_Objects)
     {
-        auto& ref = obj->GetIndirectReference();
+        if (slot == nullptr)
+            continue;
+
+        auto& ref = slot->GetIndirectReference();
         if (referencedOjects.find(ref) == referencedOjects.end()
             && m_objectStreams.find(ref.ObjectNumber()) == m_objectStreams.end())
         {
             SafeAddFreeObject(ref);
-            objectsToDelete.push_back(obj);
-            continue;
+            delete slot;
+            slot = nullptr;
+            m_Size--;
         }
-
-        newlist.insert(obj);
     }
-
-    for (auto obj : objectsToDelete)
-        delete obj;
-
-    m_Objects.swap(newlist);
 }
 
 void PdfIndirectObjectList::visitObject(const PdfObject& obj, unordered_set<PdfReference>& referencedObjects)
@@ -484,7 +486,7 @@ void PdfIndirectObjectList::SetCanReuseObjectNumbers(bool canReuseObjectNumbers)
 
 unsigned PdfIndirectObjectList::GetSize() const
 {
-    return (unsigned)m_Objects.size();
+    return m_Size;
 }
 
 void PdfIndirectObjectList::Attach(Observer& observer)
@@ -510,35 +512,27 @@ void PdfIndirectObjectList::TryIncrementObjectCount(const PdfReference& ref)
 
 PdfIndirectObjectList::iterator PdfIndirectObjectList::begin() const
 {
-    return m_Objects.begin();
+    auto data = m_Objects.data();
+    return iterator(data, data + m_Objects.size());
 }
 
 PdfIndirectObjectList::iterator PdfIndirectObjectList::end() const
 {
-    return m_Objects.end();
+    auto end = m_Objects.data() + m_Objects.size();
+    return iterator(end, end);
 }
 
 PdfIndirectObjectList::reverse_iterator PdfIndirectObjectList::rbegin() const
 {
-    return m_Objects.rbegin();
+    return reverse_iterator(end());
 }
 
 PdfIndirectObjectList::reverse_iterator PdfIndirectObjectList::rend() const
 {
-    return m_Objects.rend();
+    return reverse_iterator(begin());
 }
 
 size_t PdfIndirectObjectList::size() const
 {
-    return m_Objects.size();
-}
-
-bool PdfIndirectObjectList::CompareObject(const PdfObject* p1, const PdfObject* p2)
-{
-    return *p1 < *p2;
-}
-
-bool PdfIndirectObjectList::CompareReference(const PdfObject* obj, const PdfReference& ref)
-{
-    return obj->GetIndirectReference() < ref;
+    return m_Size;
 }
@@ -7,6 +7,7 @@
 #ifndef PDF_INDIRECT_OBJECT_LIST_H
 #define PDF_INDIRECT_OBJECT_LIST_H
 
+#include <iterator>
 #include <list>
 #include <unordered_set>
 
@@ -15,6 +16,8 @@
 namespace mm {
 
 class PdfObjectStreamProvider;
+class PdfObjectStreamParser;
+class PdfArena;
 using ReferenceList = std::deque<PdfReference>;
 
 /** A list of PdfObjects that constitutes the indirect object list
@@ -33,23 +36,88 @@ class PDFMM_API PdfIndirectObjectList final
 {
     friend class PdfWriter;
     friend class PdfDocument;
+    friend class PdfMemDocument;
+    friend class PdfObject;
     friend class PdfParser;
     friend class PdfObjectStreamParser;
     friend class PdfImmediateWriter;
 
 private:
-    static bool CompareObject(const PdfObject* p1, const PdfObject* p2);
-    static bool CompareReference(const PdfObject* obj, const PdfReference& ref);
-
-private:
-    using ObjectList = std::set<PdfObject*, decltype(CompareObject)*>;
+    // Objects are stored in slots indexed by object number,
+    // empty slots are nullptr
+    using ObjectList = std::vector<PdfObject*>;
 
 public:
-    // An incomplete set of container typedefs, just enough to handle
-    // the begin() and end() methods we wrap from the internal vector.
-    // TODO: proper wrapper iterator class.
-    using iterator = ObjectList::const_iterator;
-    using reverse_iterator = ObjectList::const_reverse_iterator;
+    /** Bidirectional iterator on the objects of the list, in
+     * object number order. Empty slots are skipped
+     */
+    class iterator final
+    {
+        friend class PdfIndirectObjectList;
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = PdfObject*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = PdfObject* const*;
+        using reference = PdfObject* const&;
+
+    public:
+        iterator() : m_current(nullptr), m_end(nullptr) { }
+
+    private:
+        iterator(pointer current, pointer end)
+            : m_current(current), m_end(end)
+        {
+            skipEmpty();
+        }
+
+    public:
+        reference operator*() const { return *m_current; }
+        pointer operator->() const { return m_current; }
+        iterator& operator++()
+        {
+            m_current++;
+            skipEmpty();
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            auto ret = *this;
+            ++(*this);
+            return ret;
+        }
+        iterator& operator--()
+        {
+            // NOTE: Decrementing begin() is undefined
+            // behavior, as for standard containers
+            do
+            {
+                m_current--;
+            } while (*m_current == nullptr);
+            return *this;
+        }
+        iterator operator--(int)
+        {
+            auto ret = *this;
+            --(*this);
+            return ret;
+        }
+        bool operator==(const iterator& rhs) const { return m_current == rhs.m_current; }
+        bool operator!=(const iterator& rhs) const { return m_current != rhs.m_current; }
+
+    private:
+        void skipEmpty()
+        {
+            while (m_current != m_end && *m_current == nullptr)
+                m_current++;
+        }
+
+    private:
+        pointer m_current;
+        pointer m_end;
+    };
+
+    using reverse_iterator = std::reverse_iterator<iterator>;
 
     /** Every observer of PdfIndirectObjectList has to implement this interface.
      */
@@ -107,6 +175,8 @@ public:
     /** Removes all objects from the vector
      *  and resets it to the default state.
      *
+     *  The arena of the list, if any, is freed.
+     *
      *  If SetAutoDelete is true all objects are deleted.
      *  All observers are removed from the vector.
      *
@@ -116,7 +186,7 @@ public:
     void Clear();
 
     /**
-     *  \returns the size of the internal vector
+     *  \returns the number of objects in the list
      */
     unsigned GetSize() const;
 
@@ -269,6 +339,11 @@ private:
      */
     void PushObject(PdfObject* obj);
 
+    /** Reserve room for objects numbered up to the given count,
+     * to avoid reallocations when the object count is known in advance
+     */
+    void Reserve(unsigned objectCount);
+
     /** Mark a reference as unused so that it can be reused for new objects.
      *
      *  Add the object only if the generation is the allowed range
@@ -305,6 +380,13 @@ private:
      */
     void AddObjectStream(uint32_t objectNum);
 
+    /** Add a parser of the object streams of this list
+     * \remarks The parser is detached from the list when the list
+     * is cleared, as compressed objects that are removed from the
+     * list may keep it alive
+     */
+    void AddObjectStreamParser(const std::shared_ptr<PdfObjectStreamParser>& parser);
+
     std::unique_ptr<PdfObject> RemoveObject(const PdfReference& ref, bool markAsFree);
 
     /**
@@ -314,10 +396,21 @@ private:
      */
     void CollectGarbage();
 
+    /** Create an arena where the objects parsed or
+     * loaded lazily in this list will be allocated.
+     * The arena is released when the list is cleared
+     */
+    void CreateArena();
+
+    /** \returns the arena where the objects of the list
+     * are allocated, or nullptr if arena allocation is disabled
+     */
+    PdfArena* GetArena() const { return m_arena.get(); }
+
 private:
-    void pushObject(ObjectList::node_type& it, PdfObject* obj);
+    PdfObject*& getSlot(uint32_t objectNum);
 
-    std::unique_ptr<PdfObject> removeObject(const iterator& it, bool markAsFree);
+    std::unique_ptr<PdfObject> removeObject(PdfObject*& slot, bool markAsFree);
 
     void addNewObject(PdfObject* obj);
 
@@ -368,12 +461,15 @@ private:
     bool m_CanReuseObjectNumbers;
     ObjectList m_Objects;
     unsigned m_ObjectCount;
+    unsigned m_Size;
     ReferenceList m_FreeObjects;
     ObjectNumSet m_unavailableObjects;
     ObjectNumSet m_objectStreams;
+    std::vector<std::weak_ptr<PdfObjectStreamParser>> m_objectStreamParsers;
 
     ObserverList m_observers;
     StreamFactory* m_StreamFactory;
+    std::unique_ptr<PdfArena> m_arena;
 };
 
 };
@@ -31,12 +31,25 @@ public:
      */
     bool Peek(char& ch) const;
 
+    /** Get a view of the whole device content, if the device
+     * is backed by contiguous memory. The view is valid until
+     * the device content is modified
+     * /returns true if the device content is available as a
+     * contiguous buffer, false otherwise
+     */
+    bool TryGetBufferView(bufferview& view) const;
+
 protected:
     /** Peek at next char in stream.
      *  /returns true if success, false if EOF
      */
     virtual bool peek(char& ch) const = 0;
 
+    /** Get a view of the whole device content
+     * By default the device is not contiguous and returns false
+     */
+    virtual bool tryGetBufferView(bufferview& view) const;
+
     void checkRead() const override;
 };
 
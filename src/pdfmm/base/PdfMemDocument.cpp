@@ -42,6 +42,7 @@ PdfMemDocument::PdfMemDocument(bool empty) :
     m_Version(PdfVersionDefault),
     m_InitialVersion(PdfVersionDefault),
     m_HasXRefStream(false),
+    m_UseArenaAllocation(false),
     m_PrevXRefOffset(-1)
 {
 }
@@ -60,6 +61,7 @@ PdfMemDocument::PdfMemDocument(const PdfMemDocument& rhs) :
     m_Version(rhs.m_Version),
     m_InitialVersion(rhs.m_InitialVersion),
     m_HasXRefStream(rhs.m_HasXRefStream),
+    m_UseArenaAllocation(rhs.m_UseArenaAllocation),
     m_PrevXRefOffset(rhs.m_PrevXRefOffset)
 {
     auto encryptObj = GetTrailer().GetDictionary().FindKey("Encrypt");
@@ -115,7 +117,7 @@ void PdfMemDocument::Load(const string_view& filename, const string_view& passwo
     if (filename.length() == 0)
         PDFMM_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 
-    auto device = std::make_shared<FileStreamDevice>(filename);
+    auto device = std::make_shared<MappedFileStreamDevice>(filename);
     LoadFromDevice(device, password);
 }
 
@@ -140,6 +142,8 @@ void PdfMemDocument::LoadFromDevice(const shared_ptr<InputStreamDevice>& device,
 void PdfMemDocument::loadFromDevice(const shared_ptr<InputStreamDevice>& device, const string_view& password)
 {
     m_device = device;
+    if (m_UseArenaAllocation)
+        PdfDocument::GetObjects().CreateArena();
 
     // Call parse file instead of using the constructor
     // so that m_Parser is initialized for encrypted documents
@@ -149,6 +153,11 @@ void PdfMemDocument::loadFromDevice(const shared_ptr<InputStreamDevice>& device,
     initFromParser(parser);
 }
 
+void PdfMemDocument::SetUseArenaAllocation(bool useArena)
+{
+    m_UseArenaAllocation = useArena;
+}
+
 void PdfMemDocument::AddPdfExtension(const PdfName& ns, int64_t level)
 {
     if (!this->HasPdfExtension(ns, level))
@@ -276,12 +285,14 @@ void PdfMemDocument::SaveUpdate(OutputStreamDevice& device, PdfSaveOptions opts)
     if (m_Encrypt != nullptr)
         writer.SetEncrypt(*m_Encrypt);
 
-    if (m_InitialVersion < this->GetPdfVersion())
+    // NOTE: The writer may have raised the version, eg. to use a XRef stream
+    auto version = writer.GetPdfVersion();
+    if (m_InitialVersion < version)
     {
-        if (this->GetPdfVersion() < PdfVersion::V1_0 || this->GetPdfVersion() > PdfVersion::V1_7)
+        if (version < PdfVersion::V1_0 || version > PdfVersion::V1_7)
             PDFMM_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
 
-        GetCatalog().GetDictionary().AddKey("Version", PdfName(mm::GetPdfVersionName(GetPdfVersion())));
+        GetCatalog().GetDictionary().AddKey("Version", PdfName(mm::GetPdfVersionName(version)));
     }
 
     try
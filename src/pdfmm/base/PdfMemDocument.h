@@ -55,6 +55,9 @@ public:
      *  When the bForUpdate is set to true, the filename is copied
      *  for later use by WriteUpdate.
      *
+     *  The file is memory mapped and it must not be truncated
+     *  or overwritten while the document is loaded.
+     *
      *  \see WriteUpdate, LoadFromBuffer, LoadFromDevice
      */
     void Load(const std::string_view& filename, const std::string_view& password = { });
@@ -215,6 +218,28 @@ public:
 
     const PdfEncrypt* GetEncrypt() const override;
 
+    /** Enable allocation of the objects parsed from the loaded
+     *  documents in an arena owned by the document. Objects are
+     *  then released all at once when the document is cleared or
+     *  destroyed, making loading and disposing big documents
+     *  faster. It must be set before loading a document.
+     *  By default arena allocation is disabled.
+     *
+     *  Only the object and variant data instances are allocated
+     *  in the arena, not the storage of their contents
+     *  \remarks Parsed objects removed from the document, or variant
+     *  data moved out of them, must not outlive the document or its
+     *  next load. Copies of them are allocated on the global heap
+     *  \see PdfArena
+     *
+     *  \param useArena if true, parsed objects are allocated in an arena
+     */
+    void SetUseArenaAllocation(bool useArena);
+
+    /** \returns true if parsed objects are allocated in an arena
+     */
+    bool GetUseArenaAllocation() const { return m_UseArenaAllocation; }
+
 protected:
     /** Set the PDF Version of the document. Has to be called before Write() to
      *  have an effect.
@@ -250,6 +275,7 @@ private:
     PdfVersion m_Version;
     PdfVersion m_InitialVersion;
     bool m_HasXRefStream;
+    bool m_UseArenaAllocation;
     int64_t m_PrevXRefOffset;
     std::unique_ptr<PdfEncrypt> m_Encrypt;
     std::shared_ptr<InputStreamDevice> m_device;
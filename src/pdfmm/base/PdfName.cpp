@@ -9,6 +9,8 @@
 
 #include <pdfmm/private/PdfEncodingPrivate.h>
 
+#include <unordered_map>
+
 #include "PdfOutputDevice.h"
 #include "PdfTokenizer.h"
 #include "PdfPredefinedEncoding.h"
@@ -21,6 +23,86 @@ void hexchr(const unsigned char ch, T& it);
 
 static void EscapeNameTo(string& dst, const string_view& view);
 static string UnescapeName(const string_view& view);
+static unique_ptr<string> expandUtf8String(const string_view& raw);
+
+// The names that are interned. The set is fixed, so names
+// specific to single documents (eg. subset font names)
+// can't fill the pool in long running processes
+static const char* s_wellKnownNames[] = {
+    "Contents", "Flags", "Length", "Rect", "Size", "Subtype", "Type", "Filter",
+    "Parent", "Kids", "Count", "Page", "Pages", "Resources", "MediaBox", "CropBox",
+    "Font", "XObject", "ExtGState", "ColorSpace", "Pattern", "Shading", "ProcSet",
+    "Annots", "Root", "Info", "ID", "Encrypt", "Prev", "XRef", "ObjStm", "N", "First",
+    "Extends", "Index", "W", "DecodeParms", "FlateDecode", "Predictor", "Columns",
+    "BaseFont", "FirstChar", "LastChar", "Widths", "FontDescriptor", "Encoding",
+    "ToUnicode", "DescendantFonts", "Width", "Height", "BitsPerComponent",
+    "Image", "Form", "BBox", "Matrix", "Dest", "Border", "P", "A", "S", "D",
+    "Catalog", "Annot", "Link", "Widget", "Metadata", "Names", "Outlines",
+    "AcroForm", "Fields", "FT", "T", "V", "AP", "Rotate", "Group", "SMask",
+    "Decode", "Mask", "Title", "Next", "Last", "Producer", "Creator",
+    "CreationDate", "ModDate", "Type1", "TrueType", "Type0", "CIDFontType0",
+    "CIDFontType2", "FontFile", "FontFile2", "FontFile3", "DW", "Ascent",
+    "Descent", "CapHeight", "StemV", "ItalicAngle", "FontBBox", "FontName",
+    "DeviceRGB", "DeviceGray", "DeviceCMYK", "ICCBased", "Indexed", "DCTDecode",
+};
+
+// The pool of interned names. It's filled once when it's created
+// and it's immutable afterwards, so lookups need no locking
+struct PdfName::NamePool
+{
+    // The pool lookup key. The hash is computed once
+    // by the caller and reused for the lookup
+    struct Key
+    {
+        string_view Raw;
+        size_t Hash;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return key.Hash;
+        }
+    };
+
+    struct KeyEqual
+    {
+        bool operator()(const Key& lhs, const Key& rhs) const
+        {
+            return lhs.Raw == rhs.Raw;
+        }
+    };
+
+    NamePool()
+    {
+        EmptyName = insert(string_view());
+        for (auto name : s_wellKnownNames)
+            (void)insert(string_view(name, std::strlen(name)));
+    }
+
+    shared_ptr<NameData> Find(const string_view& raw, size_t hash) const
+    {
+        auto found = Names.find(Key{ raw, hash });
+        if (found == Names.end())
+            return nullptr;
+
+        return found->second;
+    }
+
+private:
+    shared_ptr<NameData> insert(const string_view& raw)
+    {
+        size_t hash = std::hash<string_view>()(raw);
+        shared_ptr<NameData> data(new NameData{ true, hash, charbuff(raw), expandUtf8String(raw) });
+        Names.emplace(Key{ data->Chars, hash }, data);
+        return data;
+    }
+
+public:
+    shared_ptr<NameData> EmptyName;
+    unordered_map<Key, shared_ptr<NameData>, KeyHash, KeyEqual> Names;
+};
 
 const PdfName PdfName::KeyNull = PdfName();
 const PdfName PdfName::KeyContents = PdfName("Contents");
@@ -33,7 +115,7 @@ const PdfName PdfName::KeyType = PdfName("Type");
 const PdfName PdfName::KeyFilter = PdfName("Filter");
 
 PdfName::PdfName()
-    : m_data(new NameData{ true, { }, nullptr })
+    : m_data(getNamePool().EmptyName)
 {
 }
 
@@ -52,14 +134,14 @@ PdfName::PdfName(const string_view& view)
     initFromUtf8String(view);
 }
 
-PdfName::PdfName(const PdfName& rhs)
+PdfName::PdfName(const PdfName& rhs) noexcept
     : m_data(rhs.m_data)
 {
 }
 
 PdfName::PdfName(charbuff&& buff)
-    : m_data(new NameData{ false, std::move(buff), nullptr })
 {
+    initFromRaw(buff, &buff);
 }
 
 void PdfName::initFromUtf8String(const string_view& view)
@@ -69,28 +151,71 @@ void PdfName::initFromUtf8String(const string_view& view)
 
     if (view.length() == 0)
     {
-        m_data.reset(new NameData{ true, { }, nullptr });
+        m_data = getNamePool().EmptyName;
         return;
     }
 
+    // An interned name whose raw data is equal to the utf8
+    // string is a valid match, and saves the validation
+    auto& pool = getNamePool();
+    size_t hash = std::hash<string_view>()(view);
+    m_data = pool.Find(view, hash);
+    if (m_data != nullptr && m_data->Utf8String == nullptr)
+        return;
+
     bool isAsciiEqual;
     if (!mm::CheckValidUTF8ToPdfDocEcondingChars(view, isAsciiEqual))
         PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidName, "Characters in string must be PdfDocEncoding character set");
 
     if (isAsciiEqual)
-        m_data.reset(new NameData{ true, charbuff(view), nullptr });
+    {
+        initFromRaw(view, nullptr);
+    }
     else
-        m_data.reset(new NameData{ true, (charbuff)mm::ConvertUTF8ToPdfDocEncoding(view), std::make_unique<string>(view) });
+    {
+        charbuff raw = (charbuff)mm::ConvertUTF8ToPdfDocEncoding(view);
+        hash = std::hash<string_view>()(raw);
+        m_data.reset(new NameData{ false, hash, std::move(raw), std::make_unique<string>(view) });
+    }
+}
+
+void PdfName::initFromRaw(const string_view& raw, charbuff* buff)
+{
+    auto& pool = getNamePool();
+    size_t hash = std::hash<string_view>()(raw);
+    m_data = pool.Find(raw, hash);
+    if (m_data != nullptr)
+        return;
+
+    // Expand the utf8 string now, since names may be
+    // read concurrently, eg. in frozen documents
+    auto utf8str = expandUtf8String(raw);
+
+    // NOTE: raw may be a view of buff, don't use it after the move
+    charbuff chars = buff == nullptr ? charbuff(raw) : std::move(*buff);
+    m_data.reset(new NameData{ false, hash, std::move(chars), std::move(utf8str) });
+}
+
+PdfName::NamePool& PdfName::getNamePool()
+{
+    static NamePool s_pool;
+    return s_pool;
 }
 
 PdfName PdfName::FromEscaped(const string_view& view)
 {
+    // Most names have no escaped characters
+    if (view.find('#') == string_view::npos)
+        return FromRaw(view);
+
     return FromRaw(UnescapeName(view));
 }
 
 PdfName PdfName::FromRaw(const bufferview& rawcontent)
 {
-    return PdfName((charbuff)rawcontent);
+    PdfName ret;
+    ret.initFromRaw(string_view(rawcontent.data(), rawcontent.size()), nullptr);
+    return ret;
 }
 
 void PdfName::Write(OutputStreamDevice& device, PdfWriteFlags,
@@ -116,18 +241,31 @@ string PdfName::GetEscapedName() const
     return ret;
 }
 
-void PdfName::expandUtf8String() const
+/** Expand the utf8 representation of the raw name
+ *  \returns nullptr if the utf8 string is the same as the raw data
+ */
+unique_ptr<string> expandUtf8String(const string_view& raw)
 {
-    if (!m_data->IsUtf8Expanded)
+    // Printable ASCII characters are the same in PdfDocEncoding
+    // and utf8, which is the case of almost all names
+    size_t i = 0;
+    for (; i < raw.length(); i++)
     {
-        bool isAsciiEqual;
-        string utf8str;
-        mm::ConvertPdfDocEncodingToUTF8(m_data->Chars, utf8str, isAsciiEqual);
-        if (!isAsciiEqual)
-            m_data->Utf8String.reset(new string(std::move(utf8str)));
-
-        m_data->IsUtf8Expanded = true;
+        unsigned char ch = (unsigned char)raw[i];
+        if (ch < 0x20 || ch > 0x7E)
+            break;
     }
+
+    if (i == raw.length())
+        return nullptr;
+
+    bool isAsciiEqual;
+    string utf8str;
+    mm::ConvertPdfDocEncodingToUTF8(raw, utf8str, isAsciiEqual);
+    if (isAsciiEqual)
+        return nullptr;
+
+    return std::make_unique<string>(std::move(utf8str));
 }
 
 /** Escape the input string according to the PDF name
@@ -222,7 +360,6 @@ string UnescapeName(const string_view& view)
 
 const string& PdfName::GetString() const
 {
-    expandUtf8String();
     if (m_data->Utf8String == nullptr)
         return m_data->Chars;
     else
@@ -250,15 +387,16 @@ bool PdfName::operator==(const PdfName& rhs) const
     if (this->m_data == rhs.m_data)
         return true;
 
-    return this->m_data->Chars == rhs.m_data->Chars;
+    if (this->m_data->IsInterned && rhs.m_data->IsInterned)
+        return false;
+
+    return this->m_data->Hash == rhs.m_data->Hash
+        && this->m_data->Chars == rhs.m_data->Chars;
 }
 
 bool PdfName::operator!=(const PdfName& rhs) const
 {
-    if (this->m_data == rhs.m_data)
-        return false;
-
-    return this->m_data->Chars != rhs.m_data->Chars;
+    return !operator==(rhs);
 }
 
 bool PdfName::operator==(const char* str) const
@@ -295,6 +433,9 @@ bool PdfName::operator!=(const string_view& view) const
 
 bool PdfName::operator<(const PdfName& rhs) const
 {
+    if (this->m_data == rhs.m_data)
+        return false;
+
     return this->m_data->Chars < rhs.m_data->Chars;
 }
 
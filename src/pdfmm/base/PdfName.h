@@ -20,10 +20,20 @@ namespace mm {
  *
  *  PdfName may have a maximum length of 127 characters.
  *
+ *  Well-known names (eg. /Type, /Length) are interned in a
+ *  process wide pool that is fixed at startup, so they share the
+ *  same data and can be compared by identity. Other names
+ *  are allocated separately.
+ *
+ *  Names are immutable once constructed, so they can be read
+ *  concurrently from different threads.
+ *
  *  \see PdfObject \see PdfVariant
  */
 class PDFMM_API PdfName final : public PdfDataProvider
 {
+    friend struct std::hash<PdfName>;
+
 public:
     /** Constructor to create nullptr strings.
      *  use PdfName::KeyNull instead of this constructor
@@ -46,7 +56,7 @@ public:
     /** Create a copy of an existing PdfName object.
      *  \param rhs another PdfName object
      */
-    PdfName(const PdfName& rhs);
+    PdfName(const PdfName& rhs) noexcept;
 
     static PdfName FromRaw(const bufferview& rawcontent);
 
@@ -127,17 +137,24 @@ public:
     static const PdfName KeyFilter;
 
 private:
-    void expandUtf8String() const;
+    struct NamePool;
+
     void initFromUtf8String(const std::string_view& view);
+    void initFromRaw(const std::string_view& raw, charbuff* buff);
+    static NamePool& getNamePool();
 
 private:
     struct NameData
     {
-        bool IsUtf8Expanded;
+        // Interned names are unique in the pool, so two
+        // interned names are equal only if they share the data
+        bool IsInterned;
+        size_t Hash;
 
         // The unescaped name raw data, without leading '/'.
         // It can store also the utf8 expanded string, if coincident
         charbuff Chars;
+        // The utf8 expanded string, if it's different from the raw data
         std::unique_ptr<std::string> Utf8String;
     };
 private:
@@ -155,7 +172,7 @@ namespace std
     {
         size_t operator()(const mm::PdfName& name) const noexcept
         {
-            return hash<string_view>()(name.GetRawData());
+            return name.m_data->Hash;
         }
     };
 }
@@ -8,6 +8,7 @@
 #include "PdfObject.h"
 
 #include "PdfDocument.h"
+#include "PdfArena.h"
 #include "PdfArray.h"
 #include "PdfDictionary.h"
 #include "PdfEncrypt.h"
@@ -15,9 +16,31 @@
 #include "PdfMemoryObjectStream.h"
 #include "PdfStreamDevice.h"
 
+#include <condition_variable>
+
 using namespace std;
 using namespace mm;
 
+namespace
+{
+    enum PdfLoadingFlags : uint8_t
+    {
+        LoadingVariant = 1,
+        LoadingStream = 2,
+    };
+}
+
+static void loadOnce(const PdfObject& obj, atomic<bool>& done, atomic<uint8_t>& loadingFlags,
+    uint8_t flag, const function<void()>& load);
+
+// Threads waiting for objects being loaded by other threads
+static mutex s_loadMutex;
+static condition_variable s_loadCondition;
+static atomic<unsigned> s_loadWaiterCount(0);
+
+// The objects being loaded by the current thread
+static thread_local vector<pair<const PdfObject*, uint8_t>> s_threadLoads;
+
 PdfObject PdfObject::Null;
 
 PdfObject::PdfObject()
@@ -25,6 +48,16 @@ PdfObject::PdfObject()
 
 PdfObject::~PdfObject() { }
 
+void* PdfObject::operator new(size_t size)
+{
+    return PdfArena::AllocateObject(size);
+}
+
+void PdfObject::operator delete(void* ptr) noexcept
+{
+    PdfArena::FreeObject(ptr);
+}
+
 PdfObject::PdfObject(const PdfVariant& var)
     : PdfObject(PdfVariant(var), PdfReference(), false) { }
 
@@ -160,12 +193,27 @@ void PdfObject::SetDocument(PdfDocument* document)
 
 void PdfObject::DelayedLoad() const
 {
-    if (m_IsDelayedLoadDone)
+    if (m_IsDelayedLoadDone.load(memory_order_acquire))
         return;
 
-    const_cast<PdfObject&>(*this).DelayedLoadImpl();
-    m_IsDelayedLoadDone = true;
-    const_cast<PdfObject&>(*this).SetVariantOwner();
+    auto load = [this]()
+    {
+        // Lazily loaded objects go in the arena of the document, if any
+        PdfArenaScope arenaScope(m_Document == nullptr ? nullptr : m_Document->GetObjects().GetArena());
+        const_cast<PdfObject&>(*this).DelayedLoadImpl();
+        const_cast<PdfObject&>(*this).SetVariantOwner();
+    };
+
+    if (m_Document != nullptr && m_Document->IsFrozen())
+    {
+        // Objects of frozen documents may be requested by multiple threads
+        loadOnce(*this, m_IsDelayedLoadDone, m_loadingFlags, LoadingVariant, load);
+    }
+    else
+    {
+        load();
+        m_IsDelayedLoadDone.store(true, memory_order_release);
+    }
 }
 
 void PdfObject::DelayedLoadImpl()
@@ -201,8 +249,9 @@ void PdfObject::initObject()
     m_Document = nullptr;
     m_Parent = nullptr;
     // By default delayed load is disabled
-    m_IsDelayedLoadDone = true;
-    m_IsDelayedLoadStreamDone = true;
+    m_IsDelayedLoadDone.store(true, memory_order_relaxed);
+    m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
+    m_loadingFlags.store(0, memory_order_relaxed);
 }
 
 void PdfObject::Write(OutputStreamDevice& device, PdfWriteFlags writeMode,
@@ -233,25 +282,11 @@ void PdfObject::Write(OutputStreamDevice& device, PdfWriteFlags writeMode,
 
     if (m_Stream != nullptr)
     {
-        // Try to compress the flate compress the stream if it has no filters,
-        // the compression is not disabled and it's not the /MetaData object,
-        // which must be unfiltered as per PDF/A
-        const PdfObject* metadataObj;
-        if ((writeMode & PdfWriteFlags::NoFlateCompress) == PdfWriteFlags::None
-            && m_Stream->GetFilters().size() == 0
-            && (m_Document == nullptr 
-                || (metadataObj = m_Document->GetCatalog().GetMetadataObject()) == nullptr
-                || m_IndirectReference != metadataObj->GetIndirectReference()))
+        if (shouldCompressStream(writeMode))
         {
-            PdfObject object;
-            auto& stream = object.GetOrCreateStream();
-            {
-                auto output = stream.GetOutputStream({ PdfFilterType::FlateDecode });
-                auto input = m_Stream->GetInputStream();
-                input.CopyTo(output);
-            }
-
-            stream.MoveFrom(*m_Stream);
+            PdfObject compressed;
+            compressStreamTo(compressed);
+            moveCompressedStreamFrom(compressed);
         }
 
         // Set length if it's not handled by the underlying provider
@@ -309,6 +344,36 @@ bool PdfObject::IsIndirect() const
     return m_IndirectReference.IsIndirect();
 }
 
+bool PdfObject::shouldCompressStream(PdfWriteFlags writeMode) const
+{
+    // Try to compress the flate compress the stream if it has no filters,
+    // the compression is not disabled and it's not the /MetaData object,
+    // which must be unfiltered as per PDF/A
+    const PdfObject* metadataObj;
+    return m_Stream != nullptr
+        && (writeMode & PdfWriteFlags::NoFlateCompress) == PdfWriteFlags::None
+        && m_Stream->GetFilters().size() == 0
+        && (m_Document == nullptr
+            || (metadataObj = m_Document->GetCatalog().GetMetadataObject()) == nullptr
+            || m_IndirectReference != metadataObj->GetIndirectReference());
+}
+
+void PdfObject::compressStreamTo(PdfObject& compressed) const
+{
+    // NOTE: This only reads the stream of this object, so
+    // different objects can be compressed concurrently
+    auto& stream = compressed.GetOrCreateStream();
+    stream.SetCompressionLevel(m_Stream->getEffectiveCompressionLevel());
+    auto output = stream.GetOutputStream({ PdfFilterType::FlateDecode });
+    auto input = m_Stream->GetInputStream();
+    input.CopyTo(output);
+}
+
+void PdfObject::moveCompressedStreamFrom(PdfObject& compressed) const
+{
+    m_Stream->MoveFrom(compressed.MustGetStream());
+}
+
 bool PdfObject::HasStream() const
 {
     DelayedLoadStream();
@@ -353,11 +418,23 @@ void PdfObject::DelayedLoadStream() const
 
 void PdfObject::delayedLoadStream() const
 {
-    if (m_IsDelayedLoadStreamDone)
+    if (m_IsDelayedLoadStreamDone.load(memory_order_acquire))
         return;
 
-    const_cast<PdfObject&>(*this).DelayedLoadStreamImpl();
-    m_IsDelayedLoadStreamDone = true;
+    auto load = [this]()
+    {
+        const_cast<PdfObject&>(*this).DelayedLoadStreamImpl();
+    };
+
+    if (m_Document != nullptr && m_Document->IsFrozen())
+    {
+        loadOnce(*this, m_IsDelayedLoadStreamDone, m_loadingFlags, LoadingStream, load);
+    }
+    else
+    {
+        load();
+        m_IsDelayedLoadStreamDone.store(true, memory_order_release);
+    }
 }
 
 // TODO2: SetDirty only if the value to be added is different
@@ -397,12 +474,12 @@ void PdfObject::moveStreamFrom(PdfObject& obj)
 
 void PdfObject::EnableDelayedLoading()
 {
-    m_IsDelayedLoadDone = false;
+    m_IsDelayedLoadDone.store(false, memory_order_relaxed);
 }
 
 void PdfObject::EnableDelayedLoadingStream()
 {
-    m_IsDelayedLoadStreamDone = false;
+    m_IsDelayedLoadStreamDone.store(false, memory_order_relaxed);
 }
 
 void PdfObject::DelayedLoadStreamImpl()
@@ -433,10 +510,10 @@ void PdfObject::assign(const PdfObject& rhs)
 {
     rhs.DelayedLoad();
     m_Variant = rhs.m_Variant;
-    m_IsDelayedLoadDone = true;
+    m_IsDelayedLoadDone.store(true, memory_order_relaxed);
     SetVariantOwner();
     copyStreamFrom(rhs);
-    m_IsDelayedLoadStreamDone = true;
+    m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
 }
 
 // NOTE: Don't move parent document/container and indirect reference.
@@ -445,15 +522,15 @@ void PdfObject::moveFrom(PdfObject& rhs)
 {
     rhs.DelayedLoad();
     m_Variant = std::move(rhs.m_Variant);
-    m_IsDelayedLoadDone = true;
+    m_IsDelayedLoadDone.store(true, memory_order_relaxed);
     SetVariantOwner();
     moveStreamFrom(rhs);
-    m_IsDelayedLoadStreamDone = true;
+    m_IsDelayedLoadStreamDone.store(true, memory_order_relaxed);
 }
 
 void PdfObject::ResetDirty()
 {
-    PDFMM_ASSERT(m_IsDelayedLoadDone);
+    PDFMM_ASSERT(IsDelayedLoadDone());
     // Propagate new dirty state to subclasses
     switch (m_Variant.GetDataType())
     {
@@ -866,3 +943,68 @@ bool PdfObject::operator!=(const PdfVariant& rhs) const
     DelayedLoad();
     return m_Variant != rhs;
 }
+
+// Perform the load of the object only once. Threads requesting the
+// object while it's being loaded by another thread wait for the load
+// to complete, and they try to load it again if the load failed
+void loadOnce(const PdfObject& obj, atomic<bool>& done, atomic<uint8_t>& loadingFlags,
+    uint8_t flag, const function<void()>& load)
+{
+    while (true)
+    {
+        if ((loadingFlags.fetch_or(flag) & flag) == 0)
+            break;
+
+        for (auto& threadLoad : s_threadLoads)
+        {
+            if (threadLoad.first == &obj && threadLoad.second == flag)
+            {
+                // Recursive load from the same thread, let it proceed
+                // as it happens in documents without concurrent access
+                load();
+                return;
+            }
+        }
+
+        s_loadWaiterCount.fetch_add(1);
+        {
+            unique_lock<mutex> lock(s_loadMutex);
+            s_loadCondition.wait(lock, [&]() { return (loadingFlags.load() & flag) == 0; });
+        }
+        s_loadWaiterCount.fetch_sub(1);
+        if (done.load(memory_order_acquire))
+            return;
+    }
+
+    auto endLoad = [&]()
+    {
+        s_threadLoads.pop_back();
+        loadingFlags.fetch_and((uint8_t)~flag);
+        if (s_loadWaiterCount.load() != 0)
+        {
+            // Take the lock, so waiters can't miss the notification
+            lock_guard<mutex> lock(s_loadMutex);
+            s_loadCondition.notify_all();
+        }
+    };
+
+    // Check again, as the object may have been loaded
+    // by another thread before setting the loading flag
+    s_threadLoads.push_back({ &obj, flag });
+    if (!done.load(memory_order_acquire))
+    {
+        try
+        {
+            load();
+        }
+        catch (...)
+        {
+            endLoad();
+            throw;
+        }
+
+        done.store(true, memory_order_release);
+    }
+
+    endLoad();
+}
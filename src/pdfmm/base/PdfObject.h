@@ -7,6 +7,8 @@
 #ifndef PDF_OBJECT_H
 #define PDF_OBJECT_H
 
+#include <atomic>
+
 #include "PdfVariant.h"
 #include "PdfObjectStream.h"
 
@@ -41,6 +43,7 @@ class PDFMM_API PdfObject
     friend class PdfDataContainer;
     friend class PdfObjectStreamParser;
     friend class PdfParser;
+    friend class PdfWriter;
 
 public:
     static PdfObject Null;
@@ -53,6 +56,13 @@ public:
 
     virtual ~PdfObject();
 
+    /** Objects are allocated in the arena of the
+     * document when it's enabled
+     * \see PdfMemDocument::SetUseArenaAllocation
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr) noexcept;
+
     /** Create a PDF object with the passed variant.
      *
      *  \param var the value of the object
@@ -408,7 +418,7 @@ public:
      * and loading has completed. External callers should never need to
      * see this, it's an internal state flag only.
      */
-    inline bool IsDelayedLoadDone() const { return m_IsDelayedLoadDone; }
+    inline bool IsDelayedLoadDone() const { return m_IsDelayedLoadDone.load(std::memory_order_acquire); }
 
     const PdfObjectStream* GetStream() const;
     PdfObjectStream* GetStream();
@@ -510,6 +520,15 @@ private:
 
     void copyStreamFrom(const PdfObject& obj);
 
+    // Determine if the stream shall be Flate compressed when writing
+    bool shouldCompressStream(PdfWriteFlags writeMode) const;
+
+    // Compress the stream to the given object, then replace the stream with
+    // the compressed one with moveCompressedStreamFrom()
+    void compressStreamTo(PdfObject& compressed) const;
+
+    void moveCompressedStreamFrom(PdfObject& compressed) const;
+
     void moveStreamFrom(PdfObject& obj);
 
     // Shared initialization between all the ctors
@@ -524,8 +543,12 @@ private:
     PdfDataContainer* m_Parent;
     bool m_IsDirty; // Indicates if this object was modified after construction
 
-    mutable bool m_IsDelayedLoadDone;
-    mutable bool m_IsDelayedLoadStreamDone;
+    // NOTE: Atomic flags allow checking for completed loads
+    // without locking, in documents with concurrent read access
+    mutable std::atomic<bool> m_IsDelayedLoadDone;
+    mutable std::atomic<bool> m_IsDelayedLoadStreamDone;
+    // The loads in progress, in documents with concurrent read access
+    mutable std::atomic<uint8_t> m_loadingFlags;
     std::unique_ptr<PdfObjectStream> m_Stream;
     // Tracks whether deferred loading is still pending (in which case it'll be
     // false). If true, deferred loading is not required or has been completed.
@@ -24,7 +24,8 @@ static bool isMediaFilter(PdfFilterType filterType);
 static PdfFilterList stripMediaFilters(const PdfFilterList& filters, PdfFilterList& mediaFilters);
 
 PdfObjectStream::PdfObjectStream(PdfObject& parent, std::unique_ptr<PdfObjectStreamProvider>&& provider)
-    : m_Parent(&parent), m_Provider(std::move(provider)), m_locked(false)
+    : m_Parent(&parent), m_Provider(std::move(provider)),
+    m_CompressionLevel(PdfCompressionLevel::Default), m_locked(false)
 {
     m_Provider->Init(parent);
 }
@@ -198,6 +199,26 @@ size_t PdfObjectStream::GetLength() const
     return m_Provider->GetLength();
 }
 
+void PdfObjectStream::SetCompressionLevel(PdfCompressionLevel level)
+{
+    if (level < PdfCompressionLevel::Default || level > PdfCompressionLevel::BestCompression)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Invalid flate compression level");
+
+    m_CompressionLevel = level;
+}
+
+PdfCompressionLevel PdfObjectStream::getEffectiveCompressionLevel() const
+{
+    if (m_CompressionLevel != PdfCompressionLevel::Default)
+        return m_CompressionLevel;
+
+    auto document = m_Parent->GetDocument();
+    if (document == nullptr)
+        return PdfCompressionLevel::Default;
+
+    return document->GetCompressionLevel();
+}
+
 void PdfObjectStream::MoveFrom(PdfObjectStream& rhs)
 {
     ensureClosed();
@@ -388,15 +409,24 @@ PdfObjectInputStream::~PdfObjectInputStream()
 }
 
 PdfObjectInputStream::PdfObjectInputStream(PdfObjectInputStream&& rhs) noexcept
+    : m_input(std::move(rhs.m_input)), m_MediaFilters(std::move(rhs.m_MediaFilters)),
+    m_MediaDecodeParms(std::move(rhs.m_MediaDecodeParms))
 {
     utls::move(rhs.m_stream, m_stream);
-    utls::move(rhs.m_MediaDecodeParms, m_MediaDecodeParms);
 }
 
 PdfObjectInputStream::PdfObjectInputStream(PdfObjectStream& stream, bool raw)
-    : m_stream(&stream)
+    : m_stream(nullptr)
 {
-    m_stream->m_locked = true;
+    // Streams of frozen documents can't be modified
+    // and may be read concurrently: don't lock them
+    auto doc = stream.GetParent().GetDocument();
+    if (doc == nullptr || !doc->IsFrozen())
+    {
+        m_stream = &stream;
+        m_stream->m_locked = true;
+    }
+
     m_input = stream.getInputStream(raw, m_MediaFilters, m_MediaDecodeParms);
 }
 
@@ -412,7 +442,14 @@ bool PdfObjectInputStream::readChar(char& ch)
 
 PdfObjectInputStream& PdfObjectInputStream::operator=(PdfObjectInputStream&& rhs) noexcept
 {
+    // Unlock the stream being read, if any
+    if (m_stream != nullptr)
+        m_stream->m_locked = false;
+
     utls::move(rhs.m_stream, m_stream);
+    m_input = std::move(rhs.m_input);
+    m_MediaFilters = std::move(rhs.m_MediaFilters);
+    m_MediaDecodeParms = std::move(rhs.m_MediaDecodeParms);
     return *this;
 }
 
@@ -423,44 +460,20 @@ PdfObjectOutputStream::~PdfObjectOutputStream()
 {
     if (m_stream != nullptr)
     {
-        // Set filters on the stream and on the parent object
-        // NOTE: if filters are not defined assume we will
-        // preserve them on the parent
-        if (m_filters.has_value())
-        {
-            auto& filters = *m_filters;
-            if (filters.size() == 0)
-            {
-                m_stream->GetParent().GetDictionary().RemoveKey(PdfName::KeyFilter);
-            }
-            else if (filters.size() == 1)
-            {
-                m_stream->GetParent().GetDictionary().AddKey(PdfName::KeyFilter,
-                    PdfName(mm::FilterToName(filters.front())));
-            }
-            else // filters.size() > 1
-            {
-                PdfArray arrFilters;
-                for (auto filterType : filters)
-                    arrFilters.Add(PdfName(mm::FilterToName(filterType)));
-
-                m_stream->GetParent().GetDictionary().AddKey(PdfName::KeyFilter, arrFilters);
-            }
-
-            m_stream->m_Filters = std::move(filters);
-        }
+        // Complete the output before notifying the end of the append
+        m_output = nullptr;
 
         // Unlock the stream
         m_stream->m_locked = false;
 
         auto document = m_stream->GetParent().GetDocument();
         if (document != nullptr)
-            document->GetObjects().BeginAppendStream(*m_stream);
+            document->GetObjects().EndAppendStream(*m_stream);
     }
 }
 
 PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectOutputStream&& rhs) noexcept
-    : m_filters(std::move(rhs.m_filters))
+    : m_output(std::move(rhs.m_output))
 {
     utls::move(rhs.m_stream, m_stream);
 }
@@ -478,7 +491,7 @@ PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectStream& stream)
 
 PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectStream& stream,
         nullable<PdfFilterList> filters, bool append)
-    : m_stream(&stream), m_filters(std::move(filters))
+    : m_stream(&stream)
 {
     auto document = stream.GetParent().GetDocument();
     if (document != nullptr)
@@ -488,22 +501,39 @@ PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectStream& stream,
     if (append)
         stream.CopyTo(buffer);
 
-    if (m_filters.has_value())
+    // Set filters on the stream and on the parent object before
+    // the data is written, since streamed providers may write
+    // the parent object immediately
+    // NOTE: if filters are not defined assume we will
+    // preserve them on the parent
+    if (filters.has_value())
     {
-        auto& filters = *m_filters;
-        if (filters.size() == 0)
+        if (filters->size() == 0)
         {
-            m_output = stream.m_Provider->GetOutputStream(stream.GetParent());
+            stream.GetParent().GetDictionary().RemoveKey(PdfName::KeyFilter);
         }
-        else
+        else if (filters->size() == 1)
+        {
+            stream.GetParent().GetDictionary().AddKey(PdfName::KeyFilter,
+                PdfName(mm::FilterToName(filters->front())));
+        }
+        else // filters->size() > 1
         {
-            m_output = PdfFilterFactory::CreateEncodeStream(
-                stream.m_Provider->GetOutputStream(stream.GetParent()), filters);
+            PdfArray arrFilters;
+            for (auto filterType : *filters)
+                arrFilters.Add(PdfName(mm::FilterToName(filterType)));
+
+            stream.GetParent().GetDictionary().AddKey(PdfName::KeyFilter, arrFilters);
         }
+
+        stream.m_Filters = *filters;
     }
-    else
+
+    m_output = stream.m_Provider->GetOutputStream(stream.GetParent());
+    if (filters.has_value() && filters->size() != 0)
     {
-        m_output = stream.m_Provider->GetOutputStream(stream.GetParent());
+        m_output = PdfFilterFactory::CreateEncodeStream(std::move(m_output), *filters,
+            stream.getEffectiveCompressionLevel());
     }
 
     m_stream->m_locked = true;
@@ -526,7 +556,6 @@ PdfObjectOutputStream& PdfObjectOutputStream::operator=(PdfObjectOutputStream&&
 {
     utls::move(rhs.m_stream, m_stream);
     m_output = std::move(rhs.m_output);
-    m_filters = std::move(rhs.m_filters);
     return *this;
 }
 
@@ -20,7 +20,7 @@ namespace mm {
 class PdfObject;
 class PdfObjectStream;
 
-class PdfObjectInputStream : public InputStream
+class PDFMM_API PdfObjectInputStream : public InputStream
 {
     friend class PdfObjectStream;
 public:
@@ -44,7 +44,7 @@ private:
     std::vector<const PdfDictionary*> m_MediaDecodeParms;
 };
 
-class PdfObjectOutputStream : public OutputStream
+class PDFMM_API PdfObjectOutputStream : public OutputStream
 {
     friend class PdfObjectStream;
 public:
@@ -65,7 +65,6 @@ public:
     PdfObjectOutputStream& operator=(PdfObjectOutputStream&& rhs) noexcept;
 private:
     PdfObjectStream* m_stream;
-    nullable<PdfFilterList> m_filters;
     std::unique_ptr<OutputStream> m_output;
 };
 
@@ -182,6 +181,15 @@ public:
 
     const PdfFilterList& GetFilters() { return m_Filters; }
 
+    /** Set the level used when Flate-encoding data written to this stream,
+     * including the compression performed when saving the document.
+     * PdfCompressionLevel::Default inherits the level of the document
+     * \see PdfDocument::SetCompressionLevel
+     */
+    void SetCompressionLevel(PdfCompressionLevel level);
+
+    PdfCompressionLevel GetCompressionLevel() const { return m_CompressionLevel; }
+
     /** Create a copy of a PdfObjectStream object
      *  \param rhs the object to clone
      *  \returns a reference to this object
@@ -221,6 +229,8 @@ private:
 
     void setData(InputStream& stream, PdfFilterList filters, ssize_t size, bool markObjectDirty);
 
+    PdfCompressionLevel getEffectiveCompressionLevel() const;
+
 private:
     PdfObjectStream(const PdfObjectStream& rhs) = delete;
 
@@ -228,6 +238,7 @@ private:
     PdfObject* m_Parent;
     std::unique_ptr<PdfObjectStreamProvider> m_Provider;
     PdfFilterList m_Filters;
+    PdfCompressionLevel m_CompressionLevel;
     bool m_locked;
 };
 
@@ -10,81 +10,182 @@
 #include <algorithm>
 
 #include "PdfDictionary.h"
-#include "PdfEncrypt.h"
-#include "PdfParserObject.h"
 #include "PdfObjectStream.h"
 #include "PdfIndirectObjectList.h"
 #include "PdfStreamDevice.h"
+#include "PdfTokenizer.h"
 
 using namespace std;
 using namespace mm;
 
-PdfObjectStreamParser::PdfObjectStreamParser(PdfParserObject& parser,
-        PdfIndirectObjectList& objects, const shared_ptr<charbuff>& buffer)
-    : m_Parser(&parser), m_Objects(&objects), m_buffer(buffer)
+// Number of decompressed object streams kept in memory
+constexpr unsigned MAX_CACHED_OBJECT_STREAMS = 8;
+
+PdfObjectStreamParser::PdfObjectStreamParser(PdfIndirectObjectList& objects)
+    : m_Objects(&objects)
 {
-    if (buffer == nullptr)
-        PDFMM_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 }
 
-void PdfObjectStreamParser::Parse(const cspan<int64_t>& objectList)
+bool PdfObjectStreamParser::TryReadObject(uint32_t streamObjNum, unsigned index,
+    uint32_t objNum, PdfVariant& variant)
 {
-    int64_t num = m_Parser->GetDictionary().FindKeyAs<int64_t>("N", 0);
-    int64_t first = m_Parser->GetDictionary().FindKeyAs<int64_t>("First", 0);
+    // Guard against object streams that need themselves
+    // to be decompressed, eg. with an indirect /Length
+    // that points to an object compressed in the stream
+    utls::RecursionGuard guard;
+
+    // NOTE: The buffer is kept alive also if it's
+    // evicted from the cache by another thread
+    auto buffer = getStreamBuffer(streamObjNum);
+    auto& streamIndex = getStreamIndex(streamObjNum, *buffer);
+
+    size_t offset;
+    if (index < streamIndex.size() && streamIndex[index].first == objNum)
+    {
+        offset = streamIndex[index].second;
+    }
+    else
+    {
+        // The xref index is wrong, search the object in the table of contents
+        auto found = std::find_if(streamIndex.begin(), streamIndex.end(),
+            [objNum](const pair<uint32_t, size_t>& entry) { return entry.first == objNum; });
+        if (found == streamIndex.end())
+            return false;
 
-    charbuff buffer;
-    m_Parser->GetOrCreateStream().CopyTo(buffer);
+        offset = found->second;
+    }
 
-    this->readObjectsFromStream(buffer.data(), buffer.size(), num, first, objectList);
-    m_Parser = nullptr;
+    SpanStreamDevice device(buffer->data(), buffer->size());
+    device.Seek(offset);
+    PdfTokenizer tokenizer;
+    tokenizer.ReadNextVariant(device, variant); // NOTE: The stream is already decrypted
+    return true;
 }
 
-void PdfObjectStreamParser::readObjectsFromStream(char* buffer, size_t bufferLen,
-    int64_t num, int64_t first, const cspan<int64_t>& objectList)
+shared_ptr<const charbuff> PdfObjectStreamParser::getStreamBuffer(uint32_t streamObjNum)
 {
-    SpanStreamDevice device(buffer, bufferLen);
-    PdfTokenizer tokenizer(m_buffer);
-    PdfVariant var;
-    int i = 0;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (auto it = m_streamBuffers.begin(); it != m_streamBuffers.end(); it++)
+        {
+            if (it->first == streamObjNum)
+            {
+                // Move the buffer to the front, as the most recently used
+                m_streamBuffers.splice(m_streamBuffers.begin(), m_streamBuffers, it);
+                return it->second;
+            }
+        }
+    }
+
+    // The generation number of an object stream is always 0
+    auto streamObj = getObjects().GetObject(PdfReference(streamObjNum, 0));
+    if (streamObj == nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NoObject, "Missing object stream {} 0 R", streamObjNum);
 
-    while (i < num)
+    auto stream = streamObj->GetStream();
+    if (stream == nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::BrokenFile, "Object {} 0 R is not an object stream", streamObjNum);
+
+    auto buffer = std::make_shared<charbuff>();
+    stream->CopyTo(*buffer);
+
+    // Another thread may have decompressed the same stream in
+    // the meantime: both buffers are valid, cache the last one
+    lock_guard<mutex> lock(m_mutex);
+    if (m_streamBuffers.size() == MAX_CACHED_OBJECT_STREAMS)
+        m_streamBuffers.pop_back();
+
+    m_streamBuffers.emplace_front(streamObjNum, buffer);
+    return buffer;
+}
+
+const PdfObjectStreamParser::ObjectStreamIndex& PdfObjectStreamParser::getStreamIndex(
+    uint32_t streamObjNum, const charbuff& buffer)
+{
+    {
+        lock_guard<mutex> lock(m_mutex);
+        auto found = m_indices.find(streamObjNum);
+        if (found != m_indices.end())
+            return found->second;
+    }
+
+    ObjectStreamIndex index;
+    readStreamIndex(getObjects().MustGetObject(PdfReference(streamObjNum, 0)), buffer, index);
+
+    // NOTE: References to the elements of the map stay valid when
+    // other elements are inserted. If another thread read the same
+    // index in the meantime, the index already inserted is kept
+    lock_guard<mutex> lock(m_mutex);
+    return m_indices.emplace(streamObjNum, std::move(index)).first->second;
+}
+
+void PdfObjectStreamParser::detachObjects()
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_Objects = nullptr;
+    m_indices.clear();
+    m_streamBuffers.clear();
+}
+
+PdfIndirectObjectList& PdfObjectStreamParser::getObjects()
+{
+    lock_guard<mutex> lock(m_mutex);
+    if (m_Objects == nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The object list of the object streams has been cleared");
+
+    return *m_Objects;
+}
+
+void PdfObjectStreamParser::readStreamIndex(const PdfObject& streamObj,
+    const charbuff& buffer, ObjectStreamIndex& index)
+{
+    int64_t num = streamObj.GetDictionary().FindKeyAs<int64_t>("N", 0);
+    int64_t first = streamObj.GetDictionary().FindKeyAs<int64_t>("First", 0);
+    if (num < 0 || first < 0 || (size_t)first > buffer.size())
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::BrokenFile, "Invalid object stream /N or /First");
+
+    SpanStreamDevice device(buffer.data(), buffer.size());
+    PdfTokenizer tokenizer;
+    // NOTE: Don't trust /N to reserve memory
+    index.reserve((size_t)std::min<int64_t>(num, (int64_t)buffer.size()));
+    for (int64_t i = 0; i < num; i++)
     {
         int64_t objNo = tokenizer.ReadNextNumber(device);
         int64_t offset = tokenizer.ReadNextNumber(device);
-        size_t pos = device.GetPosition();
-
-        if (first >= std::numeric_limits<int64_t>::max() - offset)
+        if (objNo < 0 || objNo > numeric_limits<uint32_t>::max()
+            || offset < 0 || offset >= (int64_t)buffer.size() - first)
         {
             PDFMM_RAISE_ERROR_INFO(PdfErrorCode::BrokenFile,
                 "Object position out of max limit");
         }
 
-        // move to the position of the object in the stream
-        device.Seek(static_cast<size_t>(first + offset));
-
-        // use a second tokenizer here so that anything that gets dequeued isn't left in the tokenizer that reads the offsets and lengths
-        PdfTokenizer variantTokenizer(m_buffer);
-        variantTokenizer.ReadNextVariant(device, var); // NOTE: The stream is already decrypted
+        index.push_back({ (uint32_t)objNo, (size_t)(first + offset) });
+    }
+}
 
-        bool shouldRead = std::find(objectList.begin(), objectList.end(), objNo) != objectList.end();
-#ifndef VERBOSE_DEBUG_DISABLED
-        std::cerr << "ReadObjectsFromStream STREAM=" << m_Parser->GetIndirectReference().ToString() <<
-            ", OBJ=" << objNo <<
-            ", " << (shouldRead ? "read" : "skipped") << std::endl;
-#endif
-        if (shouldRead)
-        {
-            // The generation number of an object stream and of any
-            // compressed object is implicitly zero
-            PdfReference reference(static_cast<uint32_t>(objNo), 0);
-            auto obj = new PdfObject(std::move(var));
-            obj->SetIndirectReference(reference);
-            m_Objects->PushObject(obj);
-        }
+PdfCompressedObject::PdfCompressedObject(const PdfReference& indirectReference,
+        const shared_ptr<PdfObjectStreamParser>& parser, uint32_t streamObjNum, unsigned index)
+    : PdfObject(PdfVariant(), indirectReference, false),
+    m_parser(parser), m_StreamObjNum(streamObjNum), m_Index(index)
+{
+    if (parser == nullptr)
+        PDFMM_RAISE_ERROR(PdfErrorCode::InvalidHandle);
 
-        // move back to the position inside of the table of contents
-        device.Seek(pos);
+    EnableDelayedLoading();
+}
 
-        i++;
+void PdfCompressedObject::DelayedLoadImpl()
+{
+    auto& reference = GetIndirectReference();
+    if (!m_parser->TryReadObject(m_StreamObjNum, m_Index, reference.ObjectNumber(), m_Variant))
+    {
+        // References to missing objects are
+        // treated as references to the null object
+        mm::LogMessage(PdfLogSeverity::Warning, "Object {} 0 R is missing in object stream {} 0 R",
+            reference.ObjectNumber(), m_StreamObjNum);
+        m_Variant = PdfVariant();
     }
+
+    // Release the parser as soon as possible
+    m_parser = nullptr;
 }
@@ -9,42 +9,93 @@
 
 #include "PdfDeclarations.h"
 
-#include "PdfParserObject.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "PdfObject.h"
 
 namespace mm {
 
-class PdfEncrypt;
 class PdfIndirectObjectList;
 
 /**
  * A utility class for PdfParser that can parse
- * an object stream object (PDF Reference 1.7 3.4.6 Object Streams)
+ * objects from object streams (PDF Reference 1.7 3.4.6 Object Streams)
+ *
+ * The table of contents of each object stream is read only
+ * once, while the decompressed data of the most recently
+ * used streams is cached, so single objects can be read
+ * when they are requested without decompressing again
+ * the whole stream every time. Objects can be read by
+ * multiple threads, in documents with concurrent read access.
  *
  * It is mainly here to make PdfParser more modular.
  */
-class PdfObjectStreamParser
+class PdfObjectStreamParser final
 {
+    friend class PdfIndirectObjectList;
+
 public:
     /**
-     * Create a new PdfObjectStreamParserObject from an existing
-     * PdfParserObject. The PdfParserObject will be removed and deleted.
-     * All objects from the object stream will be read into memory.
+     * Create a new PdfObjectStreamParser
+     *
+     * \param objects the list where object streams are looked up
+     * \remarks The list must be detached when it's cleared
+     * \see PdfIndirectObjectList::AddObjectStreamParser
+     */
+    PdfObjectStreamParser(PdfIndirectObjectList& objects);
+
+    /**
+     * Read an object from an object stream
      *
-     * \param parser PdfParserObject for an object stream
-     * \param objects add loaded objects to this vector of objects
-     * \param buffer use this allocated buffer for caching
+     * \param streamObjNum the object number of the object stream
+     * \param index index of the object in the stream, as specified by the xref
+     * \param objNum the object number of the object to read
+     * \param variant the read object
+     * \returns false if the object is not present in the object stream
      */
-    PdfObjectStreamParser(PdfParserObject& parser, PdfIndirectObjectList& objects, const std::shared_ptr<charbuff>& buffer);
+    bool TryReadObject(uint32_t streamObjNum, unsigned index, uint32_t objNum, PdfVariant& variant);
+
+private:
+    // The object numbers and the absolute offsets
+    // of the objects in the decompressed stream
+    using ObjectStreamIndex = std::vector<std::pair<uint32_t, size_t>>;
+    using ObjectStreamBuffer = std::pair<uint32_t, std::shared_ptr<const charbuff>>;
 
-    void Parse(const cspan<int64_t>& objectList);
+    void detachObjects();
+    PdfIndirectObjectList& getObjects();
+    std::shared_ptr<const charbuff> getStreamBuffer(uint32_t streamObjNum);
+    const ObjectStreamIndex& getStreamIndex(uint32_t streamObjNum, const charbuff& buffer);
+    void readStreamIndex(const PdfObject& streamObj, const charbuff& buffer, ObjectStreamIndex& index);
 
 private:
-    void readObjectsFromStream(char* buffer, size_t lBufferLen, int64_t lNum, int64_t lFirst, const cspan<int64_t>& list);
+    PdfIndirectObjectList* m_Objects;      // nullptr when the list has been cleared
+    // Guards the caches. It's not held while loading the object
+    // streams, as they may need other compressed objects
+    std::mutex m_mutex;
+    std::unordered_map<uint32_t, ObjectStreamIndex> m_indices;
+    std::list<ObjectStreamBuffer> m_streamBuffers;       // Most recently used first
+};
+
+/**
+ * An object compressed in an object stream that is read
+ * only when it's accessed for the first time
+ */
+class PdfCompressedObject final : public PdfObject
+{
+public:
+    PdfCompressedObject(const PdfReference& indirectReference,
+        const std::shared_ptr<PdfObjectStreamParser>& parser,
+        uint32_t streamObjNum, unsigned index);
+
+protected:
+    void DelayedLoadImpl() override;
 
 private:
-    PdfParserObject* m_Parser;
-    PdfIndirectObjectList* m_Objects;
-    std::shared_ptr<charbuff> m_buffer;
+    std::shared_ptr<PdfObjectStreamParser> m_parser;
+    uint32_t m_StreamObjNum;
+    unsigned m_Index;
 };
 
 };
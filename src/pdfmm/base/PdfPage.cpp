@@ -24,6 +24,7 @@ static PdfResources* getResources(PdfObject& obj, const deque<PdfObject*>& listO
 PdfPage::PdfPage(PdfDocument& parent, unsigned index, const PdfRect& size) :
     PdfDictionaryElement(parent, "Page"),
     m_Index(index),
+    m_flushed(false),
     m_Contents(nullptr),
     m_Annotations(*this)
 {
@@ -33,6 +34,7 @@ PdfPage::PdfPage(PdfDocument& parent, unsigned index, const PdfRect& size) :
 PdfPage::PdfPage(PdfObject& obj, unsigned index, const deque<PdfObject*>& listOfParents) :
     PdfDictionaryElement(obj),
     m_Index(index),
+    m_flushed(false),
     m_Contents(nullptr),
     m_Resources(::getResources(obj, listOfParents)),
     m_Annotations(*this)
@@ -72,6 +74,7 @@ void PdfPage::ensureContentsCreated()
     if (m_Contents != nullptr)
         return;
 
+    ensureNotFlushed();
     m_Contents.reset(new PdfContents(*this));
     GetDictionary().AddKey(PdfName::KeyContents,
         m_Contents->GetObject().GetIndirectReference());
@@ -82,11 +85,27 @@ void PdfPage::ensureResourcesCreated()
     if (m_Resources != nullptr)
         return;
 
+    ensureNotFlushed();
     m_Resources.reset(new PdfResources(GetDictionary()));
 }
 
+void PdfPage::invalidate()
+{
+    m_flushed = true;
+    m_Contents = nullptr;
+    m_Resources = nullptr;
+    m_Annotations.m_annotArray = nullptr;
+}
+
+void PdfPage::ensureNotFlushed() const
+{
+    if (m_flushed)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The page has been flushed and can't be modified");
+}
+
 PdfObjectStream& PdfPage::GetStreamForAppending(PdfStreamAppendFlags flags)
 {
+    ensureNotFlushed();
     ensureContentsCreated();
     return m_Contents->GetStreamForAppending(flags);
 }
@@ -15,6 +15,7 @@
 #include "PdfContents.h"
 #include "PdfField.h"
 #include "PdfResources.h"
+#include "PdfTextSearchPattern.h"
 
 namespace mm {
 
@@ -47,6 +48,8 @@ class PDFMM_API PdfPage final : public PdfDictionaryElement, public PdfCanvas
 {
     PDFMM_UNIT_TEST(PdfPageTest);
     friend class PdfPageCollection;
+    friend class PdfAnnotationCollection;
+    friend class PdfStreamedDocument;
 
 private:
     /** Create a new PdfPage object.
@@ -73,6 +76,14 @@ public:
         const std::string_view& pattern = { },
         const PdfTextExtractParams& params = { }) const;
 
+    /** Extract the text matching a precompiled pattern
+     * \remarks The matching flags of the pattern are used, instead
+     *      of the ones in the extraction parameters
+     */
+    void ExtractTextTo(std::vector<PdfTextEntry>& entries,
+        const PdfTextSearchPattern& pattern,
+        const PdfTextExtractParams& params = { }) const;
+
     PdfRect GetRect() const override;
 
     bool HasRotation(double& teta) const override;
@@ -215,6 +226,16 @@ private:
     void ensureContentsCreated();
     void ensureResourcesCreated();
 
+    /** Drop the cached contents, resources and annotations array,
+     * which point into the page dictionary, after the page has been
+     * written and released by PdfStreamedDocument::FlushPage()
+     */
+    void invalidate();
+
+    /** Raise if the page has been flushed and can't be modified anymore
+     */
+    void ensureNotFlushed() const;
+
     /** Get the bounds of a specified page box in PDF units.
      * This function is internal, since there are wrappers for all standard boxes
      *  \returns PdfRect the page box
@@ -229,6 +250,7 @@ private:
 
 private:
     unsigned m_Index;
+    bool m_flushed;
     std::unique_ptr<PdfContents> m_Contents;
     std::unique_ptr<PdfResources> m_Resources;
     PdfAnnotationCollection m_Annotations;
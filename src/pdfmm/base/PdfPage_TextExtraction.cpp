@@ -7,7 +7,6 @@
 #include <pdfmm/private/PdfDeclarationsPrivate.h>
 #include "PdfPage.h"
 
-#include <regex>
 #include <deque>
 #include <stack>
 
@@ -80,11 +79,8 @@ public:
 
 struct EntryOptions
 {
-    bool IgnoreCase;
     bool TrimSpaces;
     bool TokenizeWords;
-    bool MatchWholeWord;
-    bool RegexPattern;
     bool ComputeBoundingBox;
     bool RawCoordinates;
     bool ExtractSubstring;
@@ -120,7 +116,7 @@ struct XObjectState
 struct ExtractionContext
 {
 public:
-    ExtractionContext(vector<PdfTextEntry> &entries, const PdfPage &page, const string_view &pattern,
+    ExtractionContext(vector<PdfTextEntry> &entries, const PdfPage &page, const PdfTextSearchPattern &pattern,
         PdfTextExtractFlags flags, const nullable<PdfRect> &clipRect);
 public:
     void BeginText();
@@ -145,7 +141,7 @@ private:
     const PdfPage& m_page;
 public:
     const int PageIndex;
-    const string Pattern;
+    const PdfTextSearchPattern& Pattern;
     const EntryOptions Options;
     const nullable<PdfRect> ClipRect;
     unique_ptr<Matrix> Rotation;
@@ -174,17 +170,16 @@ static void splitStringBySpaces(vector<StatefulString> &separatedStrings, const
 static void trimSpacesBegin(StringChunk &chunk);
 static void trimSpacesEnd(StringChunk &chunk);
 static void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &strings,
-    const string_view &pattern, const EntryOptions &options, const nullable<PdfRect> &clipRect,
+    const PdfTextSearchPattern &pattern, const EntryOptions &options, const nullable<PdfRect> &clipRect,
     int pageIndex, const Matrix* rotation);
 static void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &strings,
-    const string_view &pattern, const EntryOptions& options, const nullable<PdfRect> &clipRect,
+    const PdfTextSearchPattern &pattern, const EntryOptions& options, const nullable<PdfRect> &clipRect,
     int pageIndex, const Matrix* rotation);
 static void processChunks(const StringChunkList& chunks, string& destString,
     vector<unsigned>& positions, vector<const StatefulString*>& strings,
     vector<GlyphAddress>& glyphAddresses);
 static double computeLength(const vector<const StatefulString*>& strings, const vector<GlyphAddress>& glyphAddresses,
     unsigned lowerIndex, unsigned upperIndex);
-static bool isMatchWholeWordSubstring(const string_view& str, const string_view& pattern, size_t& matchPos);
 static PdfRect computeBoundingBox(const TextState& textState, double boxWidth);
 static void read(const PdfVariantStack& stack, double &tx, double &ty);
 static void read(const PdfVariantStack& stack, double &a, double &b, double &c, double &d, double &e, double &f);
@@ -199,6 +194,12 @@ void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const PdfTextExtractP
 
 void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const string_view& pattern,
     const PdfTextExtractParams& params) const
+{
+    ExtractTextTo(entries, PdfTextSearchPattern(pattern, params.Flags), params);
+}
+
+void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const PdfTextSearchPattern& pattern,
+    const PdfTextExtractParams& params) const
 {
     ExtractionContext context(entries, *this, pattern, params.Flags, params.ClipRect);
 
@@ -438,7 +439,7 @@ void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const string_view& pa
     context.TryAddLastEntry();
 }
 
-void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const string_view &pattern,
+void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const PdfTextSearchPattern &pattern,
     const EntryOptions &options, const nullable<PdfRect> &clipRect, int pageIndex, const Matrix* rotation)
 {
     if (options.TokenizeWords)
@@ -503,7 +504,7 @@ void addEntry(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const
     }
 }
 
-void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const string_view &pattern,
+void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, const PdfTextSearchPattern &pattern,
     const EntryOptions& options, const nullable<PdfRect> &clipRect, int pageIndex, const Matrix* rotation)
 {
     if (options.TrimSpaces)
@@ -558,79 +559,36 @@ void addEntryChunk(vector<PdfTextEntry> &textEntries, StringChunkList &chunks, c
     unsigned lowerIndex = 0;
     unsigned upperIndexLimit = (unsigned)glyphAddresses.size();
     auto textState = firstStr.State;
-    if (pattern.length() != 0)
+    if (!pattern.IsEmpty())
     {
-        PDFMM_INVARIANT(utls::IsValidUtf8String(pattern));
         bool match;
-        if (options.RegexPattern)
-        {
-            PDFMM_ASSERT(!(options.MatchWholeWord || options.ExtractSubstring));
-            auto flags = regex_constants::ECMAScript;
-            if (options.IgnoreCase)
-                flags |= regex_constants::icase;
-
-            // NOTE: regex_search returns true when a sub-part of the string
-            // matches the regex
-            regex pieces_regex((string)pattern, flags);
-            match = std::regex_search(str, pieces_regex);
-        }
-        else
+        if (options.ExtractSubstring)
         {
-            if (options.ExtractSubstring)
+            size_t pos;
+            match = pattern.TryFind(str, pos);
+            if (match)
             {
-                size_t pos;
-                if (options.MatchWholeWord)
-                {
-                    if (options.IgnoreCase)
-                        match = isMatchWholeWordSubstring(utls::ToLower(str), utls::ToLower(pattern), pos);
-                    else
-                        match = isMatchWholeWordSubstring(str, pattern, pos);
-                }
-                else
-                {
-                    if (options.IgnoreCase)
-                        pos = utls::ToLower(str).find(utls::ToLower(pattern));
-                    else
-                        pos = str.find(pattern);
-                    match = pos != string::npos;
-                }
+                size_t patternLength = pattern.GetPattern().size();
+                getSubstringIndices(positions, (unsigned)pos, (unsigned)(pos + patternLength),
+                    lowerIndex, upperIndexLimit);
 
-                if (match)
-                {
-                    getSubstringIndices(positions, (unsigned)pos, (unsigned)(pos + pattern.size()),
-                        lowerIndex, upperIndexLimit);
-
-                    // Assign actual found matched substring
-                    if (pos != 0 || str.size() != pattern.size())
-                        str = str.substr(pos, pattern.size());
+                // Assign actual found matched substring
+                if (pos != 0 || str.size() != patternLength)
+                    str = str.substr(pos, patternLength);
 
-                    if (lowerIndex != 0)
-                    {
-                        // Compute substring translation and apply it
-                        // TODO: Handle vertical scritps
-                        double substringTx = computeLength(strings, glyphAddresses, 0, lowerIndex - 1);
-                        textState.T_rm.Apply<Tx>(substringTx);
-                    }
-                }
-            }
-            else
-            {
-                if (options.MatchWholeWord)
+                if (lowerIndex != 0)
                 {
-                    if (options.IgnoreCase)
-                        match = utls::ToLower(str) == utls::ToLower(pattern);
-                    else
-                        match = str == pattern;
-                }
-                else
-                {
-                    if (options.IgnoreCase)
-                        match = utls::ToLower(str).find(utls::ToLower(pattern)) != string::npos;
-                    else
-                        match = str.find(pattern) != string::npos;
+                    // Compute substring translation and apply it
+                    // TODO: Handle vertical scritps
+                    double substringTx = computeLength(strings, glyphAddresses, 0, lowerIndex - 1);
+                    textState.T_rm.Apply<Tx>(substringTx);
                 }
             }
         }
+        else
+        {
+            match = pattern.IsMatch(str);
+        }
 
         if (!match)
         {
@@ -883,7 +841,7 @@ void TextStateStack::push(const TextState & state)
     m_current = &m_states.top();
 }
 
-ExtractionContext::ExtractionContext(vector<PdfTextEntry>& entries, const PdfPage& page, const string_view& pattern,
+ExtractionContext::ExtractionContext(vector<PdfTextEntry>& entries, const PdfPage& page, const PdfTextSearchPattern& pattern,
     PdfTextExtractFlags flags , const nullable<PdfRect>& clipRect) :
     m_page(page),
     PageIndex(page.GetPageNumber() - 1),
@@ -892,8 +850,14 @@ ExtractionContext::ExtractionContext(vector<PdfTextEntry>& entries, const PdfPag
     ClipRect(clipRect),
     Entries(entries)
 {
-    if (Options.ExtractSubstring && pattern.empty())
-        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Unsupported ExtractSubstring flag with empty pattern");
+    if (Options.ExtractSubstring)
+    {
+        if (pattern.IsEmpty())
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Unsupported ExtractSubstring flag with empty pattern");
+
+        if (pattern.IsRegex())
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "RegexPattern is currently unsupported with ExtractSubstring");
+    }
 
     // Determine page rotation transformation
     double teta;
@@ -1322,48 +1286,6 @@ double computeLength(const vector<const StatefulString*>& strings, const vector<
     }
 }
 
-// Verify if the string matches the pattern and verify
-// presence of delimiters for whole word match
-bool isMatchWholeWordSubstring(const string_view& str, const string_view& pattern, size_t& matchPos)
-{
-    bool prevDelimiter;
-    auto found = str.find(pattern);
-    string_view::const_iterator it;
-    string_view::const_iterator end;
-    char32_t cp;
-    if (found == string_view::npos)
-        goto NoMatch;
-
-    it = str.begin();
-    end = str.begin() + found;
-
-    prevDelimiter = true;
-    while (it != end)
-    {
-        cp = utf8::unchecked::next(it);
-        prevDelimiter = utls::IsStringDelimiter(cp);
-    }
-
-    if (!prevDelimiter)
-        goto NoMatch;
-
-    it = str.begin() + found + pattern.length();
-    end = str.end();
-    if (it != end)
-    {
-        cp = utf8::unchecked::next(it);
-        if (!utls::IsStringDelimiter(cp))
-            goto NoMatch;
-    }
-
-    matchPos = found;
-    return true;
-
-NoMatch:
-    matchPos = string_view::npos;
-    return false;
-}
-
 PdfRect computeBoundingBox(const TextState& textState, double boxWidth)
 {
     // NOTE: This is very inaccurate
@@ -1415,23 +1337,10 @@ void getSubstringIndices(const vector<unsigned>& positions, unsigned lowerPos, u
 EntryOptions optionsFromFlags(PdfTextExtractFlags flags)
 {
     EntryOptions ret;
-    ret.IgnoreCase = (flags & PdfTextExtractFlags::IgnoreCase) != PdfTextExtractFlags::None;
-    ret.MatchWholeWord = (flags & PdfTextExtractFlags::MatchWholeWord) != PdfTextExtractFlags::None;
-    ret.RegexPattern = (flags & PdfTextExtractFlags::RegexPattern) != PdfTextExtractFlags::None;
     ret.TokenizeWords = (flags & PdfTextExtractFlags::TokenizeWords) != PdfTextExtractFlags::None;
     ret.TrimSpaces = (flags & PdfTextExtractFlags::KeepWhiteTokens) == PdfTextExtractFlags::None || ret.TokenizeWords;
     ret.ComputeBoundingBox = (flags & PdfTextExtractFlags::ComputeBoundingBox) != PdfTextExtractFlags::None;
     ret.RawCoordinates = (flags & PdfTextExtractFlags::RawCoordinates) != PdfTextExtractFlags::None;
     ret.ExtractSubstring = (flags & PdfTextExtractFlags::ExtractSubstring) != PdfTextExtractFlags::None;
-
-    if (ret.RegexPattern)
-    {
-        if (ret.MatchWholeWord)
-            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "RegexPattern is incompatible with MatchWholeWord flag");
-
-        if (ret.ExtractSubstring)
-            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "RegexPattern is currently unsupported with ExtractSubstring");
-    }
-
     return ret;
 }
@@ -0,0 +1,262 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#include <pdfmm/private/PdfDeclarationsPrivate.h>
+#include "PdfParsedContents.h"
+
+#include "PdfCanvasInputDevice.h"
+#include "PdfOperatorUtils.h"
+
+using namespace std;
+using namespace mm;
+
+PdfParsedContents::PdfParsedContents(const PdfCanvas& canvas,
+    nullable<const PdfContentReaderArgs&> args)
+{
+    // NOTE: Read the contents from a device, so that
+    // the reader doesn't follow the XObjects
+    PdfContentsReader reader(std::make_shared<PdfCanvasInputDevice>(canvas), args);
+    parse(reader);
+}
+
+PdfParsedContents::PdfParsedContents(const shared_ptr<InputStreamDevice>& device,
+    nullable<const PdfContentReaderArgs&> args)
+{
+    PdfContentsReader reader(device, args);
+    parse(reader);
+}
+
+PdfParsedOperation PdfParsedContents::operator[](size_t index) const
+{
+    if (index >= m_operations.size())
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Index {} is out of range", index);
+
+    return PdfParsedOperation(*this, index);
+}
+
+PdfParsedContents::iterator PdfParsedContents::begin() const
+{
+    return iterator(*this, 0);
+}
+
+PdfParsedContents::iterator PdfParsedContents::end() const
+{
+    return iterator(*this, m_operations.size());
+}
+
+void PdfParsedContents::parse(PdfContentsReader& reader)
+{
+    PdfContent content;
+    while (reader.TryReadNext(content))
+    {
+        Operation operation{ };
+        operation.Type = content.Type;
+        operation.Warnings = content.Warnings;
+        operation.Operator = content.Operator;
+        operation.OperandCount = content.Stack.GetSize();
+        operation.FirstOperand = m_operands.size();
+        switch (content.Type)
+        {
+            case PdfContentType::ImageDictionary:
+            {
+                operation.DictionaryIndex = m_dictionaries.size();
+                m_dictionaries.push_back(std::move(content.InlineImageDictionary));
+                break;
+            }
+            case PdfContentType::ImageData:
+            {
+                operation.DataOffset = pushData(content.InlineImageData);
+                operation.DataSize = content.InlineImageData.size();
+                break;
+            }
+            case PdfContentType::UnexpectedKeyword:
+            {
+                operation.DataOffset = pushData(content.Keyword);
+                operation.DataSize = content.Keyword.size();
+                break;
+            }
+            default:
+            {
+                // Operators are not stored, the
+                // keyword is the operator name
+                break;
+            }
+        }
+
+        for (unsigned i = 0; i < operation.OperandCount; i++)
+        {
+            auto& variant = content.Stack[i];
+            Operand operand;
+            if (variant.IsNumber())
+            {
+                operand.Type = OperandType::Number;
+                operand.Number = variant.GetNumber();
+            }
+            else if (variant.IsRealStrict())
+            {
+                operand.Type = OperandType::Real;
+                operand.Real = variant.GetRealStrict();
+            }
+            else
+            {
+                operand.Type = OperandType::Variant;
+                operand.VariantIndex = m_variants.size();
+                m_variants.push_back(variant);
+            }
+
+            m_operands.push_back(operand);
+        }
+
+        m_operations.push_back(operation);
+    }
+}
+
+const PdfParsedContents::Operand& PdfParsedContents::getOperand(size_t operationIndex, unsigned index) const
+{
+    auto& operation = m_operations[operationIndex];
+    if (index >= operation.OperandCount)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Index {} is out of range", index);
+
+    return m_operands[operation.FirstOperand + index];
+}
+
+size_t PdfParsedContents::pushData(const bufferview& data)
+{
+    size_t ret = m_data.size();
+    m_data.append(data.data(), data.size());
+    return ret;
+}
+
+PdfParsedContents::iterator::iterator(const PdfParsedContents& contents, size_t index)
+    : m_contents(&contents), m_index(index) { }
+
+PdfParsedOperation PdfParsedContents::iterator::operator*() const
+{
+    return PdfParsedOperation(*m_contents, m_index);
+}
+
+PdfParsedContents::iterator& PdfParsedContents::iterator::operator++()
+{
+    m_index++;
+    return *this;
+}
+
+bool PdfParsedContents::iterator::operator==(const iterator& rhs) const
+{
+    return m_contents == rhs.m_contents && m_index == rhs.m_index;
+}
+
+bool PdfParsedContents::iterator::operator!=(const iterator& rhs) const
+{
+    return m_contents != rhs.m_contents || m_index != rhs.m_index;
+}
+
+PdfParsedOperation::PdfParsedOperation(const PdfParsedContents& contents, size_t index)
+    : m_contents(&contents), m_index(index) { }
+
+PdfContentType PdfParsedOperation::GetType() const
+{
+    return m_contents->m_operations[m_index].Type;
+}
+
+PdfContentWarnings PdfParsedOperation::GetWarnings() const
+{
+    return m_contents->m_operations[m_index].Warnings;
+}
+
+PdfOperator PdfParsedOperation::GetOperator() const
+{
+    return m_contents->m_operations[m_index].Operator;
+}
+
+string_view PdfParsedOperation::GetKeyword() const
+{
+    auto& operation = m_contents->m_operations[m_index];
+    switch (operation.Type)
+    {
+        case PdfContentType::Operator:
+            return mm::GetPdfOperatorName(operation.Operator);
+        case PdfContentType::UnexpectedKeyword:
+            return string_view(m_contents->m_data.data() + operation.DataOffset, operation.DataSize);
+        default:
+            return { };
+    }
+}
+
+unsigned PdfParsedOperation::GetOperandCount() const
+{
+    return m_contents->m_operations[m_index].OperandCount;
+}
+
+bool PdfParsedOperation::IsNumberOrReal(unsigned index) const
+{
+    auto& operand = m_contents->getOperand(m_index, index);
+    return operand.Type != PdfParsedContents::OperandType::Variant;
+}
+
+int64_t PdfParsedOperation::GetNumber(unsigned index) const
+{
+    auto& operand = m_contents->getOperand(m_index, index);
+    if (operand.Type != PdfParsedContents::OperandType::Number)
+        PDFMM_RAISE_ERROR(PdfErrorCode::InvalidDataType);
+
+    return operand.Number;
+}
+
+double PdfParsedOperation::GetReal(unsigned index) const
+{
+    auto& operand = m_contents->getOperand(m_index, index);
+    switch (operand.Type)
+    {
+        case PdfParsedContents::OperandType::Number:
+            return (double)operand.Number;
+        case PdfParsedContents::OperandType::Real:
+            return operand.Real;
+        default:
+            PDFMM_RAISE_ERROR(PdfErrorCode::InvalidDataType);
+    }
+}
+
+PdfVariant PdfParsedOperation::GetOperand(unsigned index) const
+{
+    auto& operand = m_contents->getOperand(m_index, index);
+    switch (operand.Type)
+    {
+        case PdfParsedContents::OperandType::Number:
+            return PdfVariant(operand.Number);
+        case PdfParsedContents::OperandType::Real:
+            return PdfVariant(operand.Real);
+        default:
+            return m_contents->m_variants[operand.VariantIndex];
+    }
+}
+
+const PdfVariant& PdfParsedOperation::GetVariant(unsigned index) const
+{
+    auto& operand = m_contents->getOperand(m_index, index);
+    if (operand.Type != PdfParsedContents::OperandType::Variant)
+        PDFMM_RAISE_ERROR(PdfErrorCode::InvalidDataType);
+
+    return m_contents->m_variants[operand.VariantIndex];
+}
+
+const PdfDictionary& PdfParsedOperation::GetInlineImageDictionary() const
+{
+    auto& operation = m_contents->m_operations[m_index];
+    if (operation.Type != PdfContentType::ImageDictionary)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The operation is not an inline image dictionary");
+
+    return m_contents->m_dictionaries[operation.DictionaryIndex];
+}
+
+bufferview PdfParsedOperation::GetInlineImageData() const
+{
+    auto& operation = m_contents->m_operations[m_index];
+    if (operation.Type != PdfContentType::ImageData)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The operation is not inline image data");
+
+    return bufferview(m_contents->m_data.data() + operation.DataOffset, operation.DataSize);
+}
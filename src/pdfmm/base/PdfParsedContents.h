@@ -0,0 +1,170 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ * SPDX-License-Identifier: MPL-2.0
+ */
+
+#ifndef PDF_PARSED_CONTENTS_H
+#define PDF_PARSED_CONTENTS_H
+
+#include "PdfContentsReader.h"
+
+namespace mm {
+
+class PdfParsedContents;
+
+/** An operation of a PdfParsedContents
+ *
+ * The operands are indexed as in PdfVariantStack, so the
+ * operand at index 0 is the last one before the operator
+ */
+class PDFMM_API PdfParsedOperation final
+{
+    friend class PdfParsedContents;
+
+private:
+    PdfParsedOperation(const PdfParsedContents& contents, size_t index);
+
+public:
+    /** The type of the content. Either Operator, ImageDictionary,
+     * ImageData or UnexpectedKeyword
+     */
+    PdfContentType GetType() const;
+
+    PdfContentWarnings GetWarnings() const;
+
+    PdfOperator GetOperator() const;
+
+    /** The keyword of the operator, or of the unexpected keyword
+     */
+    std::string_view GetKeyword() const;
+
+    unsigned GetOperandCount() const;
+
+    /** True if the operand is an integer or a real number
+     */
+    bool IsNumberOrReal(unsigned index) const;
+
+    /** Get the operand as an integer number
+     * \remarks throws if the operand is not an integer
+     */
+    int64_t GetNumber(unsigned index) const;
+
+    /** Get the operand as a real number
+     * \remarks throws if the operand is not a number
+     */
+    double GetReal(unsigned index) const;
+
+    /** Get a copy of the operand
+     */
+    PdfVariant GetOperand(unsigned index) const;
+
+    /** Get the operand, if it's not an integer or a real number
+     * \remarks throws if the operand is a number
+     */
+    const PdfVariant& GetVariant(unsigned index) const;
+
+    /** Get the dictionary of an inline image. Valid for ImageDictionary
+     */
+    const PdfDictionary& GetInlineImageDictionary() const;
+
+    /** Get the data of an inline image. Valid for ImageData
+     */
+    bufferview GetInlineImageData() const;
+
+private:
+    const PdfParsedContents* m_contents;
+    size_t m_index;
+};
+
+/** A compact representation of a content stream, that is parsed
+ * once and can be walked many times cheaply
+ *
+ * The operations are stored in a flat buffer, with the numeric operands
+ * stored inline. Other operands and the inline images are stored in
+ * side tables. XObjects are not followed
+ */
+class PDFMM_API PdfParsedContents final
+{
+    friend class PdfParsedOperation;
+
+public:
+    class PDFMM_API iterator final
+    {
+        friend class PdfParsedContents;
+    private:
+        iterator(const PdfParsedContents& contents, size_t index);
+    public:
+        PdfParsedOperation operator*() const;
+        iterator& operator++();
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+    private:
+        const PdfParsedContents* m_contents;
+        size_t m_index;
+    };
+
+public:
+    /** Parse the contents of the canvas
+     */
+    PdfParsedContents(const PdfCanvas& canvas, nullable<const PdfContentReaderArgs&> args = { });
+
+    /** Parse the contents from a device
+     */
+    PdfParsedContents(const std::shared_ptr<InputStreamDevice>& device, nullable<const PdfContentReaderArgs&> args = { });
+
+public:
+    size_t GetSize() const { return m_operations.size(); }
+
+    PdfParsedOperation operator[](size_t index) const;
+
+    iterator begin() const;
+    iterator end() const;
+
+private:
+    enum class OperandType : uint8_t
+    {
+        Number,
+        Real,
+        Variant,
+    };
+
+    struct Operand
+    {
+        OperandType Type;
+        union
+        {
+            int64_t Number;
+            double Real;
+            size_t VariantIndex;
+        };
+    };
+
+    struct Operation
+    {
+        PdfContentType Type;
+        PdfContentWarnings Warnings;
+        PdfOperator Operator;
+        unsigned OperandCount;
+        size_t FirstOperand;
+        size_t DataOffset;    ///< Offset of the keyword or of the inline image data
+        size_t DataSize;
+        size_t DictionaryIndex;
+    };
+
+private:
+    void parse(PdfContentsReader& reader);
+    const Operand& getOperand(size_t operationIndex, unsigned index) const;
+    size_t pushData(const bufferview& data);
+
+private:
+    std::vector<Operation> m_operations;
+    std::vector<Operand> m_operands;
+    std::vector<PdfVariant> m_variants;
+    std::vector<PdfDictionary> m_dictionaries;
+    charbuff m_data;
+};
+
+}
+
+#endif // PDF_PARSED_CONTENTS_H
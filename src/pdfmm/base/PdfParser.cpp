@@ -7,6 +7,11 @@
 #include <pdfmm/private/PdfDeclarationsPrivate.h>
 #include "PdfParser.h"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "PdfArena.h"
 #include "PdfArray.h"
 #include "PdfDictionary.h"
 #include "PdfEncrypt.h"
@@ -15,6 +20,7 @@
 #include "PdfObjectStreamParser.h"
 #include "PdfOutputDevice.h"
 #include "PdfObjectStream.h"
+#include "PdfStreamDevice.h"
 #include "PdfVariant.h"
 #include "PdfXRefStreamParserObject.h"
 
@@ -25,6 +31,8 @@ constexpr unsigned PDF_MAGIC_LENGHT = 8;
 constexpr unsigned PDF_XREF_ENTRY_SIZE = 20;
 constexpr unsigned PDF_XREF_BUF = 512;
 constexpr unsigned MAX_XREF_SESSION_COUNT = 512;
+// Number of objects each thread parses before fetching more work
+constexpr unsigned PARALLEL_LOAD_CHUNK_SIZE = 64;
 
 using namespace std;
 using namespace mm;
@@ -39,7 +47,8 @@ PdfParser::PdfParser(PdfIndirectObjectList& objects) :
     m_buffer(std::make_shared<charbuff>(PdfTokenizer::BufferSize)),
     m_tokenizer(m_buffer, true),
     m_Objects(&objects),
-    m_StrictParsing(false)
+    m_StrictParsing(false),
+    m_LoadThreadCount(1)
 {
     this->Reset();
 }
@@ -75,6 +84,9 @@ void PdfParser::Parse(InputStreamDevice& device, bool loadOnDemand)
 
     m_LoadOnDemand = loadOnDemand;
 
+    // Parsed objects are allocated in the arena of the list, if any
+    PdfArenaScope arenaScope(m_Objects->GetArena());
+
     try
     {
         if (!IsPdfFile(device))
@@ -672,6 +684,7 @@ void PdfParser::ReadObjectsInternal(InputStreamDevice& device)
     // Read objects
     vector<unsigned> compressedIndices;
     map<int64_t, vector<int64_t>> compressedObjects;
+    m_Objects->Reserve(m_entries.GetSize());
     for (unsigned i = 0; i < m_entries.GetSize(); i++)
     {
         auto& entry = m_entries[i];
@@ -778,20 +791,36 @@ void PdfParser::ReadObjectsInternal(InputStreamDevice& device)
         // robustly from all places which are either free or unparsed
     }
 
+    bufferview view;
+    if (!m_LoadOnDemand && m_Encrypt == nullptr && m_LoadThreadCount != 1
+        && device.TryGetBufferView(view))
+    {
+        vector<PdfParserObject*> objects;
+        objects.reserve(m_Objects->GetSize());
+        for (auto obj : *m_Objects)
+        {
+            auto parserObj = dynamic_cast<PdfParserObject*>(obj);
+            if (parserObj != nullptr && !parserObj->IsDelayedLoadDone())
+                objects.push_back(parserObj);
+        }
+
+        loadObjectsConcurrently(view, objects);
+    }
+
     // all normal objects including object streams are available now,
     // we can parse the object streams safely now.
     //
-    // Note that even if demand loading is enabled we still currently read all
-    // objects from the stream into memory then free the stream.
-    //
-    for (auto& pair : compressedObjects)
+    // If demand loading is enabled, compressed objects will
+    // be read from the object streams when they are accessed
+    if (compressedObjects.size() != 0)
     {
-#ifndef VERBOSE_DEBUG_DISABLED
-        if (m_LoadOnDemand)
-            cerr << "Demand loading on, but can't demand-load from object stream." << endl;
-#endif
-        ReadCompressedObjectFromStream((uint32_t)pair.first, pair.second);
-        m_Objects->AddObjectStream((uint32_t)pair.first);
+        auto objectStreamParser = std::make_shared<PdfObjectStreamParser>(*m_Objects);
+        m_Objects->AddObjectStreamParser(objectStreamParser);
+        for (auto& pair : compressedObjects)
+        {
+            ReadCompressedObjectFromStream(objectStreamParser, (uint32_t)pair.first, pair.second);
+            m_Objects->AddObjectStream((uint32_t)pair.first);
+        }
     }
 
     if (!m_LoadOnDemand)
@@ -802,15 +831,102 @@ void PdfParser::ReadObjectsInternal(InputStreamDevice& device)
         // in a second pass, or (if demand loading is enabled) defer it for later.
         for (auto objToLoad : *m_Objects)
         {
+            // NOTE: Objects read from object streams have no stream
             auto obj = dynamic_cast<PdfParserObject*>(objToLoad);
-            obj->ParseStream();
+            if (obj != nullptr)
+                obj->ParseStream();
         }
     }
 
     UpdateDocumentVersion();
 }
 
-void PdfParser::ReadCompressedObjectFromStream(uint32_t objNo, const cspan<int64_t>& objectList)
+void PdfParser::loadObjectsConcurrently(const bufferview& view, const vector<PdfParserObject*>& objects)
+{
+    unsigned threadCount = m_LoadThreadCount;
+    if (threadCount == 0)
+        threadCount = std::max(1u, thread::hardware_concurrency());
+
+    threadCount = std::min(threadCount,
+        (unsigned)((objects.size() + PARALLEL_LOAD_CHUNK_SIZE - 1) / PARALLEL_LOAD_CHUNK_SIZE));
+    if (threadCount < 2)
+        return;
+
+    atomic<size_t> nextIndex(0);
+    atomic<bool> stop(false);
+    exception_ptr exception;
+    mutex exceptionMutex;
+    auto arena = m_Objects->GetArena();
+    auto loadObjects = [&]()
+    {
+        PdfArenaScope arenaScope(arena);
+        SpanStreamDevice device(view);
+        try
+        {
+            while (!stop)
+            {
+                size_t index = nextIndex.fetch_add(PARALLEL_LOAD_CHUNK_SIZE);
+                if (index >= objects.size())
+                    break;
+
+                size_t end = std::min(index + PARALLEL_LOAD_CHUNK_SIZE, objects.size());
+                for (; index < end; index++)
+                {
+                    auto obj = objects[index];
+                    try
+                    {
+                        obj->ParseFrom(device);
+                    }
+                    catch (PdfError& e)
+                    {
+                        PDFMM_PUSH_FRAME_INFO(e, "Error while loading object {} {} R, Offset={}",
+                            obj->GetIndirectReference().ObjectNumber(),
+                            obj->GetIndirectReference().GenerationNumber(),
+                            obj->GetOffset());
+                        throw;
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            // Keep only the first error, it will be
+            // rethrown when all the threads are done
+            lock_guard<mutex> lock(exceptionMutex);
+            if (exception == nullptr)
+                exception = std::current_exception();
+
+            stop = true;
+        }
+    };
+
+    // The calling thread performs loading as well
+    vector<thread> threads;
+    threads.reserve(threadCount - 1);
+    try
+    {
+        for (unsigned i = 1; i < threadCount; i++)
+            threads.emplace_back(loadObjects);
+    }
+    catch (...)
+    {
+        stop = true;
+        for (auto& thread : threads)
+            thread.join();
+
+        throw;
+    }
+
+    loadObjects();
+    for (auto& thread : threads)
+        thread.join();
+
+    if (exception != nullptr)
+        std::rethrow_exception(exception);
+}
+
+void PdfParser::ReadCompressedObjectFromStream(const shared_ptr<PdfObjectStreamParser>& objectStreamParser,
+    uint32_t objNo, const cspan<int64_t>& objectList)
 {
     // generation number of object streams is always 0
     auto streamObj = dynamic_cast<PdfParserObject*>(m_Objects->GetObject(PdfReference(objNo, 0)));
@@ -827,8 +943,27 @@ void PdfParser::ReadCompressedObjectFromStream(uint32_t objNo, const cspan<int64
         }
     }
 
-    PdfObjectStreamParser parserObject(*streamObj, *m_Objects, m_buffer);
-    parserObject.Parse(objectList);
+    for (int64_t compressedObjNo : objectList)
+    {
+        // The generation number of an object stream and of any
+        // compressed object is implicitly zero
+        PdfReference reference(static_cast<uint32_t>(compressedObjNo), 0);
+        unsigned index = m_entries[reference.ObjectNumber()].Index;
+        if (m_LoadOnDemand)
+        {
+            m_Objects->PushObject(new PdfCompressedObject(reference, objectStreamParser, objNo, index));
+        }
+        else
+        {
+            PdfVariant var;
+            if (!objectStreamParser->TryReadObject(objNo, index, reference.ObjectNumber(), var))
+                continue;
+
+            auto obj = new PdfObject(std::move(var));
+            obj->SetIndirectReference(reference);
+            m_Objects->PushObject(obj);
+        }
+    }
 }
 
 void PdfParser::FindTokenBackward(InputStreamDevice& device, const char* token, size_t range)
@@ -900,7 +1035,12 @@ void PdfParser::UpdateDocumentVersion()
 {
     if (m_Trailer->IsDictionary() && m_Trailer->GetDictionary().HasKey("Root"))
     {
-        auto catalog = m_Trailer->GetDictionary().FindKey("Root");
+        // NOTE: Resolve the reference in the parsed objects, as
+        // the list may not be part of any document
+        auto catalog = &m_Trailer->GetDictionary().MustGetKey("Root");
+        if (catalog->IsReference())
+            catalog = m_Objects->GetObject(catalog->GetReference());
+
         if (catalog != nullptr
             && catalog->IsDictionary()
             && catalog->GetDictionary().HasKey("Version"))
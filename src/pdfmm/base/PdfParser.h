@@ -18,6 +18,7 @@ namespace mm {
 class PdfEncrypt;
 class PdfString;
 class PdfParserObject;
+class PdfObjectStreamParser;
 
 /**
  * PdfParser reads a PDF file into memory.
@@ -176,6 +177,28 @@ public:
      */
     inline void SetIgnoreBrokenObjects(bool broken) { m_IgnoreBrokenObjects = broken; }
 
+    /**
+     * \returns the number of threads used to read objects
+     *
+     * \see SetLoadThreadCount
+     */
+    inline unsigned GetLoadThreadCount() const { return m_LoadThreadCount; }
+
+    /**
+     * Set the number of threads used to read objects when the
+     * document is not loaded on demand. 0 means the number of
+     * hardware threads available. Default is 1, which means
+     * objects are read serially.
+     *
+     * Concurrent loading is only performed on unencrypted documents
+     * read from devices backed by contiguous memory, such as
+     * MappedFileStreamDevice or SpanStreamDevice, otherwise
+     * objects are read serially.
+     *
+     * \param threadCount number of threads to use
+     */
+    inline void SetLoadThreadCount(unsigned threadCount) { m_LoadThreadCount = threadCount; }
+
     inline size_t GetXRefOffset() const { return m_XRefOffset; }
 
     inline bool HasXRefStream() const { return m_HasXRefStream; }
@@ -272,18 +295,26 @@ private:
      */
     void ReadObjectsInternal(InputStreamDevice& device);
 
-    /** Read the object with index from the object stream nObjNo
-     *  and push it on the objects vector
+    /** Parse the given objects concurrently, each thread reading
+     *  with its own cursor on the device contiguous memory
+     *
+     *  The first error raised while parsing an object is
+     *  rethrown when all the threads have finished
+     */
+    void loadObjectsConcurrently(const bufferview& view, const std::vector<PdfParserObject*>& objects);
+
+    /** Read the objects with the given numbers from the object stream objNo
+     *  and push them on the objects vector
      *
-     *  All objects are read from this stream and the stream object
-     *  is free'd from memory. Further calls who try to read from the
-     *  same stream simply do nothing.
+     *  If demand loading is enabled the objects are pushed unloaded
+     *  and they are read from the object stream only when accessed
      *
+     *  \param objectStreamParser the parser used to read all object streams
      *  \param objNo object number of the stream object
-     *  \param index index of the object which should be parsed
-     *
+     *  \param objectList numbers of the objects which should be read
      */
-    void ReadCompressedObjectFromStream(uint32_t objNo, const cspan<int64_t>& objectList);
+    void ReadCompressedObjectFromStream(const std::shared_ptr<PdfObjectStreamParser>& objectStreamParser,
+        uint32_t objNo, const cspan<int64_t>& objectList);
 
     /** Checks the magic number at the start of the pdf file
      *  and sets the m_PdfVersion member to the correct version
@@ -349,6 +380,7 @@ private:
 
     bool m_StrictParsing;
     bool m_IgnoreBrokenObjects;
+    unsigned m_LoadThreadCount;
 
     unsigned m_IncrementalUpdateCount;
 
@@ -15,6 +15,7 @@
 #include "PdfInputStream.h"
 #include "PdfParser.h"
 #include "PdfObjectStream.h"
+#include "PdfStreamDevice.h"
 #include "PdfVariant.h"
 
 using namespace mm;
@@ -70,12 +71,15 @@ void PdfParserObject::ParseStream()
 
 void PdfParserObject::DelayedLoadImpl()
 {
-    PdfTokenizer tokenizer;
-    m_device->Seek(m_Offset);
-    if (!m_IsTrailer)
-        checkReference(tokenizer);
+    readFromDevice([this]()
+    {
+        PdfTokenizer tokenizer;
+        m_device->Seek(m_Offset);
+        if (!m_IsTrailer)
+            checkReference(tokenizer);
 
-    Parse(tokenizer);
+        Parse(tokenizer);
+    });
 }
 
 void PdfParserObject::DelayedLoadStreamImpl()
@@ -99,6 +103,59 @@ void PdfParserObject::DelayedLoadStreamImpl()
     }
 }
 
+void PdfParserObject::ParseFrom(InputStreamDevice& device)
+{
+    auto prevDevice = m_device;
+    m_device = &device;
+    try
+    {
+        DelayedLoad();
+    }
+    catch (...)
+    {
+        m_device = prevDevice;
+        throw;
+    }
+
+    m_device = prevDevice;
+}
+
+void PdfParserObject::readFromDevice(const function<void()>& read)
+{
+    auto document = GetDocument();
+    if (document == nullptr || !document->IsFrozen())
+    {
+        read();
+        return;
+    }
+
+    // Objects of frozen documents may be loaded by multiple threads
+    // at the same time: read from a separate device on the buffer of
+    // the source device if possible, so the position is not shared
+    bufferview view;
+    if (!m_device->TryGetBufferView(view))
+    {
+        lock_guard<mutex> lock(document->m_deviceMutex);
+        read();
+        return;
+    }
+
+    SpanStreamDevice device(view);
+    auto prevDevice = m_device;
+    m_device = &device;
+    try
+    {
+        read();
+    }
+    catch (...)
+    {
+        m_device = prevDevice;
+        throw;
+    }
+
+    m_device = prevDevice;
+}
+
 PdfReference PdfParserObject::ReadReference(PdfTokenizer& tokenizer)
 {
     m_device->Seek(m_Offset);
@@ -163,12 +220,38 @@ void PdfParserObject::parseStream()
     PDFMM_ASSERT(IsDelayedLoadDone());
 
     int64_t size = -1;
-    char ch;
-
     auto& lengthObj = this->m_Variant.GetDictionary().MustFindKey(PdfName::KeyLength);
     if (!lengthObj.TryGetNumber(size))
         PDFMM_RAISE_ERROR(PdfErrorCode::InvalidStreamLength);
 
+    if (m_Encrypt != nullptr && !m_Encrypt->IsMetadataEncrypted())
+    {
+        // If metadata is not encrypted the Filter is set to "Crypt"
+        auto filterObj = this->m_Variant.GetDictionary().FindKey(PdfName::KeyFilter);
+        if (filterObj != nullptr && filterObj->IsArray())
+        {
+            auto& filters = filterObj->GetArray();
+            for (unsigned i = 0; i < filters.GetSize(); i++)
+            {
+                auto& obj = filters.MustFindAt(i);
+                if (obj.IsName() && obj.GetName() == "Crypt")
+                    m_Encrypt = nullptr;
+            }
+        }
+    }
+
+    // Look up the keys before reading the stream: they may be
+    // references to other objects, that are loaded from the device
+    auto filters = PdfFilterFactory::CreateFilterList(*this);
+    readFromDevice([&]()
+    {
+        readStream((size_t)size, std::move(filters));
+    });
+}
+
+void PdfParserObject::readStream(size_t size, PdfFilterList&& filters)
+{
+    char ch;
     m_device->Seek(m_StreamOffset);
 
     size_t streamOffset;
@@ -216,31 +299,16 @@ void PdfParserObject::parseStream()
 
 ReadStream:
     m_device->Seek(streamOffset);	// reset it before reading!
-    if (m_Encrypt != nullptr && !m_Encrypt->IsMetadataEncrypted())
-    {
-        // If metadata is not encrypted the Filter is set to "Crypt"
-        auto filterObj = this->m_Variant.GetDictionary().FindKey(PdfName::KeyFilter);
-        if (filterObj != nullptr && filterObj->IsArray())
-        {
-            auto& filters = filterObj->GetArray();
-            for (unsigned i = 0; i < filters.GetSize(); i++)
-            {
-                auto& obj = filters.MustFindAt(i);
-                if (obj.IsName() && obj.GetName() == "Crypt")
-                    m_Encrypt = nullptr;
-            }
-        }
-    }
 
     // Set stream raw data without marking the object dirty
     if (m_Encrypt != nullptr)
     {
-        auto input = m_Encrypt->CreateEncryptionInputStream(*m_device, static_cast<size_t>(size), GetIndirectReference());
-        getOrCreateStream().InitData(*input, static_cast<ssize_t>(size), PdfFilterFactory::CreateFilterList(*this));
+        auto input = m_Encrypt->CreateEncryptionInputStream(*m_device, size, GetIndirectReference());
+        getOrCreateStream().InitData(*input, size, std::move(filters));
     }
     else
     {
-        getOrCreateStream().InitData(*m_device, static_cast<ssize_t>(size), PdfFilterFactory::CreateFilterList(*this));
+        getOrCreateStream().InitData(*m_device, size, std::move(filters));
     }
 }
 
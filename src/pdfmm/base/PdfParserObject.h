@@ -94,6 +94,12 @@ protected:
     PdfReference ReadReference(PdfTokenizer& tokenizer);
     void Parse(PdfTokenizer& tokenizer);
 
+    /** Load the object reading from the given device, instead of
+     *  the source device. The device must have the same content of
+     *  the source device. Used to load different objects concurrently
+     */
+    void ParseFrom(InputStreamDevice& device);
+
 private:
     PdfParserObject(const PdfParserObject&) = delete;
     PdfParserObject& operator=(const PdfParserObject&) = delete;
@@ -105,6 +111,13 @@ private:
      *  Called from DelayedLoadStream(). Do not call directly.
      */
     void parseStream();
+    void readStream(size_t size, PdfFilterList&& filters);
+
+    /** Perform the reads from the source device needed by a load.
+     *  Loads of documents with concurrent read access read at
+     *  independent positions, if the device allows it
+     */
+    void readFromDevice(const std::function<void()>& read);
 
     PdfReference readReference(PdfTokenizer& tokenizer);
 
@@ -9,23 +9,154 @@
 #include "PdfDictionary.h"
 #include "PdfStreamDevice.h"
 
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 using namespace std;
 using namespace mm;
 
 constexpr const char* ByteRangeBeacon = "[ 0 1234567890 1234567890 1234567890]";
 constexpr size_t BufferSize = 65536;
+constexpr size_t BatchChunkSize = 1048576;
+constexpr size_t BatchMaxPendingChunks = 8;
+
+namespace
+{
+    /** An output stream that feeds a signer with the data written
+     */
+    class SignerStream final : public OutputStream
+    {
+    public:
+        SignerStream(PdfSigner& signer)
+            : m_signer(&signer) { }
+
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override
+        {
+            m_signer->AppendData({ buffer, size });
+        }
+
+    private:
+        PdfSigner* m_signer;
+    };
+
+    /** An output stream that feeds more signers with the data
+     * written. The data is hashed by worker threads, each one
+     * handling a subset of the signers
+     */
+    class BatchSignerStream final : public OutputStream
+    {
+    public:
+        BatchSignerStream(const vector<PdfSigner*>& signers);
+        ~BatchSignerStream();
+
+    public:
+        /** Wait for all the data to be hashed, then compute the signatures
+         */
+        void ComputeSignatures(vector<charbuff>& signatures);
+
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override;
+
+    private:
+        void pushChunk();
+        void work(unsigned index);
+        void stop();
+
+    private:
+        const vector<PdfSigner*>* m_signers;
+        vector<charbuff> m_signatures;
+        charbuff m_chunk;
+        deque<shared_ptr<const charbuff>> m_chunks;
+        size_t m_firstChunk;
+        size_t m_chunkCount;
+        vector<size_t> m_progress;
+        bool m_finished;
+        bool m_stop;
+        exception_ptr m_exception;
+        mutex m_mutex;
+        condition_variable m_chunkAvailable;
+        condition_variable m_chunkDone;
+        vector<thread> m_threads;
+    };
+
+    /** An output device that feeds the signers with the data while
+     * it's written to the outputs. The data starting from the first
+     * signature beacon is held back, since it can be hashed only
+     * after the /ByteRange is known at the end of the writing
+     */
+    class SigningOutputDevice final : public OutputStreamDevice
+    {
+    public:
+        SigningOutputDevice(const vector<OutputStreamDevice*>& outputs, OutputStream& hash,
+            const PdfSignatureBeacons& beacons, size_t position);
+
+    public:
+        /** Patch the /ByteRange and hash the held back data
+         */
+        void FinishUpdate();
+
+        /** Write the held back data to the output with the given signature
+         */
+        void WriteSigned(OutputStream& output, charbuff& signatureBuf, size_t beaconSize);
+
+        size_t GetLength() const override { return m_position; }
 
-static size_t readForSignature(StreamDevice& device,
-    size_t conentsBeaconOffset, size_t conentsBeaconSize,
-    char* buffer, size_t size);
-static void adjustByteRange(StreamDevice& device, size_t byteRangeOffset,
-    size_t conentsBeaconOffset, size_t conentsBeaconSize, charbuff& buffer);
-static void setSignature(StreamDevice& device, const string_view& sigData,
-    size_t conentsBeaconOffset, charbuff& buffer);
+        size_t GetPosition() const override { return m_position; }
+
+        bool CanSeek() const override { return true; }
+
+        bool Eof() const override { return true; }
+
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override;
+        void flush() override;
+        void seek(ssize_t offset, SeekDirection direction) override;
+
+    private:
+        const vector<OutputStreamDevice*>* m_outputs;
+        OutputStream* m_hash;
+        const PdfSignatureBeacons* m_beacons;
+        size_t m_position;
+        size_t m_tailOffset;
+        charbuff m_tail;
+        charbuff m_buffer;
+    };
+}
+
+static size_t hashInput(InputStreamDevice& input, const vector<OutputStreamDevice*>& outputs, OutputStream& hash);
+static void signDocument(PdfMemDocument& doc, InputStreamDevice& input, OutputStreamDevice& output,
+    bool copyInput, PdfSigner& signer, PdfSignature& signature, PdfSaveOptions opts);
+static void prepareDocument(PdfMemDocument& doc, PdfSignature& signature, const PdfSigner& signer,
+    size_t beaconSize, PdfSignatureBeacons& beacons);
+static void writeByteRange(OutputStreamDevice& device, size_t conentsBeaconOffset,
+    size_t conentsBeaconSize, size_t fileEnd, charbuff& buffer);
+static void setSignature(OutputStreamDevice& device, const string_view& sigData, charbuff& buffer);
 static void prepareBeaconsData(size_t signatureSize, string& contentsBeacon, string& byteRangeBeacon);
 
+PdfSigner::PdfSigner() { }
+
 PdfSigner::~PdfSigner() { }
 
+size_t PdfSigner::GetSignatureSize()
+{
+    if (!m_signatureSize.has_value())
+    {
+        charbuff buffer;
+        ComputeSignature(buffer, true);
+        m_signatureSize = buffer.size();
+    }
+
+    return *m_signatureSize;
+}
+
+void PdfSigner::SetSignatureSize(size_t size)
+{
+    m_signatureSize = size;
+}
+
 string PdfSigner::GetSignatureFilter() const
 {
     // Default value
@@ -35,10 +166,102 @@ string PdfSigner::GetSignatureFilter() const
 void mm::SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner& signer,
     PdfSignature& signature, PdfSaveOptions opts)
 {
-    charbuff signatureBuf;
-    signer.ComputeSignature(signatureBuf, true);
-    size_t beaconSize = signatureBuf.size();
+    // The existing data is read once, the update
+    // is hashed while it's appended to the device
+    signDocument(doc, device, device, false, signer, signature, opts);
+}
+
+void mm::SignDocument(PdfMemDocument& doc, InputStreamDevice& input, OutputStreamDevice& output,
+    PdfSigner& signer, PdfSignature& signature, PdfSaveOptions opts)
+{
+    signDocument(doc, input, output, true, signer, signature, opts);
+}
+
+void mm::SignDocumentBatch(PdfMemDocument& doc, InputStreamDevice& input,
+    const vector<PdfSigner*>& signers, const vector<OutputStreamDevice*>& outputs,
+    PdfSignature& signature, PdfSaveOptions opts)
+{
+    if (signers.size() != outputs.size())
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "The count of signers and outputs must match");
+
+    if (signers.empty())
+        return;
+
+    // The update is shared by all the signed copies, so the
+    // signature dictionary must be the same for all the signers
+    // and the /Contents beacon must fit the biggest signature
+    auto& first = *signers[0];
+    string filter = first.GetSignatureFilter();
+    string subFilter = first.GetSignatureSubFilter();
+    string type = first.GetSignatureType();
+    size_t beaconSize = 0;
+    for (auto signer : signers)
+    {
+        if (signer->GetSignatureFilter() != filter
+            || signer->GetSignatureSubFilter() != subFilter
+            || signer->GetSignatureType() != type)
+        {
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "The signers must produce the same signature dictionary");
+        }
+
+        beaconSize = std::max(beaconSize, signer->GetSignatureSize());
+        signer->Reset();
+    }
+
+    BatchSignerStream hash(signers);
+    if (input.CanSeek())
+        input.Seek(0);
+
+    size_t position = hashInput(input, outputs, hash);
+
+    PdfSignatureBeacons beacons;
+    prepareDocument(doc, signature, first, beaconSize, beacons);
+    SigningOutputDevice device(outputs, hash, beacons, position);
+    doc.SaveUpdate(device, opts);
+    device.FinishUpdate();
+
+    vector<charbuff> signatures;
+    hash.ComputeSignatures(signatures);
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+        device.WriteSigned(*outputs[i], signatures[i], beaconSize);
+        outputs[i]->Flush();
+    }
+}
+
+void signDocument(PdfMemDocument& doc, InputStreamDevice& input, OutputStreamDevice& output,
+    bool copyInput, PdfSigner& signer, PdfSignature& signature, PdfSaveOptions opts)
+{
+    size_t beaconSize = signer.GetSignatureSize();
+    signer.Reset();
+    SignerStream hash(signer);
+    if (input.CanSeek())
+        input.Seek(0);
+
+    vector<OutputStreamDevice*> outputs = { &output };
+    size_t position = hashInput(input, copyInput ? outputs : vector<OutputStreamDevice*>(), hash);
+
+    // Reading the input to the end may have set the end of file state of
+    // the device, when signing in place. Seeking to the end clears it, and
+    // it also allows switching from reading to writing on file streams
+    if (output.CanSeek())
+        output.Seek(0, SeekDirection::End);
+
     PdfSignatureBeacons beacons;
+    prepareDocument(doc, signature, signer, beaconSize, beacons);
+    SigningOutputDevice device(outputs, hash, beacons, position);
+    doc.SaveUpdate(device, opts);
+    device.FinishUpdate();
+
+    charbuff signatureBuf;
+    signer.ComputeSignature(signatureBuf, false);
+    device.WriteSigned(output, signatureBuf, beaconSize);
+    output.Flush();
+}
+
+void prepareDocument(PdfMemDocument& doc, PdfSignature& signature, const PdfSigner& signer,
+    size_t beaconSize, PdfSignatureBeacons& beacons)
+{
     prepareBeaconsData(beaconSize, beacons.ContentsBeacon, beacons.ByteRangeBeacon);
     signature.PrepareForSigning(signer.GetSignatureFilter(), signer.GetSignatureSubFilter(),
         signer.GetSignatureType(), beacons);
@@ -56,27 +279,204 @@ void mm::SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner& sign
         // remore the key just in case it's present (defaults to false)
         acroForm->GetDictionary().RemoveKey("NeedAppearances");
     }
+}
 
-    doc.SaveUpdate(device, opts);
-    device.Flush();
+// Hash all the remaining input, copying it to the given
+// outputs. Return the size of the data read
+size_t hashInput(InputStreamDevice& input, const vector<OutputStreamDevice*>& outputs, OutputStream& hash)
+{
+    charbuff buffer(BufferSize);
+    size_t ret = 0;
+    bool eof;
+    do
+    {
+        size_t readBytes = input.Read(buffer.data(), BufferSize, eof);
+        if (readBytes == 0)
+            continue;
 
-    charbuff buffer;
-    adjustByteRange(device, *beacons.ByteRangeOffset, *beacons.ContentsOffset,
-        beacons.ContentsBeacon.size(), buffer);
-    device.Flush();
+        hash.Write(buffer.data(), readBytes);
+        for (auto output : outputs)
+            output->Write(buffer.data(), readBytes);
+
+        ret += readBytes;
+    } while (!eof);
+
+    return ret;
+}
+
+BatchSignerStream::BatchSignerStream(const vector<PdfSigner*>& signers) :
+    m_signers(&signers),
+    m_signatures(signers.size()),
+    m_firstChunk(0),
+    m_chunkCount(0),
+    m_finished(false),
+    m_stop(false)
+{
+    unsigned threadCount = (unsigned)std::min((size_t)std::max(1u, thread::hardware_concurrency()), signers.size());
+    m_progress.resize(threadCount);
+    m_threads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++)
+        m_threads.push_back(thread(&BatchSignerStream::work, this, i));
+}
+
+BatchSignerStream::~BatchSignerStream()
+{
+    stop();
+}
+
+void BatchSignerStream::ComputeSignatures(vector<charbuff>& signatures)
+{
+    if (m_chunk.size() != 0)
+        pushChunk();
 
-    // Read data from the device to prepare the signature
-    signer.Reset();
-    device.Seek(0);
-    size_t readBytes;
-    buffer.resize(BufferSize);
-    while ((readBytes = readForSignature(device, *beacons.ContentsOffset, beacons.ContentsBeacon.size(),
-        buffer.data(), BufferSize)) != 0)
     {
-        signer.AppendData({ buffer.data(), readBytes });
+        unique_lock<mutex> lock(m_mutex);
+        m_finished = true;
     }
 
-    signer.ComputeSignature(signatureBuf, false);
+    m_chunkAvailable.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+
+    m_threads.clear();
+    if (m_exception != nullptr)
+        std::rethrow_exception(m_exception);
+
+    signatures = std::move(m_signatures);
+}
+
+void BatchSignerStream::writeBuffer(const char* buffer, size_t size)
+{
+    m_chunk.append(buffer, size);
+    if (m_chunk.size() >= BatchChunkSize)
+        pushChunk();
+}
+
+void BatchSignerStream::pushChunk()
+{
+    {
+        // Limit the data waiting to be hashed by the slowest worker
+        unique_lock<mutex> lock(m_mutex);
+        m_chunkDone.wait(lock, [&] {
+            return m_chunkCount - m_firstChunk < BatchMaxPendingChunks || m_exception != nullptr;
+        });
+
+        if (m_exception != nullptr)
+            std::rethrow_exception(m_exception);
+
+        m_chunks.push_back(std::make_shared<const charbuff>(std::move(m_chunk)));
+        m_chunkCount++;
+    }
+
+    m_chunk = charbuff();
+    m_chunkAvailable.notify_all();
+}
+
+void BatchSignerStream::work(unsigned index)
+{
+    auto& signers = *m_signers;
+    size_t threadCount = m_progress.size();
+    try
+    {
+        size_t next = 0;
+        while (true)
+        {
+            shared_ptr<const charbuff> chunk;
+            {
+                unique_lock<mutex> lock(m_mutex);
+                m_chunkAvailable.wait(lock, [&] {
+                    return next < m_chunkCount || m_finished || m_stop;
+                });
+
+                if (m_stop)
+                    return;
+
+                if (next == m_chunkCount)
+                    break;
+
+                chunk = m_chunks[next - m_firstChunk];
+            }
+
+            for (size_t i = index; i < signers.size(); i += threadCount)
+                signers[i]->AppendData(*chunk);
+
+            {
+                // Release the chunks hashed by all the workers
+                unique_lock<mutex> lock(m_mutex);
+                next++;
+                m_progress[index] = next;
+                size_t hashedCount = *std::min_element(m_progress.begin(), m_progress.end());
+                while (m_firstChunk < hashedCount)
+                {
+                    m_chunks.pop_front();
+                    m_firstChunk++;
+                }
+            }
+
+            m_chunkDone.notify_one();
+        }
+
+        for (size_t i = index; i < signers.size(); i += threadCount)
+            signers[i]->ComputeSignature(m_signatures[i], false);
+    }
+    catch (...)
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            if (m_exception == nullptr)
+                m_exception = std::current_exception();
+
+            m_stop = true;
+        }
+
+        m_chunkAvailable.notify_all();
+        m_chunkDone.notify_all();
+    }
+}
+
+void BatchSignerStream::stop()
+{
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_chunkAvailable.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+
+    m_threads.clear();
+}
+
+SigningOutputDevice::SigningOutputDevice(const vector<OutputStreamDevice*>& outputs, OutputStream& hash,
+        const PdfSignatureBeacons& beacons, size_t position) :
+    m_outputs(&outputs),
+    m_hash(&hash),
+    m_beacons(&beacons),
+    m_position(position),
+    m_tailOffset(numeric_limits<size_t>::max())
+{
+}
+
+void SigningOutputDevice::FinishUpdate()
+{
+    if (m_tailOffset == numeric_limits<size_t>::max())
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The signature beacons were not written");
+
+    size_t contentsOffset = *m_beacons->ContentsOffset - m_tailOffset;
+    size_t contentsSize = m_beacons->ContentsBeacon.size();
+    ContainerStreamDevice<charbuff> tail(m_tail, DeviceAccess::Write, false);
+    tail.Seek(*m_beacons->ByteRangeOffset - m_tailOffset);
+    writeByteRange(tail, *m_beacons->ContentsOffset, contentsSize, m_position, m_buffer);
+
+    // Hash the held back data, skipping the /Contents beacon
+    m_hash->Write(m_tail.data(), contentsOffset);
+    m_hash->Write(m_tail.data() + contentsOffset + contentsSize,
+        m_tail.size() - contentsOffset - contentsSize);
+}
+
+void SigningOutputDevice::WriteSigned(OutputStream& output, charbuff& signatureBuf, size_t beaconSize)
+{
     if (signatureBuf.size() > beaconSize)
         throw runtime_error("Actual signature size bigger than beacon size");
 
@@ -84,70 +484,67 @@ void mm::SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner& sign
     // beacon size previously cached to fill all
     // available reserved space for the /Contents
     signatureBuf.resize(beaconSize);
-    setSignature(device, signatureBuf, *beacons.ContentsOffset, buffer);
-    device.Flush();
+    ContainerStreamDevice<charbuff> tail(m_tail, DeviceAccess::Write, false);
+    tail.Seek(*m_beacons->ContentsOffset - m_tailOffset);
+    setSignature(tail, signatureBuf, m_buffer);
+
+    output.Write(m_tail.data(), m_tail.size());
 }
 
-size_t readForSignature(StreamDevice& device, size_t conentsBeaconOffset, size_t conentsBeaconSize,
-    char* buffer, size_t bufferSize)
+void SigningOutputDevice::writeBuffer(const char* buffer, size_t size)
 {
-    if (device.Eof())
-        return 0;
-
-    size_t pos = device.GetPosition();
-    size_t readSize = 0;
-    // Check if we are before beacon
-    if (pos < conentsBeaconOffset)
+    if (m_tailOffset == numeric_limits<size_t>::max())
     {
-        readSize = std::min(bufferSize, conentsBeaconOffset - pos);
-        if (readSize > 0)
+        // The beacons are set just before they are written
+        if (*m_beacons->ContentsOffset == m_position
+            || *m_beacons->ByteRangeOffset == m_position)
         {
-            device.Read(buffer, readSize);
-            buffer += readSize;
-            bufferSize -= readSize;
-            if (bufferSize == 0)
-                return readSize;
+            m_tailOffset = m_position;
         }
-    }
+        else
+        {
+            m_hash->Write(buffer, size);
+            for (auto output : *m_outputs)
+                output->Write(buffer, size);
 
-    // shift at the end of beacon
-    if ((pos + readSize) >= conentsBeaconOffset
-        && pos < (conentsBeaconOffset + conentsBeaconSize))
-    {
-        device.Seek(conentsBeaconOffset + conentsBeaconSize);
+            m_position += size;
+            return;
+        }
     }
 
-    // read after beacon
-    bufferSize = std::min(bufferSize, device.GetLength() - device.GetPosition());
-    if (bufferSize == 0)
-        return readSize;
+    m_tail.append(buffer, size);
+    m_position += size;
+}
 
-    device.Read(buffer, bufferSize);
-    return readSize + bufferSize;
+void SigningOutputDevice::flush()
+{
+    for (auto output : *m_outputs)
+        output->Flush();
 }
 
-void adjustByteRange(StreamDevice& device, size_t byteRangeOffset,
-    size_t conentsBeaconOffset, size_t conentsBeaconSize, charbuff& buffer)
+void SigningOutputDevice::seek(ssize_t offset, SeekDirection direction)
+{
+    // The data is written sequentially, only seeking
+    // to the current position is supported
+    if ((direction == SeekDirection::Begin ? (size_t)offset : m_position + offset) != m_position)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "The signing device can't seek back");
+}
+
+void writeByteRange(OutputStreamDevice& device, size_t conentsBeaconOffset,
+    size_t conentsBeaconSize, size_t fileEnd, charbuff& buffer)
 {
-    // Get final position
-    size_t fileEnd = device.GetLength();
     PdfArray arr;
     arr.Add(PdfObject(static_cast<int64_t>(0)));
     arr.Add(PdfObject(static_cast<int64_t>(conentsBeaconOffset)));
     arr.Add(PdfObject(static_cast<int64_t>(conentsBeaconOffset + conentsBeaconSize)));
     arr.Add(PdfObject(static_cast<int64_t>(fileEnd - (conentsBeaconOffset + conentsBeaconSize))));
-
-    device.Seek(byteRangeOffset);
     arr.Write(device, PdfWriteFlags::None, { }, buffer);
 }
 
-void setSignature(StreamDevice& device, const string_view& contentsData,
-    size_t conentsBeaconOffset, charbuff& buffer)
+void setSignature(OutputStreamDevice& device, const string_view& contentsData, charbuff& buffer)
 {
     auto sig = PdfString::FromRaw(contentsData);
 
-    // Position at contents beacon after '<'
-    device.Seek(conentsBeaconOffset);
     // Write the beacon data
     sig.Write(device, PdfWriteFlags::None, { }, buffer);
 }
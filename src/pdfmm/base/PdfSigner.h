@@ -15,9 +15,14 @@
 namespace mm
 {
     class StreamDevice;
+    class InputStreamDevice;
+    class OutputStreamDevice;
 
     class PDFMM_API PdfSigner
     {
+    protected:
+        PdfSigner();
+
     public:
         virtual ~PdfSigner();
 
@@ -55,6 +60,24 @@ namespace mm
          * Should return the signature /Type. It can be "Sig" or "DocTimeStamp"
          */
         virtual std::string GetSignatureType() const = 0;
+
+        /**
+         * Get the size reserved for the signature in the /Contents beacon.
+         * Unless set with SetSignatureSize(), it's inferred with a dry-run
+         * ComputeSignature() the first time and cached for the next signings
+         */
+        size_t GetSignatureSize();
+
+        /**
+         * Set a precomputed size of the signature, so no dry-run
+         * ComputeSignature() is performed
+         * \param size the maximum size of the signatures computed by this
+         *   signer. Signing fails if a signature doesn't fit it
+         */
+        void SetSignatureSize(size_t size);
+
+    private:
+        nullable<size_t> m_signatureSize;
     };
 
     /** Sign the document on the given signature field
@@ -66,6 +89,40 @@ namespace mm
      */
     PDFMM_API void SignDocument(PdfMemDocument& doc, StreamDevice& device, PdfSigner& signer,
         PdfSignature& signature, PdfSaveOptions saveOptions = PdfSaveOptions::None);
+
+    /** Sign the document on the given signature field, writing the
+     * signed document to a different device
+     * \param doc the document to be signed
+     * \param input the device with the original document data, that
+     *   will be copied to the output before the signed update
+     * \param output the output device, that is written sequentially
+     *   and is not required to be seekable
+     * \param signer the signer implementation that will compute the signature
+     * \param signature the signature field where the signature will be applied
+     * \param options document saving options
+     */
+    PDFMM_API void SignDocument(PdfMemDocument& doc, InputStreamDevice& input, OutputStreamDevice& output,
+        PdfSigner& signer, PdfSignature& signature, PdfSaveOptions saveOptions = PdfSaveOptions::None);
+
+    /** Sign the document on the given signature field with more signers,
+     * producing a signed copy of the document for each of them
+     *
+     * The incremental update is written only once and shared by all
+     * the copies, which differ only by the signature. The signers are fed
+     * concurrently, so they must be independent instances, and they
+     * must have the same /Filter, /SubFilter and /Type
+     * \param doc the document to be signed
+     * \param input the device with the original document data, that
+     *   will be copied to all the outputs before the signed update
+     * \param signers the signer implementations that will compute the signatures
+     * \param outputs the output devices, one for each signer. They are
+     *   written sequentially and are not required to be seekable
+     * \param signature the signature field where the signatures will be applied
+     * \param options document saving options
+     */
+    PDFMM_API void SignDocumentBatch(PdfMemDocument& doc, InputStreamDevice& input,
+        const std::vector<PdfSigner*>& signers, const std::vector<OutputStreamDevice*>& outputs,
+        PdfSignature& signature, PdfSaveOptions saveOptions = PdfSaveOptions::None);
 }
 
 #endif // PDF_SIGNER_H
@@ -11,6 +11,16 @@
 
 #include <pdfmm/private/FileSystem.h>
 
+#ifdef _WIN32
+#include <utfcpp/utf8.h>
+#include <pdfmm/private/WindowsLeanMean.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 using namespace std;
 using namespace mm;
 
@@ -450,6 +460,169 @@ fstream* FileStreamDevice::getFileStream(const string_view& filename, FileMode m
     return stream;
 }
 
+MappedFileStreamDevice::MappedFileStreamDevice(const string_view& filepath)
+    : StreamDevice(DeviceAccess::Read), m_Filepath(filepath), m_buffer(nullptr), m_Length(0), m_Position(0)
+{
+#ifdef _WIN32
+    auto filepath16 = utf8::utf8to16(m_Filepath);
+    HANDLE file = CreateFileW((LPCWSTR)filepath16.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, filepath);
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to get the size of the file {}", filepath);
+    }
+
+    m_Length = (size_t)size.QuadPart;
+    if (m_Length == 0)
+    {
+        // Empty files can't be mapped
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // NOTE: The view keeps a reference to the mapping and the file,
+    // so the handles can be released just after mapping
+    CloseHandle(file);
+    if (mapping == nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to map the file {}", filepath);
+
+    m_buffer = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (m_buffer == nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to map the file {}", filepath);
+#else
+    int fd = ::open(m_Filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, filepath);
+
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+    {
+        ::close(fd);
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to get the size of the file {}", filepath);
+    }
+
+    m_Length = (size_t)info.st_size;
+    if (m_Length == 0)
+    {
+        // Empty files can't be mapped
+        ::close(fd);
+        return;
+    }
+
+    void* mapped = mmap(nullptr, m_Length, PROT_READ, MAP_PRIVATE, fd, 0);
+    // NOTE: The mapping keeps a reference to the file,
+    // so the descriptor can be closed just after mapping
+    ::close(fd);
+    if (mapped == MAP_FAILED)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to map the file {}", filepath);
+
+    // The parser jumps to the trailer first and then reads most
+    // of the file: ask the kernel to start reading ahead. The
+    // hint is advisory, so a failure is not an error
+    (void)madvise(mapped, m_Length, MADV_WILLNEED);
+    m_buffer = (const char*)mapped;
+#endif
+}
+
+MappedFileStreamDevice::~MappedFileStreamDevice()
+{
+    close();
+}
+
+size_t MappedFileStreamDevice::GetLength() const
+{
+    return m_Length;
+}
+
+size_t MappedFileStreamDevice::GetPosition() const
+{
+    return m_Position;
+}
+
+bool MappedFileStreamDevice::Eof() const
+{
+    return m_Position == m_Length;
+}
+
+bool MappedFileStreamDevice::CanSeek() const
+{
+    return true;
+}
+
+void MappedFileStreamDevice::writeBuffer(const char* buffer, size_t size)
+{
+    (void)buffer;
+    (void)size;
+    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "A mapped file device is read-only");
+}
+
+size_t MappedFileStreamDevice::readBuffer(char* buffer, size_t size, bool& eof)
+{
+    size_t readCount = std::min(size, m_Length - m_Position);
+    std::memcpy(buffer, m_buffer + m_Position, readCount);
+    m_Position += readCount;
+    eof = m_Position == m_Length;
+    return readCount;
+}
+
+bool MappedFileStreamDevice::readChar(char& ch)
+{
+    if (m_Position == m_Length)
+    {
+        ch = '\0';
+        return false;
+    }
+
+    ch = m_buffer[m_Position];
+    m_Position++;
+    return true;
+}
+
+bool MappedFileStreamDevice::peek(char& ch) const
+{
+    if (m_Position == m_Length)
+    {
+        ch = '\0';
+        return false;
+    }
+
+    ch = m_buffer[m_Position];
+    return true;
+}
+
+void MappedFileStreamDevice::seek(ssize_t offset, SeekDirection direction)
+{
+    m_Position = SeekPosition(m_Position, m_Length, offset, direction);
+}
+
+bool MappedFileStreamDevice::tryGetBufferView(bufferview& view) const
+{
+    view = bufferview(m_buffer, m_Length);
+    return true;
+}
+
+void MappedFileStreamDevice::close()
+{
+    if (m_buffer == nullptr)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_buffer);
+#else
+    munmap(const_cast<char*>(m_buffer), m_Length);
+#endif
+    m_buffer = nullptr;
+    m_Length = 0;
+    m_Position = 0;
+}
+
 NullStreamDevice::NullStreamDevice()
     : StreamDevice(DeviceAccess::ReadWrite), m_Length(0), m_Position(0)
 {
@@ -615,3 +788,9 @@ void SpanStreamDevice::seek(ssize_t offset, SeekDirection direction)
 {
     m_Position = SeekPosition(m_Position, m_Length, offset, direction);
 }
+
+bool SpanStreamDevice::tryGetBufferView(bufferview& view) const
+{
+    view = bufferview(m_buffer, m_Length);
+    return true;
+}
@@ -195,6 +195,12 @@ protected:
         m_Position = SeekPosition(m_Position, m_container->size(), offset, direction);
     }
 
+    bool tryGetBufferView(bufferview& view) const override
+    {
+        view = bufferview(m_container->data(), m_container->size());
+        return true;
+    }
+
 private:
     TContainer* m_container;
     size_t m_Position;
@@ -233,6 +239,7 @@ protected:
     bool readChar(char& ch) override;
     bool peek(char& ch) const override;
     void seek(ssize_t offset, SeekDirection direction) override;
+    bool tryGetBufferView(bufferview& view) const override;
 
 private:
     SpanStreamDevice(std::nullptr_t) = delete;
@@ -243,6 +250,50 @@ private:
     size_t m_Position;
 };
 
+/** A read-only device that maps the content of a file in memory.
+ *  Reading and peeking operate directly on the mapped memory,
+ *  without the overhead of std::fstream
+ */
+class PDFMM_API MappedFileStreamDevice final : public StreamDevice
+{
+public:
+    /** Map for reading the supplied filepath
+     */
+    MappedFileStreamDevice(const std::string_view& filepath);
+
+    ~MappedFileStreamDevice();
+
+public:
+    size_t GetLength() const override;
+
+    size_t GetPosition() const override;
+
+    bool Eof() const override;
+
+    bool CanSeek() const override;
+
+    const std::string& GetFilepath() const { return m_Filepath; }
+
+protected:
+    void writeBuffer(const char* buffer, size_t size) override;
+    size_t readBuffer(char* buffer, size_t size, bool& eof) override;
+    bool readChar(char& ch) override;
+    bool peek(char& ch) const override;
+    void seek(ssize_t offset, SeekDirection direction) override;
+    bool tryGetBufferView(bufferview& view) const override;
+    void close() override;
+
+private:
+    MappedFileStreamDevice(const MappedFileStreamDevice&) = delete;
+    MappedFileStreamDevice& operator=(const MappedFileStreamDevice&) = delete;
+
+private:
+    std::string m_Filepath;
+    const char* m_buffer;
+    size_t m_Length;
+    size_t m_Position;
+};
+
 /**
  * An StreamDevice device that does nothing
  */
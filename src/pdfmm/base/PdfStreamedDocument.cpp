@@ -39,6 +39,23 @@ void PdfStreamedDocument::Close()
     this->GetObjects().Finish();
 }
 
+void PdfStreamedDocument::FlushPage(PdfPage& page)
+{
+    auto contents = page.GetObject().GetDictionary().FindKey("Contents");
+    if (contents != nullptr && contents->IsArray() && contents->IsIndirect())
+        m_Writer->FlushObject(*contents);
+
+    m_Writer->FlushObject(page.GetObject());
+
+    // The cached wrappers point into the released dictionary
+    page.invalidate();
+}
+
+void PdfStreamedDocument::FlushObject(PdfObject& obj)
+{
+    m_Writer->FlushObject(obj);
+}
+
 PdfVersion PdfStreamedDocument::GetPdfVersion() const
 {
     return m_Writer->GetPdfVersion();
@@ -19,7 +19,16 @@ namespace mm {
  *  Page contents, fonts and images are written to disk
  *  as soon as possible and are not kept in memory.
  *  This results in faster document generation and
- *  less memory being used.
+ *  less memory being used. Objects without a stream,
+ *  such as pages, are written when the document is closed,
+ *  unless they are flushed earlier with FlushPage() or
+ *  FlushObject()
+ *
+ *  The stream of an object is written as soon as its output
+ *  stream is closed and it can't be written again: trying to
+ *  write a stream a second time, or to read it, throws a
+ *  PdfError with code PdfErrorCode::NotImplemented.
+ *  Changes to written objects are not written
  *
  *  Please use PdfMemDocument if you intend to work
  *  on the object structure of a PDF file.
@@ -42,6 +51,7 @@ namespace mm {
  *  painter.SetFont(font);
  *  painter.DrawText(56.69, page->GetRect().GetHeight() - 56.69, "Hello World!");
  *  painter.FinishPage();
+ *  document.FlushPage(*page);
  *
  *  document.Close();
  */
@@ -87,6 +97,22 @@ public:
      */
     void Close();
 
+    /** Write the page and its /Contents array immediately and release
+     *  them, so the memory used by the document doesn't grow with the
+     *  number of pages. The contents, resources and annotations of the
+     *  page are not accessible anymore, and trying to draw on the page
+     *  or add annotations to it raises PdfErrorCode::InvalidHandle
+     *  \remarks The content streams of the page are written when their
+     *  output stream is closed, as usual
+     */
+    void FlushPage(PdfPage& page);
+
+    /** Write an object without a stream immediately and release it.
+     *  Further changes to the object are not written
+     *  \param obj an object of this document without a stream
+     */
+    void FlushObject(PdfObject& obj);
+
 public:
     const PdfEncrypt* GetEncrypt() const override;
 
@@ -6,6 +6,8 @@
 #include <pdfmm/private/PdfDeclarationsPrivate.h>
 #include "PdfStreamedObjectStream.h"
 
+#include <pdfmm/private/PdfSpillStream.h>
+
 #include "PdfDocument.h"
 #include "PdfEncrypt.h"
 #include "PdfFilter.h"
@@ -19,21 +21,26 @@ using namespace mm;
 class PdfStreamedObjectStream::ObjectOutputStream : public OutputStream
 {
 public:
-    ObjectOutputStream(PdfStreamedObjectStream& stream, OutputStreamDevice& outputStream) :
+    ObjectOutputStream(PdfStreamedObjectStream& stream, OutputStream& outputStream) :
         m_objectStream(&stream),
         m_outputStream(&outputStream)
     {
     }
 
-    ObjectOutputStream(PdfStreamedObjectStream& stream, unique_ptr<OutputStream> outputStream) :
+    ObjectOutputStream(PdfStreamedObjectStream& stream, unique_ptr<PdfEncryptOutputStream> outputStream) :
         m_objectStream(&stream),
         m_outputStream(outputStream.get()),
-        m_outputStreamStore(std::move(outputStream))
+        m_encryptStream(std::move(outputStream))
     {
     }
 
     ~ObjectOutputStream()
     {
+        // All the data has been written: finish
+        // the encryption before flushing
+        if (m_encryptStream != nullptr)
+            m_encryptStream->Finish();
+
         Flush(*m_outputStream);
         m_objectStream->FinishOutput();
     }
@@ -53,17 +60,20 @@ protected:
 private:
     PdfStreamedObjectStream* m_objectStream;
     OutputStream* m_outputStream;
-    std::unique_ptr<OutputStream> m_outputStreamStore;
+    std::unique_ptr<PdfEncryptOutputStream> m_encryptStream;
 };
 
 PdfStreamedObjectStream::PdfStreamedObjectStream(OutputStreamDevice& device) :
     m_Device(&device),
     m_CurrEncrypt(nullptr),
     m_Length(0),
-    m_LengthObj(nullptr)
+    m_LengthObj(nullptr),
+    m_Written(false)
 {
 }
 
+PdfStreamedObjectStream::~PdfStreamedObjectStream() { }
+
 void PdfStreamedObjectStream::Init(PdfObject& obj)
 {
     m_LengthObj = &obj.GetDocument()->GetObjects().CreateObject(static_cast<int64_t>(0));
@@ -95,15 +105,23 @@ unique_ptr<InputStream> PdfStreamedObjectStream::GetInputStream(PdfObject& obj)
 
 unique_ptr<OutputStream> PdfStreamedObjectStream::GetOutputStream(PdfObject& obj)
 {
+    if (m_Written)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Unsupported writing a streamed object stream more than once");
+
+    m_Written = true;
+
+    // The writer either writes the object on the device, so the data
+    // can follow, or sets a spill stream to hold the data
     obj.GetDocument()->GetObjects().WriteObject(obj);
+    OutputStream& output = m_Spill == nullptr ? static_cast<OutputStream&>(*m_Device) : *m_Spill;
     if (m_CurrEncrypt == nullptr)
     {
-        return std::make_unique<ObjectOutputStream>(*this, *m_Device);
+        return std::make_unique<ObjectOutputStream>(*this, output);
     }
     else
     {
         return std::make_unique<ObjectOutputStream>(*this,
-            m_CurrEncrypt->CreateEncryptionOutputStream(*m_Device, obj.GetIndirectReference()));
+            m_CurrEncrypt->CreateEncryptionOutputStream(output, obj.GetIndirectReference()));
     }
 }
 
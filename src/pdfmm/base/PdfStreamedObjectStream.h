@@ -13,6 +13,7 @@
 namespace mm {
 
 class OutputStream;
+class PdfSpillStream;
 
 /** A PDF stream can be appended to any PdfObject
  *  and can contain arbitrary data.
@@ -20,9 +21,11 @@ class OutputStream;
  *  Most of the time it will contain either drawing commands
  *  to draw onto a page or binary data like a font or an image.
  *
- *  A PdfFileObjectStream writes all data directly to an output device
- *  without keeping it in memory.
- *  PdfFileObjectStream is used automatically when creating PDF files
+ *  A PdfStreamedObjectStream writes all data directly to an output device
+ *  without keeping it in memory. If the device is busy with the data of
+ *  another stream, the data is spilled to temporary storage and it's
+ *  written to the device as soon as the device is available.
+ *  PdfStreamedObjectStream is used automatically when creating PDF files
  *  using PdfImmediateWriter.
  *
  *  \see PdfIndirectObjectList
@@ -44,6 +47,8 @@ private:
     PdfStreamedObjectStream(OutputStreamDevice& device);
 
 public:
+    ~PdfStreamedObjectStream();
+
     void Init(PdfObject& obj) override;
 
     void Clear() override;
@@ -77,6 +82,8 @@ private:
     PdfEncrypt* m_CurrEncrypt;
     size_t m_Length;
     PdfObject* m_LengthObj;
+    bool m_Written;
+    std::unique_ptr<PdfSpillStream> m_Spill;  // Holds the data while the device is busy
 };
 
 };
@@ -0,0 +1,157 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <pdfmm/private/PdfDeclarationsPrivate.h>
+#include "PdfTextSearchPattern.h"
+
+#include <regex>
+#include <utfcpp/utf8.h>
+
+using namespace std;
+using namespace mm;
+
+struct PdfTextSearchPattern::Regex
+{
+    std::regex Value;
+};
+
+static bool isWholeWord(const string_view& str, size_t pos, size_t length);
+
+PdfTextSearchPattern::PdfTextSearchPattern(const string_view& pattern, PdfTextExtractFlags flags) :
+    m_Pattern(pattern),
+    m_IgnoreCase((flags & PdfTextExtractFlags::IgnoreCase) != PdfTextExtractFlags::None),
+    m_MatchWholeWord((flags & PdfTextExtractFlags::MatchWholeWord) != PdfTextExtractFlags::None)
+{
+    PDFMM_INVARIANT(utls::IsValidUtf8String(pattern));
+    if ((flags & PdfTextExtractFlags::RegexPattern) != PdfTextExtractFlags::None)
+    {
+        if (m_MatchWholeWord)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "RegexPattern is incompatible with MatchWholeWord flag");
+
+        auto regexFlags = regex_constants::ECMAScript;
+        if (m_IgnoreCase)
+            regexFlags |= regex_constants::icase;
+
+        m_regex = std::make_shared<Regex>(Regex{ std::regex(m_Pattern, regexFlags) });
+    }
+
+    // Case folding is performed on single bytes, as utls::ToLower() does
+    for (unsigned i = 0; i < 256; i++)
+        m_foldTable[i] = m_IgnoreCase ? (unsigned char)std::tolower((int)i) : (unsigned char)i;
+
+    m_foldedPattern.resize(m_Pattern.size());
+    for (size_t i = 0; i < m_Pattern.size(); i++)
+        m_foldedPattern[i] = (char)fold(m_Pattern[i]);
+
+    // Build the Boyer-Moore-Horspool bad character table
+    unsigned length = (unsigned)m_foldedPattern.size();
+    m_skipTable.fill(std::max(1u, length));
+    for (unsigned i = 0; i + 1 < length; i++)
+        m_skipTable[(unsigned char)m_foldedPattern[i]] = length - 1 - i;
+}
+
+PdfTextSearchPattern::~PdfTextSearchPattern() { }
+
+bool PdfTextSearchPattern::IsMatch(const string_view& str) const
+{
+    if (m_Pattern.empty())
+        return true;
+
+    if (m_regex != nullptr)
+    {
+        // NOTE: regex_search returns true when a sub-part of the string
+        // matches the regex
+        return std::regex_search(str.begin(), str.end(), m_regex->Value);
+    }
+
+    if (m_MatchWholeWord)
+    {
+        if (str.size() != m_foldedPattern.size())
+            return false;
+
+        for (size_t i = 0; i < str.size(); i++)
+        {
+            if (fold(str[i]) != (unsigned char)m_foldedPattern[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    return find(str) != string_view::npos;
+}
+
+bool PdfTextSearchPattern::TryFind(const string_view& str, size_t& pos) const
+{
+    if (m_regex != nullptr)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Finding the position of regular expressions is unsupported");
+
+    pos = find(str);
+    if (pos == string_view::npos)
+        return false;
+
+    // NOTE: Only the first occurrence is checked for delimiters
+    if (m_MatchWholeWord && !isWholeWord(str, pos, m_Pattern.size()))
+    {
+        pos = string_view::npos;
+        return false;
+    }
+
+    return true;
+}
+
+size_t PdfTextSearchPattern::find(const string_view& str) const
+{
+    size_t length = m_foldedPattern.size();
+    if (length == 0)
+        return 0;
+
+    if (str.size() < length)
+        return string_view::npos;
+
+    size_t last = length - 1;
+    for (size_t i = 0; i <= str.size() - length; )
+    {
+        size_t j = last;
+        while (fold(str[i + j]) == (unsigned char)m_foldedPattern[j])
+        {
+            if (j == 0)
+                return i;
+
+            j--;
+        }
+
+        i += m_skipTable[fold(str[i + last])];
+    }
+
+    return string_view::npos;
+}
+
+// Verify the presence of delimiters around the matched substring
+bool isWholeWord(const string_view& str, size_t pos, size_t length)
+{
+    auto it = str.begin();
+    auto end = str.begin() + pos;
+    bool prevDelimiter = true;
+    while (it != end)
+    {
+        char32_t cp = utf8::unchecked::next(it);
+        prevDelimiter = utls::IsStringDelimiter(cp);
+    }
+
+    if (!prevDelimiter)
+        return false;
+
+    it = str.begin() + pos + length;
+    end = str.end();
+    if (it != end)
+    {
+        char32_t cp = utf8::unchecked::next(it);
+        if (!utls::IsStringDelimiter(cp))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,83 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef PDF_TEXT_SEARCH_PATTERN_H
+#define PDF_TEXT_SEARCH_PATTERN_H
+
+#include "PdfDeclarations.h"
+
+#include <array>
+
+namespace mm {
+
+/**
+ * A text pattern compiled once, that can be searched in
+ * the text of many pages or documents
+ *
+ * Literal patterns are searched with the Boyer-Moore-Horspool
+ * algorithm, regular expressions are compiled at construction
+ */
+class PDFMM_API PdfTextSearchPattern final
+{
+public:
+    /** Compile a search pattern
+     * \param pattern utf-8 encoded pattern
+     * \param flags the matching flags to use, only
+     *      PdfTextExtractFlags::IgnoreCase, PdfTextExtractFlags::MatchWholeWord
+     *      and PdfTextExtractFlags::RegexPattern are considered
+     * \remarks An empty pattern matches any text
+     */
+    explicit PdfTextSearchPattern(const std::string_view& pattern,
+        PdfTextExtractFlags flags = PdfTextExtractFlags::None);
+
+    PdfTextSearchPattern(const PdfTextSearchPattern&) = default;
+    PdfTextSearchPattern(PdfTextSearchPattern&&) noexcept = default;
+    ~PdfTextSearchPattern();
+
+public:
+    /** Determine if the text matches the pattern. Whole word
+     * literal patterns must match the whole text, other
+     * patterns must match a part of it
+     */
+    bool IsMatch(const std::string_view& str) const;
+
+    /** Find the first occurrence of a literal pattern
+     * \param pos position of the match in the text
+     * \returns true if the pattern was found. Whole word patterns
+     *      must be delimited by string delimiters in the text
+     */
+    bool TryFind(const std::string_view& str, size_t& pos) const;
+
+public:
+    bool IsEmpty() const { return m_Pattern.empty(); }
+    const std::string& GetPattern() const { return m_Pattern; }
+    bool IsIgnoreCase() const { return m_IgnoreCase; }
+    bool IsMatchWholeWord() const { return m_MatchWholeWord; }
+    bool IsRegex() const { return m_regex != nullptr; }
+
+public:
+    PdfTextSearchPattern& operator=(const PdfTextSearchPattern&) = default;
+    PdfTextSearchPattern& operator=(PdfTextSearchPattern&&) noexcept = default;
+
+private:
+    size_t find(const std::string_view& str) const;
+    unsigned char fold(char ch) const { return m_foldTable[(unsigned char)ch]; }
+
+private:
+    struct Regex;
+
+private:
+    std::string m_Pattern;
+    bool m_IgnoreCase;
+    bool m_MatchWholeWord;
+    std::shared_ptr<const Regex> m_regex;
+    std::string m_foldedPattern;
+    std::array<unsigned char, 256> m_foldTable;
+    std::array<unsigned, 256> m_skipTable;
+};
+
+}
+
+#endif // PDF_TEXT_SEARCH_PATTERN_H
@@ -21,9 +21,48 @@
 using namespace std;
 using namespace mm;
 
+namespace
+{
+    enum CharClass : uint8_t
+    {
+        CharRegular = 0,
+        CharWhitespace = 1,
+        CharDelimiter = 2,
+    };
+}
+
 static char getEscapedCharacter(char ch);
 static void readHexString(InputStreamDevice& device, charbuff& buffer);
 static bool isOctalChar(char ch);
+static const char* skipComment(const char* it, const char* end);
+
+static constexpr array<uint8_t, 256> getCharClasses()
+{
+    array<uint8_t, 256> ret{ };
+    // White-space characters, see ISO 32000-1:2008 Table 1
+    ret[(unsigned char)'\0'] = CharWhitespace;
+    ret[(unsigned char)'\t'] = CharWhitespace;
+    ret[(unsigned char)'\n'] = CharWhitespace;
+    ret[(unsigned char)'\f'] = CharWhitespace;
+    ret[(unsigned char)'\r'] = CharWhitespace;
+    ret[(unsigned char)' '] = CharWhitespace;
+
+    // Delimiter characters, see ISO 32000-1:2008 Table 2
+    ret[(unsigned char)'('] = CharDelimiter;
+    ret[(unsigned char)')'] = CharDelimiter;
+    ret[(unsigned char)'<'] = CharDelimiter;
+    ret[(unsigned char)'>'] = CharDelimiter;
+    ret[(unsigned char)'['] = CharDelimiter;
+    ret[(unsigned char)']'] = CharDelimiter;
+    ret[(unsigned char)'{'] = CharDelimiter;
+    ret[(unsigned char)'}'] = CharDelimiter;
+    ret[(unsigned char)'/'] = CharDelimiter;
+    ret[(unsigned char)'%'] = CharDelimiter;
+    return ret;
+}
+
+// Character classification table, indexed by unsigned char value
+static constexpr array<uint8_t, 256> s_charClasses = getCharClasses();
 
 PdfTokenizer::PdfTokenizer(bool readReferences)
     : PdfTokenizer(std::make_shared<charbuff>(BufferSize), readReferences)
@@ -65,6 +104,11 @@ bool PdfTokenizer::TryReadNextToken(InputStreamDevice& device, string_view& toke
         return true;
     }
 
+    // Scan the token directly in memory if the device allows it
+    bufferview view;
+    if (device.TryGetBufferView(view))
+        return tryReadNextToken(device, view, token, tokenType);
+
     tokenType = PdfTokenType::Literal;
 
     char ch1;
@@ -175,6 +219,92 @@ Eof:
     goto Exit;
 }
 
+// NOTE: This must behave exactly as the character based
+// scanning in TryReadNextToken(), including token truncation
+// at the buffer size and consumption of trailing comments
+bool PdfTokenizer::tryReadNextToken(InputStreamDevice& device, const bufferview& view,
+    string_view& token, PdfTokenType& tokenType)
+{
+    // NOTE: Reserve 1 byte for the null termination
+    size_t bufferSize = m_buffer->size() - 1;
+    const char* begin = view.data();
+    const char* end = begin + view.size();
+    const char* it = begin + device.GetPosition();
+
+    tokenType = PdfTokenType::Literal;
+
+    // Skip leading whitespaces and comments
+    while (true)
+    {
+        while (it != end && IsWhitespace(*it))
+            it++;
+
+        if (it == end || *it != '%')
+            break;
+
+        it = skipComment(it, end);
+    }
+
+    if (it == end)
+    {
+        // No characters were read before EOF, so we're out of data
+        device.Seek((size_t)(it - begin));
+        token = { };
+        return false;
+    }
+
+    const char* start = it;
+    const char* tokenEnd;
+    char ch = *it;
+    it++;
+    if (ch == '<' || ch == '>')
+    {
+        // Special handling for << and >> tokens
+        if (it != end)
+        {
+            if (*it == ch)
+            {
+                it++;
+                tokenType = ch == '<' ? PdfTokenType::DoubleAngleBracketsLeft : PdfTokenType::DoubleAngleBracketsRight;
+            }
+            else
+            {
+                tokenType = ch == '<' ? PdfTokenType::AngleBracketLeft : PdfTokenType::AngleBracketRight;
+            }
+        }
+
+        tokenEnd = it;
+    }
+    else if (IsTokenDelimiter(ch, tokenType))
+    {
+        // All the other delimiters are one-character tokens
+        tokenEnd = it;
+    }
+    else
+    {
+        tokenType = PdfTokenType::Literal;
+        const char* limit = start + std::min(bufferSize, (size_t)(end - start));
+        while (it != limit && s_charClasses[(unsigned char)*it] == CharRegular)
+            it++;
+
+        tokenEnd = it;
+
+        // Comments are treated as token-delimiting whitespace
+        // and they are consumed along with the token
+        if (it != limit && *it == '%')
+            it = skipComment(it, end);
+    }
+
+    device.Seek((size_t)(it - begin));
+
+    size_t count = (size_t)(tokenEnd - start);
+    char* buffer = m_buffer->data();
+    std::memcpy(buffer, start, count);
+    buffer[count] = '\0';
+    token = string_view(buffer, count);
+    return true;
+}
+
 bool PdfTokenizer::IsNextToken(InputStreamDevice& device, const string_view& token)
 {
     if (token.length() == 0)
@@ -413,41 +543,53 @@ void PdfTokenizer::ReadDictionary(InputStreamDevice& device, PdfVariant& variant
     variant = PdfDictionary();
     PdfDictionary& dict = variant.GetDictionary();
 
-    while (true)
+    try
     {
-        bool gotToken = this->TryReadNextToken(device, token, tokenType);
-        if (!gotToken)
-            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Expected dictionary key name or >> delim");
+        while (true)
+        {
+            bool gotToken = this->TryReadNextToken(device, token, tokenType);
+            if (!gotToken)
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Expected dictionary key name or >> delim");
 
-        if (tokenType == PdfTokenType::DoubleAngleBracketsRight)
-            break;
+            if (tokenType == PdfTokenType::DoubleAngleBracketsRight)
+                break;
 
-        this->ReadNextVariant(device, token, tokenType, val, encrypt);
-        // Convert the read variant to a name; throws InvalidDataType if not a name.
-        key = val.GetName();
+            this->ReadNextVariant(device, token, tokenType, val, encrypt);
+            // Convert the read variant to a name; throws InvalidDataType if not a name.
+            key = val.GetName();
 
-        // Try to get the next variant
-        gotToken = this->TryReadNextToken(device, token, tokenType);
-        if (!gotToken)
-            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Expected variant");
+            // Try to get the next variant
+            gotToken = this->TryReadNextToken(device, token, tokenType);
+            if (!gotToken)
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::UnexpectedEOF, "Expected variant");
 
-        PdfLiteralDataType dataType = DetermineDataType(device, token, tokenType, val);
-        if (key == "Contents" && dataType == PdfLiteralDataType::HexString)
-        {
-            // 'Contents' key in signature dictionaries is an unencrypted Hex string:
-            // save the string buffer for later check if it needed decryption
-            contentsHexBuffer = std::unique_ptr<charbuff>(new charbuff());
-            readHexString(device, *contentsHexBuffer);
-            continue;
-        }
+            PdfLiteralDataType dataType = DetermineDataType(device, token, tokenType, val);
+            if (key == "Contents" && dataType == PdfLiteralDataType::HexString)
+            {
+                // 'Contents' key in signature dictionaries is an unencrypted Hex string:
+                // save the string buffer for later check if it needed decryption
+                contentsHexBuffer = std::unique_ptr<charbuff>(new charbuff());
+                readHexString(device, *contentsHexBuffer);
+                continue;
+            }
 
-        if (!tryReadDataType(device, dataType, val, encrypt))
-            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDataType, "Could not read variant");
+            if (!tryReadDataType(device, dataType, val, encrypt))
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDataType, "Could not read variant");
 
-        // Add the key without triggering SetDirty
-        dict.AddKey(key, std::move(val), true);
+            // Add the key without triggering SetDirty. The keys
+            // are sorted at once when the dictionary is complete
+            dict.appendKey(key, std::move(val));
+        }
+    }
+    catch (...)
+    {
+        // Don't leave the dictionary unsorted
+        dict.sortKeys();
+        throw;
     }
 
+    dict.sortKeys();
+
     if (contentsHexBuffer.get() != nullptr)
     {
         PdfObject* type = dict.GetKey("Type");
@@ -655,52 +797,12 @@ void PdfTokenizer::EnqueueToken(const string_view& token, PdfTokenType tokenType
 
 bool PdfTokenizer::IsWhitespace(char ch)
 {
-    switch (ch)
-    {
-        case '\0': // NULL
-            return true;
-        case '\t': // TAB
-            return true;
-        case '\n': // Line Feed
-            return true;
-        case '\f': // Form Feed
-            return true;
-        case '\r': // Carriage Return
-            return true;
-        case ' ': // White space
-            return true;
-        default:
-            return false;
-    }
+    return s_charClasses[(unsigned char)ch] == CharWhitespace;
 }
 
 bool PdfTokenizer::IsDelimiter(char ch)
 {
-    switch (ch)
-    {
-        case '(':
-            return true;
-        case ')':
-            return true;
-        case '<':
-            return true;
-        case '>':
-            return true;
-        case '[':
-            return true;
-        case ']':
-            return true;
-        case '{':
-            return true;
-        case '}':
-            return true;
-        case '/':
-            return true;
-        case '%':
-            return true;
-        default:
-            return false;
-    }
+    return s_charClasses[(unsigned char)ch] == CharDelimiter;
 }
 
 bool PdfTokenizer::IsTokenDelimiter(char ch, PdfTokenType& tokenType)
@@ -736,7 +838,7 @@ bool PdfTokenizer::IsTokenDelimiter(char ch, PdfTokenType& tokenType)
 
 bool PdfTokenizer::IsRegular(char ch)
 {
-    return !IsWhitespace(ch) && !IsDelimiter(ch);
+    return s_charClasses[(unsigned char)ch] == CharRegular;
 }
 
 bool PdfTokenizer::IsPrintable(char ch)
@@ -815,3 +917,12 @@ bool isOctalChar(char ch)
             return false;
     }
 }
+
+// Skip all characters before the next line break, which is not consumed
+const char* skipComment(const char* it, const char* end)
+{
+    while (it != end && *it != '\n' && *it != '\r')
+        it++;
+
+    return it;
+}
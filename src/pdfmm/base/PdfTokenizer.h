@@ -232,6 +232,10 @@ protected:
 private:
     bool tryReadDataType(InputStreamDevice& device, PdfLiteralDataType dataType, PdfVariant& variant, const PdfStatefulEncrypt& encrypt);
 
+    /** Read the next token scanning directly the memory of a contiguous device
+     */
+    bool tryReadNextToken(InputStreamDevice& device, const bufferview& view, std::string_view& token, PdfTokenType& tokenType);
+
 private:
     using TokenizerPair = std::pair<std::string, PdfTokenType>;
     using TokenizerQueque = std::deque<TokenizerPair>;
@@ -19,13 +19,61 @@
 #include "PdfXRefStream.h"
 #include "PdfStreamDevice.h"
 
+#include <condition_variable>
+#include <thread>
+
 #define PDF_MAGIC           "\xe2\xe3\xcf\xd3\n"
 // 10 spaces
 #define LINEARIZATION_PADDING "          "
 
+// Default number of objects compressed in a single object stream
+constexpr unsigned DEFAULT_OBJECT_STREAM_SIZE = 100;
+
 using namespace std;
 using namespace mm;
 
+/** Flate compress the streams of the given objects on worker threads,
+ * while the calling thread writes the objects. Workers compress the
+ * streams in the order they are written and stay at most a window of
+ * objects ahead of the last one written, so only a bounded number of
+ * compressed streams are held in memory at the same time
+ */
+class PdfWriter::StreamCompressor final
+{
+public:
+    StreamCompressor(const vector<PdfObject*>& objects, unsigned threadCount);
+    ~StreamCompressor();
+
+    /** Wait for the stream of the object at the given index to be
+     * compressed, then replace the stream of the object with it
+     * \remarks Must be called with increasing indices
+     */
+    void Apply(size_t index);
+
+private:
+    void compress();
+
+private:
+    struct Job
+    {
+        unique_ptr<PdfObject> Compressed;
+        exception_ptr Exception;
+        bool Done = false;
+    };
+
+private:
+    const vector<PdfObject*>* m_objects;
+    vector<Job> m_jobs;
+    size_t m_window;
+    size_t m_nextJob;
+    size_t m_appliedCount;
+    bool m_stop;
+    mutex m_mutex;
+    condition_variable m_jobAvailable;
+    condition_variable m_jobDone;
+    vector<thread> m_threads;
+};
+
 static PdfWriteFlags ToWriteFlags(PdfSaveOptions opts);
 
 PdfWriter::PdfWriter(PdfIndirectObjectList* objects, const PdfObject& trailer, PdfVersion version) :
@@ -36,6 +84,7 @@ PdfWriter::PdfWriter(PdfIndirectObjectList* objects, const PdfObject& trailer, P
     m_EncryptObj(nullptr),
     m_SaveOptions(PdfSaveOptions::None),
     m_WriteFlags(PdfWriteFlags::None),
+    m_ObjectStreamSize(DEFAULT_OBJECT_STREAM_SIZE),
     m_PrevXRefOffset(0),
     m_IncrementalUpdate(false),
     m_rewriteXRefTable(false)
@@ -62,6 +111,17 @@ void PdfWriter::SetSaveOptions(PdfSaveOptions opts)
 {
     m_SaveOptions = opts;
     m_WriteFlags = ToWriteFlags(opts);
+    if ((opts & PdfSaveOptions::ObjectStreams) != PdfSaveOptions::None)
+        SetUseXRefStream(true);
+}
+
+void PdfWriter::SetObjectStreamSize(unsigned size)
+{
+    // The index of objects in XRef stream entries is written with 2 bytes
+    if (size == 0 || size > numeric_limits<uint16_t>::max())
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Object stream size must be in the range [1, 65535]");
+
+    m_ObjectStreamSize = size;
 }
 
 PdfWriter::~PdfWriter()
@@ -94,7 +154,7 @@ void PdfWriter::Write(OutputStreamDevice& device)
         if (!m_IncrementalUpdate)
             WritePdfHeader(device);
 
-        WritePdfObjects(device, *m_Objects, *xRef);
+        writePdfObjects(device, *m_Objects, *xRef, shouldUseObjectStreams());
 
         if (m_IncrementalUpdate)
             xRef->SetFirstEmptyBlock();
@@ -130,6 +190,27 @@ void PdfWriter::WritePdfHeader(OutputStreamDevice& device)
 
 void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObjectList& objects, PdfXRef& xref)
 {
+    writePdfObjects(device, objects, xref, shouldUseObjectStreams());
+}
+
+void PdfWriter::writePdfObjects(OutputStreamDevice& device, const PdfIndirectObjectList& objects, PdfXRef& xref,
+    bool useObjectStreams)
+{
+    vector<PdfObject*> compressedObjects;
+
+    // Compress the streams ahead of writing them, if requested
+    vector<PdfObject*> streamsToCompress;
+    unique_ptr<StreamCompressor> compressor;
+    if ((m_SaveOptions & PdfSaveOptions::ParallelCompress) != PdfSaveOptions::None)
+    {
+        unsigned threadCount = std::max(1u, thread::hardware_concurrency());
+        streamsToCompress = getStreamsToCompress(objects, xref);
+        threadCount = (unsigned)std::min((size_t)threadCount, streamsToCompress.size());
+        if (threadCount > 1)
+            compressor.reset(new StreamCompressor(streamsToCompress, threadCount));
+    }
+
+    size_t streamIndex = 0;
     for (PdfObject* obj : objects)
     {
         if (m_IncrementalUpdate && !obj->IsDirty())
@@ -168,20 +249,118 @@ void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObj
             // offset of the object and not retrieve it from the device
             xref.AddInUseObject(obj->GetIndirectReference(), 0xFFFFFFFF);
         }
+        else if (useObjectStreams && canCompressObject(*obj))
+        {
+            compressedObjects.push_back(obj);
+        }
         else
         {
+            if (compressor != nullptr && streamIndex < streamsToCompress.size()
+                && streamsToCompress[streamIndex] == obj)
+            {
+                compressor->Apply(streamIndex);
+                streamIndex++;
+            }
+
             xref.AddInUseObject(obj->GetIndirectReference(), device.GetPosition());
             // Also make sure that we do not encrypt the encryption dictionary!
             obj->Write(device, m_WriteFlags, obj == m_EncryptObj ? nullptr : m_Encrypt.get(), m_buffer);
         }
     }
 
+    if (compressedObjects.size() != 0)
+        writeObjectStreams(device, compressedObjects, xref);
+
     for (auto& freeObjectRef : objects.GetFreeObjects())
     {
         xref.AddFreeObject(freeObjectRef);
     }
 }
 
+void PdfWriter::writeObjectStreams(OutputStreamDevice& device, const vector<PdfObject*>& objects, PdfXRef& xref)
+{
+    // NOTE: The object streams are not added to the document, so
+    // they get object numbers greater than any existing object
+    uint32_t streamObjNum = m_Objects->GetObjectCount();
+    string header;
+    charbuff data;
+    for (size_t i = 0; i < objects.size(); i += m_ObjectStreamSize)
+    {
+        size_t count = std::min((size_t)m_ObjectStreamSize, objects.size() - i);
+        header.clear();
+        data.clear();
+        StringStreamDevice dataDevice(data);
+        for (unsigned j = 0; j < count; j++)
+        {
+            auto& obj = *objects[i + j];
+            utls::FormatTo(m_buffer, "{} {} ", obj.GetIndirectReference().ObjectNumber(), data.size());
+            header.append(m_buffer.data(), m_buffer.size());
+
+            // NOTE: Objects in object streams are never encrypted
+            // singularly, the object stream is encrypted instead
+            obj.GetVariant().Write(dataDevice, m_WriteFlags, { }, m_buffer);
+            dataDevice.Write('\n');
+            xref.AddCompressedObject(obj.GetIndirectReference(), streamObjNum, j);
+        }
+
+        PdfObject streamObj;
+        streamObj.SetIndirectReference(PdfReference(streamObjNum, 0));
+        auto& dict = streamObj.GetDictionary();
+        dict.AddKey(PdfName::KeyType, PdfName("ObjStm"));
+        dict.AddKey("N", static_cast<int64_t>(count));
+        dict.AddKey("First", static_cast<int64_t>(header.size()));
+        header.append(data.data(), data.size());
+        streamObj.GetOrCreateStream().SetData(header);
+
+        // The stream is flate compressed when written, unless disabled
+        xref.AddInUseObject(streamObj.GetIndirectReference(), device.GetPosition());
+        streamObj.Write(device, m_WriteFlags, m_Encrypt.get(), m_buffer);
+        streamObjNum++;
+    }
+}
+
+vector<PdfObject*> PdfWriter::getStreamsToCompress(const PdfIndirectObjectList& objects, PdfXRef& xref) const
+{
+    // NOTE: Objects not modified in incremental updates are
+    // skipped, they may be not written at all. If they are,
+    // they will be compressed serially
+    vector<PdfObject*> ret;
+    for (PdfObject* obj : objects)
+    {
+        if ((m_IncrementalUpdate && !obj->IsDirty())
+            || xref.ShouldSkipWrite(obj->GetIndirectReference()))
+        {
+            continue;
+        }
+
+        // HasStream() also ensures the stream of parsed
+        // objects is loaded before it's accessed concurrently
+        if (obj->HasStream() && obj->shouldCompressStream(m_WriteFlags))
+            ret.push_back(obj);
+    }
+
+    return ret;
+}
+
+bool PdfWriter::shouldUseObjectStreams() const
+{
+    // Object numbers of object streams would clash with
+    // objects added by further updates, so don't use
+    // object streams when writing incremental updates
+    return m_UseXRefStream && !m_IncrementalUpdate
+        && (m_SaveOptions & PdfSaveOptions::ObjectStreams) != PdfSaveOptions::None;
+}
+
+bool PdfWriter::canCompressObject(const PdfObject& obj) const
+{
+    // Streams, objects with generation number not zero and the
+    // encryption dictionary can't be stored in object streams
+    // (PDF Reference 1.7 3.4.6 Object Streams)
+    return obj.GetIndirectReference().GenerationNumber() == 0
+        && &obj != m_EncryptObj
+        && !obj.HasStream();
+}
+
 void PdfWriter::FillTrailerObject(PdfObject& trailer, size_t size, bool onlySizeKey) const
 {
     trailer.GetDictionary().AddKey(PdfName::KeySize, static_cast<int64_t>(size));
@@ -315,10 +494,100 @@ void PdfWriter::SetEncrypt(const PdfEncrypt& encrypt)
 
 void PdfWriter::SetUseXRefStream(bool useXRefStream)
 {
-    if (useXRefStream && m_Version < PdfVersion::V1_5)
-        this->SetPdfVersion(PdfVersion::V1_5);
-
     m_UseXRefStream = useXRefStream;
+    SetPdfVersion(m_Version);
+}
+
+void PdfWriter::SetPdfVersion(PdfVersion version)
+{
+    // XRef streams, that are also required by
+    // object streams, are supported since PDF 1.5
+    if (m_UseXRefStream && version < PdfVersion::V1_5)
+        version = PdfVersion::V1_5;
+
+    m_Version = version;
+}
+
+PdfWriter::StreamCompressor::StreamCompressor(const vector<PdfObject*>& objects, unsigned threadCount) :
+    m_objects(&objects),
+    m_jobs(objects.size()),
+    m_window((size_t)threadCount * 2),
+    m_nextJob(0),
+    m_appliedCount(0),
+    m_stop(false)
+{
+    m_threads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&StreamCompressor::compress, this);
+}
+
+PdfWriter::StreamCompressor::~StreamCompressor()
+{
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_jobAvailable.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void PdfWriter::StreamCompressor::Apply(size_t index)
+{
+    unique_ptr<PdfObject> compressed;
+    exception_ptr exception;
+    {
+        unique_lock<mutex> lock(m_mutex);
+        auto& job = m_jobs[index];
+        m_jobDone.wait(lock, [&job] { return job.Done; });
+        compressed = std::move(job.Compressed);
+        exception = job.Exception;
+        m_appliedCount = index + 1;
+    }
+
+    // Let the workers move forward the window
+    m_jobAvailable.notify_all();
+    if (exception != nullptr)
+        std::rethrow_exception(exception);
+
+    (*m_objects)[index]->moveCompressedStreamFrom(*compressed);
+}
+
+void PdfWriter::StreamCompressor::compress()
+{
+    unique_lock<mutex> lock(m_mutex);
+    while (true)
+    {
+        m_jobAvailable.wait(lock, [this] {
+            return m_stop || m_nextJob == m_jobs.size()
+                || m_nextJob < m_appliedCount + m_window;
+        });
+        if (m_stop || m_nextJob == m_jobs.size())
+            break;
+
+        size_t index = m_nextJob++;
+        lock.unlock();
+
+        unique_ptr<PdfObject> compressed;
+        exception_ptr exception;
+        try
+        {
+            compressed.reset(new PdfObject());
+            (*m_objects)[index]->compressStreamTo(*compressed);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        lock.lock();
+        auto& job = m_jobs[index];
+        job.Compressed = std::move(compressed);
+        job.Exception = exception;
+        job.Done = true;
+        m_jobDone.notify_all();
+    }
 }
 
 PdfWriteFlags ToWriteFlags(PdfSaveOptions opts)
@@ -76,8 +76,23 @@ public:
     void FillTrailerObject(PdfObject& trailer, size_t size, bool onlySizeKey) const;
 
 public:
+    /** Set the save options. If PdfSaveOptions::ObjectStreams
+     *  is set, an XRef stream will be used as well
+     */
     void SetSaveOptions(PdfSaveOptions saveOptions);
 
+    /** Set the maximum number of objects compressed in a single
+     *  object stream, when writing with PdfSaveOptions::ObjectStreams.
+     *  Default is 100
+     *  \param size the number of objects, must be in the range [1, 65535]
+     */
+    void SetObjectStreamSize(unsigned size);
+
+    /**
+     *  \returns the maximum number of objects compressed in a single object stream
+     */
+    inline unsigned GetObjectStreamSize() const { return m_ObjectStreamSize; }
+
     /** Get the write mode used for writing the PDF
      *  \returns the write mode
      */
@@ -86,8 +101,10 @@ public:
     /** Set the PDF Version of the document. Has to be called before Write() to
      *  have an effect.
      *  \param version  version of the pdf document
+     *  \remarks The version is raised to PDF 1.5 if a XRef stream
+     *  or object streams are used
      */
-    inline void SetPdfVersion(PdfVersion version) { m_Version = version; }
+    void SetPdfVersion(PdfVersion version);
 
     /** Get the PDF version of the document
      *  \returns PdfVersion version of the pdf document
@@ -143,7 +160,8 @@ protected:
      */
     void WritePdfHeader(OutputStreamDevice& device);
 
-    /** Write pdf objects to file
+    /** Write pdf objects to file. Objects are stored in object
+     *  streams if PdfSaveOptions::ObjectStreams is set
      *  \param device write to this output device
      *  \param objects write all objects in this vector to the file
      *  \param pXref add all written objects to this XRefTable
@@ -170,6 +188,27 @@ protected:
     void SetIdentifier(const PdfString& identifier) { m_identifier = identifier; }
     void SetEncryptObj(PdfObject& obj);
 
+private:
+    void writePdfObjects(OutputStreamDevice& device, const PdfIndirectObjectList& objects, PdfXRef& xref,
+        bool useObjectStreams);
+
+    /** Write the given objects compressed in object streams,
+     *  with object numbers following the highest one in the document
+     */
+    void writeObjectStreams(OutputStreamDevice& device, const std::vector<PdfObject*>& objects, PdfXRef& xref);
+
+    bool shouldUseObjectStreams() const;
+
+    bool canCompressObject(const PdfObject& obj) const;
+
+    /** Determine the objects whose stream will be Flate compressed
+     *  when writing, in the same order they will be written
+     */
+    std::vector<PdfObject*> getStreamsToCompress(const PdfIndirectObjectList& objects, PdfXRef& xref) const;
+
+private:
+    class StreamCompressor;
+
 protected:
     charbuff m_buffer;
 
@@ -186,6 +225,7 @@ private:
 
     PdfSaveOptions m_SaveOptions;
     PdfWriteFlags m_WriteFlags;
+    unsigned m_ObjectStreamSize;
 
     PdfString m_identifier;
     PdfString m_originalIdentifier; // used for incremental update
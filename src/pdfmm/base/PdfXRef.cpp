@@ -28,31 +28,40 @@ PdfXRef::~PdfXRef() { }
 
 void PdfXRef::AddInUseObject(const PdfReference& ref, nullable<uint64_t> offset)
 {
-    addObject(ref, offset, true);
+    if (ref.ObjectNumber() > m_maxObjCount)
+        m_maxObjCount = ref.ObjectNumber();
+
+    if (offset == nullptr)
+    {
+        // Objects with no offset provided will not be written
+        // in the entry list
+        return;
+    }
+
+    addObject(XRefItem(ref, offset.value()), true);
 }
 
 void PdfXRef::AddFreeObject(const PdfReference& ref)
 {
-    addObject(ref, nullptr, false);
+    addObject(XRefItem(ref, 0), false);
+}
+
+void PdfXRef::AddCompressedObject(const PdfReference& ref, uint32_t objectStreamNum, unsigned index)
+{
+    addObject(XRefItem(ref, objectStreamNum, index), true);
 }
 
-void PdfXRef::addObject(const PdfReference& ref, nullable<uint64_t> offset, bool inUse)
+void PdfXRef::addObject(const XRefItem& item, bool inUse)
 {
+    auto& ref = item.Reference;
     if (ref.ObjectNumber() > m_maxObjCount)
         m_maxObjCount = ref.ObjectNumber();
 
-    if (inUse && offset == nullptr)
-    {
-        // Objects with no offset provided will not be written
-        // in the entry list
-        return;
-    }
-
     bool insertDone = false;
 
     for (auto& block : m_blocks)
     {
-        if (block.InsertItem(ref, offset, inUse))
+        if (block.InsertItem(item, inUse))
         {
             insertDone = true;
             break;
@@ -65,7 +74,7 @@ void PdfXRef::addObject(const PdfReference& ref, nullable<uint64_t> offset, bool
         block.First = ref.ObjectNumber();
         block.Count = 1;
         if (inUse)
-            block.Items.push_back(XRefItem(ref, offset.value()));
+            block.Items.push_back(item);
         else
             block.FreeItems.push_back(ref);
 
@@ -130,8 +139,16 @@ void PdfXRef::Write(OutputStreamDevice& device, charbuff& buffer)
                 itFree++;
             }
 
-            this->WriteXRefEntry(device, itItems->Reference,
-                PdfXRefEntry::CreateInUse(itItems->Offset, itItems->Reference.GenerationNumber()), buffer);
+            if (itItems->ObjectStreamNumber == 0)
+            {
+                this->WriteXRefEntry(device, itItems->Reference,
+                    PdfXRefEntry::CreateInUse(itItems->Offset, itItems->Reference.GenerationNumber()), buffer);
+            }
+            else
+            {
+                this->WriteXRefEntry(device, itItems->Reference,
+                    PdfXRefEntry::CreateCompressed(itItems->ObjectStreamNumber, itItems->Index), buffer);
+            }
             itItems++;
         }
 
@@ -319,16 +336,16 @@ bool PdfXRef::ShouldSkipWrite(const PdfReference& ref)
     return false;
 }
 
-bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, nullable<uint64_t> offset, bool inUse)
+bool PdfXRef::PdfXRefBlock::InsertItem(const XRefItem& item, bool inUse)
 {
-    PDFMM_ASSERT(!inUse || offset.has_value());
+    auto& ref = item.Reference;
     if (ref.ObjectNumber() == First + Count)
     {
         // Insert at back
         Count++;
 
         if (inUse)
-            Items.push_back(XRefItem(ref, offset.value()));
+            Items.push_back(item);
         else
             FreeItems.push_back(ref);
 
@@ -342,7 +359,7 @@ bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, nullable<uint64_
 
         // This is known to be slow, but should not occur actually
         if (inUse)
-            Items.insert(Items.begin(), XRefItem(ref, offset.value()));
+            Items.insert(Items.begin(), item);
         else
             FreeItems.insert(FreeItems.begin(), ref);
 
@@ -356,7 +373,7 @@ bool PdfXRef::PdfXRefBlock::InsertItem(const PdfReference& ref, nullable<uint64_
 
         if (inUse)
         {
-            Items.push_back(XRefItem(ref, offset.value()));
+            Items.push_back(item);
             std::sort(Items.begin(), Items.end());
         }
         else
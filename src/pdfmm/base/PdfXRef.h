@@ -27,10 +27,15 @@ protected:
     struct XRefItem
     {
         XRefItem(const PdfReference& ref, uint64_t off)
-            : Reference(ref), Offset(off) { }
+            : Reference(ref), Offset(off), ObjectStreamNumber(0), Index(0) { }
+
+        XRefItem(const PdfReference& ref, uint32_t objectStreamNum, unsigned index)
+            : Reference(ref), Offset(0), ObjectStreamNumber(objectStreamNum), Index(index) { }
 
         PdfReference Reference;
         uint64_t Offset;
+        uint32_t ObjectStreamNumber;    // If not 0, the object is compressed in this object stream
+        unsigned Index;                 // Index of the compressed object in the object stream
 
         bool operator<(const XRefItem& rhs) const
         {
@@ -48,7 +53,7 @@ protected:
 
         PdfXRefBlock(const PdfXRefBlock& rhs) = default;
 
-        bool InsertItem(const PdfReference& ref, nullable<uint64_t> offset, bool bUsed);
+        bool InsertItem(const XRefItem& item, bool inUse);
 
         bool operator<(const PdfXRefBlock& rhs) const
         {
@@ -91,6 +96,14 @@ public:
      */
     void AddFreeObject(const PdfReference& ref);
 
+    /** Add an object compressed in an object stream to the XRef table.
+     *
+     *  \param ref reference of this object
+     *  \param objectStreamNum the object number of the object stream
+     *  \param index the index of the object in the object stream
+     */
+    void AddCompressedObject(const PdfReference& ref, uint32_t objectStreamNum, unsigned index);
+
     /** Write the XRef table to an output device.
      *
      *  \param device an output device (usually a PDF file)
@@ -161,7 +174,7 @@ protected:
     virtual void EndWriteImpl(OutputStreamDevice& device, charbuff& buffer);
 
 private:
-    void addObject(const PdfReference& ref, nullable<uint64_t> offset, bool inUse);
+    void addObject(const XRefItem& item, bool inUse);
 
     /** Called at the end of writing the XRef table.
      *  Sub classes can overload this method to finish a XRef table.
@@ -13,10 +13,12 @@
 #include "base/PdfCommon.h"
 #include "base/PdfMath.h"
 #include "base/PdfOperatorUtils.h"
+#include "base/PdfArena.h"
 #include "base/PdfArray.h"
 #include "base/PdfCanvas.h"
 #include "base/PdfColor.h"
 #include "base/PdfContentsReader.h"
+#include "base/PdfParsedContents.h"
 #include "base/PdfPostScriptTokenizer.h"
 #include "base/PdfData.h"
 #include "base/PdfDataProvider.h"
@@ -71,6 +73,7 @@
 #include "base/PdfExtGState.h"
 #include "base/PdfField.h"
 #include "base/PdfTextBox.h"
+#include "base/PdfTextSearchPattern.h"
 #include "base/PdfButton.h"
 #include "base/PdfCheckBox.h"
 #include "base/PdfButton.h"
@@ -92,6 +95,7 @@
 #include "base/PdfFontSimple.h"
 #include "base/PdfFontTrueType.h"
 #include "base/PdfFontTrueTypeSubset.h"
+#include "base/PdfFontCFFSubset.h"
 #include "base/PdfFontType1.h"
 #include "base/PdfFontType3.h"
 #include "base/PdfImage.h"
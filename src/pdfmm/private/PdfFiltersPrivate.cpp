@@ -35,7 +35,6 @@ public:
         m_Colors = static_cast<int>(decodeParms.FindKeyAs<int64_t>("Colors", 1));
         m_BitsPerComponent = static_cast<int>(decodeParms.FindKeyAs<int64_t>("BitsPerComponent", 8));
         m_ColumnCount = static_cast<int>(decodeParms.FindKeyAs<int64_t>("Columns", 1));
-        m_EarlyChange = static_cast<int>(decodeParms.FindKeyAs<int64_t>("EarlyChange", 1));
 
         // check that input values are in range (CVE-2018-20797)
         // ISO 32000-2008 specifies these values as all 1 or greater
@@ -54,26 +53,23 @@ public:
             m_CurrPredictor = m_Predictor;
         }
 
-        m_CurrRowIndex = 0;
-        m_BytesPerPixel = (m_BitsPerComponent * m_Colors) >> 3;
-        m_Rows = (m_ColumnCount * m_Colors * m_BitsPerComponent) >> 3;
-
         // check for multiplication overflow on buffer sizes (e.g. if m_nBPC=2 and m_nColors=SIZE_MAX/2+1)
         if (utls::DoesMultiplicationOverflow(m_BitsPerComponent, m_Colors)
-            || utls::DoesMultiplicationOverflow(m_ColumnCount, m_BitsPerComponent * m_Colors))
+            || utls::DoesMultiplicationOverflow(m_ColumnCount, m_BitsPerComponent * m_Colors)
+            || m_ColumnCount * m_BitsPerComponent * m_Colors > numeric_limits<int>::max() - 7)
         {
             PDFMM_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
         }
 
-        // check that computed allocation sizes are > 0 (CVE-2018-20797)
-        if (m_Rows < 1 || m_BitsPerComponent < 1)
-            PDFMM_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
-
-        m_Prev.resize(m_Rows);
-        memset(m_Prev.data(), 0, sizeof(char) * m_Rows);
+        // The distance of corresponding bytes of adjacent pixels,
+        // rounded up to one for pixels smaller than a byte
+        m_BytesPerPixel = std::max(1, (m_BitsPerComponent * m_Colors + 7) >> 3);
+        m_RowLength = (unsigned)((m_ColumnCount * m_Colors * m_BitsPerComponent + 7) >> 3);
+        m_CurrRowIndex = 0;
 
-        m_UpperLeftPixelComponents.resize(m_BytesPerPixel);
-        memset(m_UpperLeftPixelComponents.data(), 0, sizeof(char) * m_BytesPerPixel);
+        m_Row.resize(m_RowLength);
+        m_Prev.resize(m_RowLength);
+        memset(m_Prev.data(), 0, sizeof(char) * m_RowLength);
     }
 
     void Decode(const char* buffer, size_t len, OutputStream* stream)
@@ -84,138 +80,207 @@ public:
             return;
         }
 
-        while (len-- != 0)
+        while (len != 0)
         {
             if (m_NextByteIsPredictor)
             {
-                m_CurrPredictor = *buffer + 10;
+                m_CurrPredictor = (unsigned char)*buffer + 10;
                 m_NextByteIsPredictor = false;
+                buffer++;
+                len--;
+                continue;
             }
-            else
+
+            // Collect the row and decode it all at once
+            size_t count = std::min(len, (size_t)(m_RowLength - m_CurrRowIndex));
+            std::memcpy(m_Row.data() + m_CurrRowIndex, buffer, count);
+            m_CurrRowIndex += (unsigned)count;
+            buffer += count;
+            len -= count;
+
+            if (m_CurrRowIndex == m_RowLength)
+            {   // One line finished
+                decodeRow();
+                stream->Write(m_Row.data(), m_RowLength);
+
+                // The decoded row is the previous one for the next row
+                std::swap(m_Row, m_Prev);
+                m_CurrRowIndex = 0;
+                m_NextByteIsPredictor = (m_CurrPredictor >= 10);
+            }
+        }
+    }
+
+private:
+    void decodeRow()
+    {
+        auto row = reinterpret_cast<unsigned char*>(m_Row.data());
+        auto prev = reinterpret_cast<const unsigned char*>(m_Prev.data());
+        size_t length = m_RowLength;
+        switch (m_CurrPredictor)
+        {
+            case 2: // Tiff Predictor
             {
-                switch (m_CurrPredictor)
+                if (m_BitsPerComponent == 8)
+                {   // Same as png sub
+                    dispatchBpp([&](auto bpp) { decodeSub(row, length, bpp); });
+                    break;
+                }
+                else if (m_BitsPerComponent == 16)
                 {
-                    case 2: // Tiff Predictor
-                    {
-                        if (m_BitsPerComponent == 8)
-                        {   // Same as png sub
-                            int prev = (m_CurrRowIndex - m_BytesPerPixel < 0
-                                ? 0 : m_Prev[m_CurrRowIndex - m_BytesPerPixel]);
-                            m_Prev[m_CurrRowIndex] = *buffer + prev;
-                            break;
-                        }
-
-                        // TODO: implement tiff predictor for other than 8 BPC
-                        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "tiff predictors other than 8 BPC are not implemented");
-                        break;
-                    }
-                    case 10: // png none
-                    {
-                        m_Prev[m_CurrRowIndex] = *buffer;
-                        break;
-                    }
-                    case 11: // png sub
-                    {
-                        int prev = (m_CurrRowIndex - m_BytesPerPixel < 0
-                            ? 0 : m_Prev[m_CurrRowIndex - m_BytesPerPixel]);
-                        m_Prev[m_CurrRowIndex] = *buffer + prev;
-                        break;
-                    }
-                    case 12: // png up
-                    {
-                        m_Prev[m_CurrRowIndex] += *buffer;
-                        break;
-                    }
-                    case 13: // png average
-                    {
-                        int prev = (m_CurrRowIndex - m_BytesPerPixel < 0
-                            ? 0 : m_Prev[m_CurrRowIndex - m_BytesPerPixel]);
-                        m_Prev[m_CurrRowIndex] = ((prev + m_Prev[m_CurrRowIndex]) >> 1) + *buffer;
-                        break;
-                    }
-                    case 14: // png paeth
-                    {
-                        int nLeftByteIndex = m_CurrRowIndex - m_BytesPerPixel;
-
-                        int a = nLeftByteIndex < 0 ? 0 : static_cast<unsigned char>(m_Prev[nLeftByteIndex]);
-                        int b = static_cast<unsigned char>(m_Prev[m_CurrRowIndex]);
-
-                        int nCurrComponentIndex = m_CurrRowIndex % m_BytesPerPixel;
-                        int c = nLeftByteIndex < 0 ? 0 : static_cast<unsigned char>(m_UpperLeftPixelComponents[nCurrComponentIndex]);
-
-                        int p = a + b - c;
-
-                        int pa = p - a;
-                        if (pa < 0)
-                            pa = -pa;
-
-                        int pb = p - b;
-                        if (pb < 0)
-                            pb = -pb;
-
-                        int pc = p - c;
-                        if (pc < 0)
-                            pc = -pc;
-
-                        char closestByte;
-                        if (pa <= pb && pa <= pc)
-                            closestByte = a;
-                        else if (pb <= pc)
-                            closestByte = b;
-                        else
-                            closestByte = c;
-
-                        // Save the byte we're about to clobber for the next pixel's prediction
-                        m_UpperLeftPixelComponents[nCurrComponentIndex] = m_Prev[m_CurrRowIndex];
-
-                        m_Prev[m_CurrRowIndex] = *buffer + closestByte;
-                        break;
-                    }
-                    case 15: // png optimum
-                        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "png optimum predictor is not implemented");
-                        break;
-
-                    default:
-                    {
-                        //PDFMM_RAISE_ERROR( EPdfError::InvalidPredictor );
-                        break;
-                    }
+                    decodeTiff16(row, length, m_BytesPerPixel);
+                    break;
                 }
 
-                m_CurrRowIndex++;
+                // TODO: implement tiff predictor for other than 8 and 16 BPC
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "tiff predictors other than 8 and 16 BPC are not implemented");
+                break;
+            }
+            case 10: // png none
+            {
+                break;
+            }
+            case 11: // png sub
+            {
+                dispatchBpp([&](auto bpp) { decodeSub(row, length, bpp); });
+                break;
             }
+            case 12: // png up
+            {
+                for (size_t i = 0; i < length; i++)
+                    row[i] += prev[i];
 
-            buffer++;
+                break;
+            }
+            case 13: // png average
+            {
+                dispatchBpp([&](auto bpp) { decodeAverage(row, prev, length, bpp); });
+                break;
+            }
+            case 14: // png paeth
+            {
+                dispatchBpp([&](auto bpp) { decodePaeth(row, prev, length, bpp); });
+                break;
+            }
+            case 15: // png optimum
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidPredictor, "png optimum predictor is not implemented");
+                break;
 
-            if (m_CurrRowIndex >= m_Rows)
-            {   // One line finished
-                m_CurrRowIndex = 0;
-                m_NextByteIsPredictor = (m_CurrPredictor >= 10);
-                stream->Write(m_Prev.data(), m_Rows);
+            default:
+            {
+                //PDFMM_RAISE_ERROR( EPdfError::InvalidPredictor );
+                break;
             }
         }
     }
 
+    // Call the function with the bytes per pixel as a compile
+    // time constant for the common pixel sizes, so the kernels
+    // are specialized and the compiler can unroll them
+    template <typename TFunction>
+    void dispatchBpp(const TFunction& function)
+    {
+        switch (m_BytesPerPixel)
+        {
+            case 1:
+                function(std::integral_constant<size_t, 1>());
+                break;
+            case 2:
+                function(std::integral_constant<size_t, 2>());
+                break;
+            case 3:
+                function(std::integral_constant<size_t, 3>());
+                break;
+            case 4:
+                function(std::integral_constant<size_t, 4>());
+                break;
+            case 6:
+                function(std::integral_constant<size_t, 6>());
+                break;
+            case 8:
+                function(std::integral_constant<size_t, 8>());
+                break;
+            default:
+                function((size_t)m_BytesPerPixel);
+                break;
+        }
+    }
+
+    template <typename TBpp>
+    static void decodeSub(unsigned char* row, size_t length, TBpp bpp)
+    {
+        for (size_t i = bpp; i < length; i++)
+            row[i] += row[i - bpp];
+    }
+
+    template <typename TBpp>
+    static void decodeAverage(unsigned char* row, const unsigned char* prev, size_t length, TBpp bpp)
+    {
+        size_t i = 0;
+        for (; i < bpp && i < length; i++)
+            row[i] += prev[i] >> 1;
+
+        for (; i < length; i++)
+            row[i] += (unsigned char)(((unsigned)row[i - bpp] + prev[i]) >> 1);
+    }
+
+    template <typename TBpp>
+    static void decodePaeth(unsigned char* row, const unsigned char* prev, size_t length, TBpp bpp)
+    {
+        // For the first pixel the left and upper left bytes are
+        // zero, and the predictor always selects the upper byte
+        size_t i = 0;
+        for (; i < bpp && i < length; i++)
+            row[i] += prev[i];
+
+        for (; i < length; i++)
+        {
+            int a = row[i - bpp];
+            int b = prev[i];
+            int c = prev[i - bpp];
+            int pa = std::abs(b - c);
+            int pb = std::abs(a - c);
+            int pc = std::abs(a + b - 2 * c);
+            int predicted;
+            if (pa <= pb && pa <= pc)
+                predicted = a;
+            else if (pb <= pc)
+                predicted = b;
+            else
+                predicted = c;
+
+            row[i] += (unsigned char)predicted;
+        }
+    }
+
+    // Big endian 16 bit components are added to the
+    // corresponding components of the previous pixel
+    static void decodeTiff16(unsigned char* row, size_t length, size_t bpp)
+    {
+        for (size_t i = bpp; i + 1 < length; i += 2)
+        {
+            unsigned value = ((unsigned)row[i] << 8 | row[i + 1])
+                + ((unsigned)row[i - bpp] << 8 | row[i - bpp + 1]);
+            row[i] = (unsigned char)(value >> 8);
+            row[i + 1] = (unsigned char)value;
+        }
+    }
+
 private:
     int m_Predictor;
     int m_Colors;
     int m_BitsPerComponent;
     int m_ColumnCount;
-    int m_EarlyChange;
     int m_BytesPerPixel;     // Bytes per pixel
 
     int m_CurrPredictor;
-    int m_CurrRowIndex;
-    int m_Rows;
+    unsigned m_CurrRowIndex;
+    unsigned m_RowLength;
 
     bool m_NextByteIsPredictor;
 
+    charbuff m_Row;
     charbuff m_Prev;
-
-    // The PNG Paeth predictor uses the values of the pixel above and to the left
-    // of the current pixel. But we overwrite the row above as we go, so we'll
-    // have to store the bytes of the upper-left pixel separately.
-    charbuff m_UpperLeftPixelComponents;
 };
 
 } // end anonymous namespace
@@ -462,135 +527,89 @@ void PdfAscii85Filter::WidePut(unsigned tuple, int bytes) const
 
 #pragma endregion PdfFlateFilter
 
-PdfFlateFilter::PdfFlateFilter()
+namespace
 {
-    memset(m_buffer, 0, sizeof(m_buffer));
-    memset(&m_stream, 0, sizeof(m_stream));
+    // Forwards the inflated data to the predictor decoder
+    class PdfPredictorStream final : public OutputStream
+    {
+    public:
+        PdfPredictorStream(PdfPredictorDecoder& predictor, OutputStream& stream)
+            : m_predictor(&predictor), m_stream(&stream) { }
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override
+        {
+            m_predictor->Decode(buffer, size, m_stream);
+        }
+    private:
+        PdfPredictorDecoder* m_predictor;
+        OutputStream* m_stream;
+    };
 }
 
-void PdfFlateFilter::BeginEncodeImpl()
+PdfFlateFilter::PdfFlateFilter(PdfCompressionLevel level)
+    : m_CompressionLevel(level), m_backend(PdfFlateBackend::Create())
 {
-    m_stream.zalloc = Z_NULL;
-    m_stream.zfree = Z_NULL;
-    m_stream.opaque = Z_NULL;
-
-    if (deflateInit(&m_stream, Z_DEFAULT_COMPRESSION))
-        PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
 }
 
-void PdfFlateFilter::EncodeBlockImpl(const char* buffer, size_t len)
-{
-    this->EncodeBlockInternal(buffer, len, Z_NO_FLUSH);
-}
+PdfFlateFilter::~PdfFlateFilter() { }
 
-void PdfFlateFilter::EncodeBlockInternal(const char* buffer, size_t len, int nMode)
+void PdfFlateFilter::BeginEncodeImpl()
 {
-    int nWrittenData = 0;
-
-    m_stream.avail_in = static_cast<unsigned>(len);
-    m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(buffer));
-
-    do
+    if (m_CompressionLevel < PdfCompressionLevel::Default
+        || m_CompressionLevel > PdfCompressionLevel::BestCompression)
     {
-        m_stream.avail_out = BUFFER_SIZE;
-        m_stream.next_out = m_buffer;
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Invalid flate compression level");
+    }
 
-        if (deflate(&m_stream, nMode) == Z_STREAM_ERROR)
-        {
-            FailEncodeDecode();
-            PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
-        }
+    m_backend->BeginEncode(m_CompressionLevel);
+}
 
-        nWrittenData = BUFFER_SIZE - m_stream.avail_out;
-        try
-        {
-            if (nWrittenData > 0)
-            {
-                GetStream()->Write(reinterpret_cast<char*>(m_buffer), nWrittenData);
-            }
-        }
-        catch (PdfError& e)
-        {
-            // clean up after any output stream errors
-            FailEncodeDecode();
-            PDFMM_PUSH_FRAME(e);
-            throw e;
-        }
-    } while (m_stream.avail_out == 0);
+void PdfFlateFilter::EncodeBlockImpl(const char* buffer, size_t len)
+{
+    m_backend->EncodeBlock(buffer, len, *GetStream());
 }
 
 void PdfFlateFilter::EndEncodeImpl()
 {
-    this->EncodeBlockInternal(nullptr, 0, Z_FINISH);
-    deflateEnd(&m_stream);
+    m_backend->EndEncode(*GetStream());
 }
 
 void PdfFlateFilter::BeginDecodeImpl(const PdfDictionary* decodeParms)
 {
-    m_stream.zalloc = Z_NULL;
-    m_stream.zfree = Z_NULL;
-    m_stream.opaque = Z_NULL;
-
-    if (decodeParms != nullptr)
+    m_PredictorStream.reset();
+    if (decodeParms == nullptr)
+    {
+        m_Predictor.reset();
+    }
+    else
+    {
         m_Predictor.reset(new PdfPredictorDecoder(*decodeParms));
+        m_PredictorStream.reset(new PdfPredictorStream(*m_Predictor, *GetStream()));
+    }
 
-    if (inflateInit(&m_stream) != Z_OK)
-        PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
+    m_backend->BeginDecode();
 }
 
 void PdfFlateFilter::DecodeBlockImpl(const char* buffer, size_t len)
 {
-    int flateErr;
-    unsigned writtenDataSize;
-
-    m_stream.avail_in = static_cast<unsigned>(len);
-    m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(buffer));
-
-    do
-    {
-        m_stream.avail_out = BUFFER_SIZE;
-        m_stream.next_out = m_buffer;
-
-        switch ((flateErr = inflate(&m_stream, Z_NO_FLUSH)))
-        {
-            case Z_NEED_DICT:
-            case Z_DATA_ERROR:
-            case Z_MEM_ERROR:
-            {
-                mm::LogMessage(PdfLogSeverity::Error, "Flate Decoding Error from ZLib: {}", flateErr);
-                (void)inflateEnd(&m_stream);
-
-                FailEncodeDecode();
-                PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
-            }
-            default:
-                break;
-        }
-
-        writtenDataSize = BUFFER_SIZE - m_stream.avail_out;
-        try
-        {
-            if (m_Predictor != nullptr)
-                m_Predictor->Decode(reinterpret_cast<char*>(m_buffer), writtenDataSize, GetStream());
-            else
-                GetStream()->Write(reinterpret_cast<char*>(m_buffer), writtenDataSize);
-        }
-        catch (PdfError& e)
-        {
-            // clean up after any output stream errors
-            FailEncodeDecode();
-            PDFMM_PUSH_FRAME(e);
-            throw e;
-        }
-    } while (m_stream.avail_out == 0);
+    m_backend->DecodeBlock(buffer, len, getDecodeStream());
 }
 
 void PdfFlateFilter::EndDecodeImpl()
 {
-    (void)inflateEnd(&m_stream);
+    m_backend->EndDecode(getDecodeStream());
+    m_PredictorStream.reset();
     m_Predictor.reset();
 }
 
+OutputStream& PdfFlateFilter::getDecodeStream()
+{
+    if (m_PredictorStream == nullptr)
+        return *GetStream();
+    else
+        return *m_PredictorStream;
+}
+
 #pragma endregion // PdfFlateFilter
 
 #pragma region PdfRLEFilter
@@ -653,165 +672,262 @@ void PdfRLEFilter::DecodeBlockImpl(const char* buffer, size_t len)
 
 #pragma region PdfLZWFilter
 
-const unsigned short PdfLZWFilter::s_masks[] = { 0x01FF, 0x03FF, 0x07FF, 0x0FFF };
-const unsigned short PdfLZWFilter::s_clear = 0x0100;      // clear table
-const unsigned short PdfLZWFilter::s_eod = 0x0101;      // end of data
+constexpr unsigned LZW_CLEAR_CODE = 256;
+constexpr unsigned LZW_EOD_CODE = 257;
+constexpr unsigned LZW_FIRST_CODE = 258;
+constexpr unsigned LZW_TABLE_SIZE = 4096;
+constexpr unsigned LZW_MIN_CODE_LENGTH = 9;
+constexpr unsigned LZW_MAX_CODE_LENGTH = 12;
+// The encoder clears the table before it's completely
+// full, for compatibility with lenient decoders
+constexpr unsigned LZW_ENCODE_CLEAR_CODE = LZW_TABLE_SIZE - 2;
+// Power of two size of the encoder hash table, with a load
+// factor that is always less than 0.5
+constexpr unsigned LZW_HASH_TABLE_SIZE = 8192;
+constexpr unsigned LZW_OUTPUT_FLUSH_SIZE = 16384;
 
 PdfLZWFilter::PdfLZWFilter() :
-    m_mask(0),
-    m_code_len(0),
-    m_character(0),
-    m_First(false)
+    m_nextCode(0),
+    m_codeLength(0),
+    m_earlyChange(1),
+    m_prevCode(-1),
+    m_bitBuffer(0),
+    m_bitCount(0),
+    m_eod(false)
 {
 }
 
 void PdfLZWFilter::BeginEncodeImpl()
 {
-    PDFMM_RAISE_ERROR(PdfErrorCode::UnsupportedFilter);
+    // The encoder adds the entry of a string right after writing
+    // its prefix, one code before the decoder does: early change
+    // must not be applied here to produce a stream that is decoded
+    // with the default /EarlyChange 1
+    m_earlyChange = 0;
+    m_Predictor.reset();
+    m_bitBuffer = 0;
+    m_bitCount = 0;
+    m_output.clear();
+    m_hashTable.resize(LZW_HASH_TABLE_SIZE);
+    resetTable();
+
+    // Start with a clear code, as recommended by the specification
+    writeCode(LZW_CLEAR_CODE);
 }
 
-void PdfLZWFilter::EncodeBlockImpl(const char*, size_t)
+void PdfLZWFilter::EncodeBlockImpl(const char* buffer, size_t len)
 {
-    PDFMM_RAISE_ERROR(PdfErrorCode::UnsupportedFilter);
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned char ch = (unsigned char)buffer[i];
+        if (m_prevCode < 0)
+        {
+            m_prevCode = ch;
+            continue;
+        }
+
+        // Search the current string plus the
+        // new byte in the string table
+        int32_t key = (m_prevCode << 8) | ch;
+        unsigned index = ((unsigned)key * 2654435761U) >> 19;
+        while (true)
+        {
+            auto& slot = m_hashTable[index];
+            if (slot.Key == key)
+            {
+                m_prevCode = slot.Code;
+                break;
+            }
+
+            if (slot.Key < 0)
+            {
+                // Not found: write the current string and add the
+                // new one to the table, then restart from the byte
+                writeCode((unsigned)m_prevCode);
+                slot.Key = key;
+                slot.Code = (uint16_t)m_nextCode;
+                addEntry((unsigned)m_prevCode, ch);
+                if (m_nextCode == LZW_ENCODE_CLEAR_CODE)
+                {
+                    writeCode(LZW_CLEAR_CODE);
+                    resetTable();
+                }
+
+                m_prevCode = ch;
+                break;
+            }
+
+            index = (index + 1) & (LZW_HASH_TABLE_SIZE - 1);
+        }
+    }
+
+    if (m_output.size() >= LZW_OUTPUT_FLUSH_SIZE)
+        flushOutput();
 }
 
 void PdfLZWFilter::EndEncodeImpl()
 {
-    PDFMM_RAISE_ERROR(PdfErrorCode::UnsupportedFilter);
+    if (m_prevCode >= 0)
+    {
+        writeCode((unsigned)m_prevCode);
+        // The decoder adds an entry for each code after
+        // the first one, the code length may change
+        if (m_nextCode != LZW_FIRST_CODE)
+            addEntry(0, 0);
+    }
+
+    writeCode(LZW_EOD_CODE);
+    if (m_bitCount != 0)
+        m_output.push_back((char)(m_bitBuffer << (8 - m_bitCount)));
+
+    flushOutput();
+    m_hashTable.clear();
+    m_hashTable.shrink_to_fit();
 }
 
 void PdfLZWFilter::BeginDecodeImpl(const PdfDictionary* decodeParms)
 {
-    m_mask = 0;
-    m_code_len = 9;
-    m_character = 0;
-
-    m_First = true;
-
+    m_earlyChange = 1;
+    m_bitBuffer = 0;
+    m_bitCount = 0;
+    m_eod = false;
+    m_output.clear();
     if (decodeParms != nullptr)
+    {
+        m_earlyChange = decodeParms->FindKeyAs<int64_t>("EarlyChange", 1) == 0 ? 0 : 1;
         m_Predictor.reset(new PdfPredictorDecoder(*decodeParms));
+    }
 
-    InitTable();
+    resetTable();
 }
 
 void PdfLZWFilter::DecodeBlockImpl(const char* buffer, size_t len)
 {
-    unsigned buffer_size = 0;
-    const unsigned buffer_max = 24;
-
-    uint32_t old = 0;
-    uint32_t code = 0;
-    uint32_t codeBuff = 0;
-
-    TLzwItem item;
-
-    vector<unsigned char> data;
-    if (m_First)
-    {
-        m_character = *buffer;
-        m_First = false;
-    }
-
-    while (len != 0)
+    for (size_t i = 0; i < len && !m_eod; i++)
     {
-        // Fill the buffer
-        while (buffer_size <= (buffer_max - 8) && len)
+        m_bitBuffer = (m_bitBuffer << 8) | (unsigned char)buffer[i];
+        m_bitCount += 8;
+        while (m_bitCount >= m_codeLength)
         {
-            codeBuff <<= 8;
-            codeBuff |= static_cast<uint32_t>(static_cast<unsigned char>(*buffer));
-            buffer_size += 8;
-
-            buffer++;
-            len--;
-        }
-
-        // read from the buffer
-        while (buffer_size >= m_code_len)
-        {
-            code = (codeBuff >> (buffer_size - m_code_len)) & PdfLZWFilter::s_masks[m_mask];
-            buffer_size -= m_code_len;
+            m_bitCount -= m_codeLength;
+            unsigned code = (m_bitBuffer >> m_bitCount) & ((1U << m_codeLength) - 1);
+            if (code == LZW_CLEAR_CODE)
+            {
+                resetTable();
+                continue;
+            }
 
-            if (code == PdfLZWFilter::s_clear)
+            if (code == LZW_EOD_CODE)
             {
-                m_mask = 0;
-                m_code_len = 9;
+                m_eod = true;
+                break;
+            }
 
-                InitTable();
+            if (m_prevCode < 0)
+            {
+                // First code after a clear
+                if (code >= LZW_CLEAR_CODE)
+                    PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Invalid LZW code");
             }
-            else if (code == PdfLZWFilter::s_eod)
+            else if (code < m_nextCode)
             {
-                len = 0;
-                break;
+                addEntry((unsigned)m_prevCode, m_table[code].First);
+            }
+            else if (code == m_nextCode && m_nextCode < LZW_TABLE_SIZE)
+            {
+                // The string is the previous one plus its first byte
+                addEntry((unsigned)m_prevCode, m_table[m_prevCode].First);
             }
             else
             {
-                if (code >= m_table.size())
-                {
-                    if (old >= m_table.size())
-                    {
-                        PDFMM_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
-                    }
-                    data = m_table[old].value;
-                    data.push_back(m_character);
-                }
-                else
-                    data = m_table[code].value;
+                PDFMM_RAISE_ERROR_INFO(PdfErrorCode::ValueOutOfRange, "Invalid LZW code");
+            }
 
-                // Write data to the output device
-                if (m_Predictor != nullptr)
-                    m_Predictor->Decode(reinterpret_cast<char*>(data.data()), data.size(), GetStream());
-                else
-                    GetStream()->Write(reinterpret_cast<char*>(data.data()), data.size());
+            writeString(code);
+            m_prevCode = (int)code;
+        }
+    }
 
-                m_character = data[0];
-                if (old < m_table.size()) // fix the first loop
-                    data = m_table[old].value;
-                data.push_back(m_character);
+    flushOutput();
+}
 
-                item.value = data;
-                m_table.push_back(item);
+void PdfLZWFilter::EndDecodeImpl()
+{
+    flushOutput();
+    m_Predictor.reset();
+}
 
-                old = code;
+void PdfLZWFilter::resetTable()
+{
+    m_table.resize(LZW_TABLE_SIZE);
+    for (unsigned i = 0; i < 256; i++)
+        m_table[i] = { 0, 1, (unsigned char)i, (unsigned char)i };
 
-                switch (m_table.size())
-                {
-                    case 511:
-                    case 1023:
-                    case 2047:
-                        m_code_len++;
-                        m_mask++;
-                        break;
-                    default:
-                        break;
-                }
-            }
-        }
+    if (m_hashTable.size() != 0)
+    {
+        for (auto& slot : m_hashTable)
+            slot.Key = -1;
     }
+
+    m_nextCode = LZW_FIRST_CODE;
+    m_codeLength = LZW_MIN_CODE_LENGTH;
+    m_prevCode = -1;
 }
 
-void PdfLZWFilter::EndDecodeImpl()
+void PdfLZWFilter::addEntry(unsigned prefix, unsigned char suffix)
 {
-    m_Predictor.reset();
+    if (m_nextCode == LZW_TABLE_SIZE)
+        return;
+
+    auto& prefixEntry = m_table[prefix];
+    m_table[m_nextCode] = { (uint16_t)prefix, (uint16_t)(prefixEntry.Length + 1), suffix, prefixEntry.First };
+    m_nextCode++;
+
+    // With early change the code length is increased one code early
+    if (m_nextCode + m_earlyChange >= (1U << m_codeLength) && m_codeLength < LZW_MAX_CODE_LENGTH)
+        m_codeLength++;
 }
 
-void PdfLZWFilter::InitTable()
+void PdfLZWFilter::writeString(unsigned code)
 {
-    constexpr unsigned LZW_TABLE_SIZE = 4096;
-    TLzwItem item;
+    // Follow the chain of prefixes, writing the string backwards
+    size_t length = m_table[code].Length;
+    size_t offset = m_output.size();
+    m_output.resize(offset + length);
+    char* it = m_output.data() + offset + length;
+    do
+    {
+        auto& entry = m_table[code];
+        *--it = (char)entry.Suffix;
+        code = entry.Prefix;
+    } while (--length != 0);
 
-    m_table.clear();
-    m_table.reserve(LZW_TABLE_SIZE);
+    if (m_output.size() >= LZW_OUTPUT_FLUSH_SIZE)
+        flushOutput();
+}
 
-    for (int i = 0; i <= 255; i++)
+void PdfLZWFilter::writeCode(unsigned code)
+{
+    m_bitBuffer = (m_bitBuffer << m_codeLength) | code;
+    m_bitCount += m_codeLength;
+    while (m_bitCount >= 8)
     {
-        item.value.clear();
-        item.value.push_back(static_cast<unsigned char>(i));
-        m_table.push_back(item);
+        m_bitCount -= 8;
+        m_output.push_back((char)(m_bitBuffer >> m_bitCount));
     }
+}
+
+void PdfLZWFilter::flushOutput()
+{
+    if (m_output.size() == 0)
+        return;
+
+    if (m_Predictor != nullptr)
+        m_Predictor->Decode(m_output.data(), m_output.size(), GetStream());
+    else
+        GetStream()->Write(m_output.data(), m_output.size());
 
-    // Add dummy entry, which is never used by decoder
-    item.value.clear();
-    m_table.push_back(item);
+    m_output.clear();
 }
 
 #pragma endregion // PdfLZWFilter
@@ -18,7 +18,7 @@
 
 #include <pdfmm/base/PdfFilter.h>
 
-#include <zlib.h>
+#include "PdfFlateBackend.h"
 
 namespace mm {
 
@@ -86,13 +86,14 @@ private:
 };
 
 /** The Flate filter.
+ *
+ * The deflate codec is provided by a PdfFlateBackend
  */
 class PdfFlateFilter final : public PdfFilter
 {
-    static constexpr unsigned BUFFER_SIZE = 4096;
-
 public:
-    PdfFlateFilter();
+    PdfFlateFilter(PdfCompressionLevel level = PdfCompressionLevel::Default);
+    ~PdfFlateFilter();
 
     inline bool CanEncode() const override { return true; }
 
@@ -112,14 +113,16 @@ public:
 
     inline PdfFilterType GetType() const override { return PdfFilterType::FlateDecode; }
 
-private:
-    void EncodeBlockInternal(const char* buffer, size_t len, int nMode);
+    inline PdfCompressionLevel GetCompressionLevel() const { return m_CompressionLevel; }
 
 private:
-    unsigned char m_buffer[BUFFER_SIZE];
+    OutputStream& getDecodeStream();
 
-    z_stream m_stream;
+private:
+    PdfCompressionLevel m_CompressionLevel;
+    std::unique_ptr<PdfFlateBackend> m_backend;
     std::shared_ptr<PdfPredictorDecoder> m_Predictor;
+    std::unique_ptr<OutputStream> m_PredictorStream;
 };
 
 /** The RLE filter.
@@ -153,19 +156,28 @@ private:
  */
 class PdfLZWFilter final : public PdfFilter
 {
-    struct TLzwItem
+    // An entry of the string table, which is stored as
+    // the code of the prefix string plus a suffix byte
+    struct LzwEntry
     {
-        std::vector<unsigned char> value;
+        uint16_t Prefix;
+        uint16_t Length;
+        unsigned char Suffix;
+        unsigned char First;
     };
 
-    using TLzwTable = std::vector<TLzwItem>;
-    using TILzwTable = TLzwTable::iterator;
-    using TCILzwTable = TLzwTable::const_iterator;
+    // A slot of the hash table mapping a prefix code
+    // plus a byte to the code of the string, when encoding
+    struct LzwHashSlot
+    {
+        int32_t Key;
+        uint16_t Code;
+    };
 
 public:
     PdfLZWFilter();
 
-    inline bool CanEncode() const override { return false; }
+    inline bool CanEncode() const override { return true; }
 
     void BeginEncodeImpl() override;
 
@@ -184,20 +196,23 @@ public:
     inline PdfFilterType GetType() const override { return PdfFilterType::LZWDecode; }
 
 private:
-    void InitTable();
+    void resetTable();
+    void addEntry(unsigned prefix, unsigned char suffix);
+    void writeString(unsigned code);
+    void writeCode(unsigned code);
+    void flushOutput();
 
 private:
-    static const unsigned short s_masks[4];
-    static const unsigned short s_clear;
-    static const unsigned short s_eod;
-
-    TLzwTable m_table;
-
-    unsigned m_mask;
-    unsigned m_code_len;
-    unsigned char m_character;
-
-    bool m_First;
+    std::vector<LzwEntry> m_table;
+    std::vector<LzwHashSlot> m_hashTable;
+    unsigned m_nextCode;
+    unsigned m_codeLength;
+    unsigned m_earlyChange;
+    int m_prevCode;
+    uint32_t m_bitBuffer;
+    unsigned m_bitCount;
+    bool m_eod;
+    charbuff m_output;
 
     std::shared_ptr<PdfPredictorDecoder> m_Predictor;
 };
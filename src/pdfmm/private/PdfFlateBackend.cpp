@@ -0,0 +1,457 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <pdfmm/private/PdfDeclarationsPrivate.h>
+#include "PdfFlateBackend.h"
+
+#include <zlib.h>
+
+#ifdef PDFMM_HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif // PDFMM_HAVE_LIBDEFLATE
+
+using namespace std;
+using namespace mm;
+
+namespace
+{
+    /** The streaming zlib backend
+     */
+    class ZlibFlateBackend final : public PdfFlateBackend
+    {
+        static constexpr unsigned BUFFER_SIZE = 32768;
+
+    public:
+        ZlibFlateBackend();
+        ~ZlibFlateBackend();
+
+    public:
+        void BeginEncode(PdfCompressionLevel level) override;
+        void EncodeBlock(const char* buffer, size_t len, OutputStream& output) override;
+        void EndEncode(OutputStream& output) override;
+        void BeginDecode() override;
+        void DecodeBlock(const char* buffer, size_t len, OutputStream& output) override;
+        void EndDecode(OutputStream& output) override;
+
+    private:
+        void deflateBlock(const char* buffer, size_t len, int flush, OutputStream& output);
+        void inflateBlock(const char* buffer, size_t len, OutputStream& output);
+        void reset();
+
+    private:
+        enum class State
+        {
+            None,
+            Encoding,
+            Decoding,
+        };
+
+    private:
+        State m_state;
+        z_stream m_stream;
+        unique_ptr<char[]> m_buffer;
+    };
+
+#ifdef PDFMM_HAVE_LIBDEFLATE
+    /** The libdeflate backend, which works on whole buffers: the input
+     * is collected and it's compressed/decompressed in one step. Inputs
+     * bigger than LIBDEFLATE_MAX_BUFFERED_SIZE, and outputs that don't
+     * fit LIBDEFLATE_MAX_DECODE_CAPACITY, are handled by the streaming
+     * zlib backend instead, so memory usage stays bounded
+     */
+    class LibdeflateFlateBackend final : public PdfFlateBackend
+    {
+    public:
+        LibdeflateFlateBackend();
+
+    public:
+        void BeginEncode(PdfCompressionLevel level) override;
+        void EncodeBlock(const char* buffer, size_t len, OutputStream& output) override;
+        void EndEncode(OutputStream& output) override;
+        void BeginDecode() override;
+        void DecodeBlock(const char* buffer, size_t len, OutputStream& output) override;
+        void EndDecode(OutputStream& output) override;
+
+    private:
+        void releaseBuffers();
+
+    private:
+        PdfCompressionLevel m_compressionLevel;
+        int m_level;
+        bool m_streaming;
+        charbuff m_input;
+        charbuff m_output;
+        ZlibFlateBackend m_fallback;
+    };
+
+    struct LibdeflateDeleter
+    {
+        void operator()(libdeflate_compressor* compressor) const
+        {
+            libdeflate_free_compressor(compressor);
+        }
+        void operator()(libdeflate_decompressor* decompressor) const
+        {
+            libdeflate_free_decompressor(decompressor);
+        }
+    };
+#endif // PDFMM_HAVE_LIBDEFLATE
+}
+
+#ifdef PDFMM_HAVE_LIBDEFLATE
+static libdeflate_compressor* getCompressor(int level);
+static libdeflate_decompressor* getDecompressor();
+#endif // PDFMM_HAVE_LIBDEFLATE
+
+PdfFlateBackend::PdfFlateBackend() { }
+
+PdfFlateBackend::~PdfFlateBackend() { }
+
+unique_ptr<PdfFlateBackend> PdfFlateBackend::Create()
+{
+#ifdef PDFMM_HAVE_LIBDEFLATE
+    // libdeflate is faster but can't stream, so it's
+    // used only for streams that can be kept in memory
+    return unique_ptr<PdfFlateBackend>(new LibdeflateFlateBackend());
+#else // PDFMM_HAVE_LIBDEFLATE
+    return unique_ptr<PdfFlateBackend>(new ZlibFlateBackend());
+#endif // PDFMM_HAVE_LIBDEFLATE
+}
+
+#pragma region ZlibFlateBackend
+
+ZlibFlateBackend::ZlibFlateBackend()
+    : m_state(State::None), m_buffer(new char[BUFFER_SIZE])
+{
+    memset(&m_stream, 0, sizeof(m_stream));
+}
+
+ZlibFlateBackend::~ZlibFlateBackend()
+{
+    reset();
+}
+
+void ZlibFlateBackend::BeginEncode(PdfCompressionLevel level)
+{
+    reset();
+    m_stream.zalloc = Z_NULL;
+    m_stream.zfree = Z_NULL;
+    m_stream.opaque = Z_NULL;
+
+    if (deflateInit(&m_stream, level == PdfCompressionLevel::Default
+            ? Z_DEFAULT_COMPRESSION : (int)level) != Z_OK)
+    {
+        PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
+    }
+
+    m_state = State::Encoding;
+}
+
+void ZlibFlateBackend::EncodeBlock(const char* buffer, size_t len, OutputStream& output)
+{
+    deflateBlock(buffer, len, Z_NO_FLUSH, output);
+}
+
+void ZlibFlateBackend::EndEncode(OutputStream& output)
+{
+    deflateBlock(nullptr, 0, Z_FINISH, output);
+    reset();
+}
+
+void ZlibFlateBackend::BeginDecode()
+{
+    reset();
+    m_stream.zalloc = Z_NULL;
+    m_stream.zfree = Z_NULL;
+    m_stream.opaque = Z_NULL;
+
+    if (inflateInit(&m_stream) != Z_OK)
+        PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
+
+    m_state = State::Decoding;
+}
+
+void ZlibFlateBackend::DecodeBlock(const char* buffer, size_t len, OutputStream& output)
+{
+    inflateBlock(buffer, len, output);
+}
+
+void ZlibFlateBackend::EndDecode(OutputStream&)
+{
+    reset();
+}
+
+void ZlibFlateBackend::deflateBlock(const char* buffer, size_t len, int flush, OutputStream& output)
+{
+    PDFMM_INVARIANT(m_state == State::Encoding);
+
+    // zlib counts the available input with an unsigned
+    // int, so feed very big buffers in more steps
+    do
+    {
+        unsigned chunkSize = (unsigned)std::min(len, (size_t)numeric_limits<unsigned>::max());
+        m_stream.avail_in = chunkSize;
+        m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(buffer));
+        buffer += chunkSize;
+        len -= chunkSize;
+        int chunkFlush = len == 0 ? flush : Z_NO_FLUSH;
+
+        do
+        {
+            m_stream.avail_out = BUFFER_SIZE;
+            m_stream.next_out = reinterpret_cast<Bytef*>(m_buffer.get());
+
+            if (deflate(&m_stream, chunkFlush) == Z_STREAM_ERROR)
+            {
+                reset();
+                PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
+            }
+
+            unsigned writtenDataSize = BUFFER_SIZE - m_stream.avail_out;
+            if (writtenDataSize > 0)
+                output.Write(m_buffer.get(), writtenDataSize);
+        } while (m_stream.avail_out == 0);
+    } while (len != 0);
+}
+
+void ZlibFlateBackend::inflateBlock(const char* buffer, size_t len, OutputStream& output)
+{
+    PDFMM_INVARIANT(m_state == State::Decoding);
+
+    do
+    {
+        unsigned chunkSize = (unsigned)std::min(len, (size_t)numeric_limits<unsigned>::max());
+        m_stream.avail_in = chunkSize;
+        m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(buffer));
+        buffer += chunkSize;
+        len -= chunkSize;
+
+        do
+        {
+            m_stream.avail_out = BUFFER_SIZE;
+            m_stream.next_out = reinterpret_cast<Bytef*>(m_buffer.get());
+
+            int flateErr;
+            switch ((flateErr = inflate(&m_stream, Z_NO_FLUSH)))
+            {
+                case Z_NEED_DICT:
+                case Z_DATA_ERROR:
+                case Z_MEM_ERROR:
+                {
+                    mm::LogMessage(PdfLogSeverity::Error, "Flate Decoding Error from ZLib: {}", flateErr);
+                    reset();
+                    PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
+                }
+                default:
+                    break;
+            }
+
+            unsigned writtenDataSize = BUFFER_SIZE - m_stream.avail_out;
+            if (writtenDataSize > 0)
+                output.Write(m_buffer.get(), writtenDataSize);
+        } while (m_stream.avail_out == 0);
+    } while (len != 0);
+}
+
+void ZlibFlateBackend::reset()
+{
+    switch (m_state)
+    {
+        case State::Encoding:
+            (void)deflateEnd(&m_stream);
+            break;
+        case State::Decoding:
+            (void)inflateEnd(&m_stream);
+            break;
+        case State::None:
+        default:
+            break;
+    }
+
+    m_state = State::None;
+}
+
+#pragma endregion // ZlibFlateBackend
+
+#ifdef PDFMM_HAVE_LIBDEFLATE
+
+#pragma region LibdeflateFlateBackend
+
+// Same default level as zlib
+constexpr int LIBDEFLATE_DEFAULT_LEVEL = 6;
+constexpr size_t LIBDEFLATE_MIN_DECODE_CAPACITY = 65536;
+// Bigger inputs are streamed with zlib, so the whole stream is never held
+// in memory, which would defeat the bounded memory usage of the streamed
+// writer and of the parallel compression window
+constexpr size_t LIBDEFLATE_MAX_BUFFERED_SIZE = 4 * 1024 * 1024;
+constexpr size_t LIBDEFLATE_MAX_DECODE_CAPACITY = 4 * LIBDEFLATE_MAX_BUFFERED_SIZE;
+
+LibdeflateFlateBackend::LibdeflateFlateBackend()
+    : m_compressionLevel(PdfCompressionLevel::Default),
+      m_level(LIBDEFLATE_DEFAULT_LEVEL),
+      m_streaming(false)
+{
+}
+
+void LibdeflateFlateBackend::BeginEncode(PdfCompressionLevel level)
+{
+    m_compressionLevel = level;
+    m_level = level == PdfCompressionLevel::Default ? LIBDEFLATE_DEFAULT_LEVEL : (int)level;
+    m_streaming = false;
+    m_input.clear();
+}
+
+void LibdeflateFlateBackend::EncodeBlock(const char* buffer, size_t len, OutputStream& output)
+{
+    if (!m_streaming && len > LIBDEFLATE_MAX_BUFFERED_SIZE - m_input.size())
+    {
+        // Too big to be buffered: continue the session with zlib
+        m_fallback.BeginEncode(m_compressionLevel);
+        m_fallback.EncodeBlock(m_input.data(), m_input.size(), output);
+        releaseBuffers();
+        m_streaming = true;
+    }
+
+    if (m_streaming)
+        m_fallback.EncodeBlock(buffer, len, output);
+    else
+        m_input.append(buffer, len);
+}
+
+void LibdeflateFlateBackend::EndEncode(OutputStream& output)
+{
+    if (m_streaming)
+    {
+        m_streaming = false;
+        m_fallback.EndEncode(output);
+        return;
+    }
+
+    auto compressor = getCompressor(m_level);
+    m_output.resize(libdeflate_zlib_compress_bound(compressor, m_input.size()));
+    size_t size = libdeflate_zlib_compress(compressor, m_input.data(), m_input.size(),
+        m_output.data(), m_output.size());
+    if (size == 0)
+        PDFMM_RAISE_ERROR(PdfErrorCode::Flate);
+
+    output.Write(m_output.data(), size);
+    releaseBuffers();
+}
+
+void LibdeflateFlateBackend::BeginDecode()
+{
+    m_streaming = false;
+    m_input.clear();
+}
+
+void LibdeflateFlateBackend::DecodeBlock(const char* buffer, size_t len, OutputStream& output)
+{
+    if (!m_streaming && len > LIBDEFLATE_MAX_BUFFERED_SIZE - m_input.size())
+    {
+        m_fallback.BeginDecode();
+        m_fallback.DecodeBlock(m_input.data(), m_input.size(), output);
+        releaseBuffers();
+        m_streaming = true;
+    }
+
+    if (m_streaming)
+        m_fallback.DecodeBlock(buffer, len, output);
+    else
+        m_input.append(buffer, len);
+}
+
+void LibdeflateFlateBackend::EndDecode(OutputStream& output)
+{
+    if (m_streaming)
+    {
+        m_streaming = false;
+        m_fallback.EndDecode(output);
+        return;
+    }
+
+    // The size of the inflated data is unknown, so start
+    // with a guess and grow the buffer until it fits
+    auto decompressor = getDecompressor();
+    size_t capacity = std::max(m_input.size() * 4, LIBDEFLATE_MIN_DECODE_CAPACITY);
+    while (true)
+    {
+        m_output.resize(capacity);
+        size_t size;
+        switch (libdeflate_zlib_decompress(decompressor, m_input.data(), m_input.size(),
+            m_output.data(), m_output.size(), &size))
+        {
+            case LIBDEFLATE_SUCCESS:
+            {
+                output.Write(m_output.data(), size);
+                releaseBuffers();
+                return;
+            }
+            case LIBDEFLATE_INSUFFICIENT_SPACE:
+            {
+                if (capacity >= LIBDEFLATE_MAX_DECODE_CAPACITY)
+                    break;
+
+                capacity = std::min(capacity * 2, LIBDEFLATE_MAX_DECODE_CAPACITY);
+                continue;
+            }
+            default:
+                break;
+        }
+
+        break;
+    }
+
+    // libdeflate rejects truncated or corrupted streams as a whole, and the
+    // output may be too big to be buffered. Inflate them with zlib, that
+    // streams the output and recovers the data decoded before an error
+    m_fallback.BeginDecode();
+    m_fallback.DecodeBlock(m_input.data(), m_input.size(), output);
+    m_fallback.EndDecode(output);
+    releaseBuffers();
+}
+
+void LibdeflateFlateBackend::releaseBuffers()
+{
+    // Keep the buffers for the next session only if they are small
+    m_input.clear();
+    if (m_input.capacity() > LIBDEFLATE_MAX_BUFFERED_SIZE)
+        charbuff().swap(m_input);
+
+    if (m_output.capacity() > LIBDEFLATE_MAX_BUFFERED_SIZE)
+        charbuff().swap(m_output);
+}
+
+// Compressors are expensive to allocate, especially at high
+// levels, so cache one for each level and thread
+libdeflate_compressor* getCompressor(int level)
+{
+    thread_local unique_ptr<libdeflate_compressor, LibdeflateDeleter> s_compressors[10];
+    auto& compressor = s_compressors[level];
+    if (compressor == nullptr)
+    {
+        compressor.reset(libdeflate_alloc_compressor(level));
+        if (compressor == nullptr)
+            PDFMM_RAISE_ERROR(PdfErrorCode::OutOfMemory);
+    }
+
+    return compressor.get();
+}
+
+libdeflate_decompressor* getDecompressor()
+{
+    thread_local unique_ptr<libdeflate_decompressor, LibdeflateDeleter> s_decompressor;
+    if (s_decompressor == nullptr)
+    {
+        s_decompressor.reset(libdeflate_alloc_decompressor());
+        if (s_decompressor == nullptr)
+            PDFMM_RAISE_ERROR(PdfErrorCode::OutOfMemory);
+    }
+
+    return s_decompressor.get();
+}
+
+#pragma endregion // LibdeflateFlateBackend
+
+#endif // PDFMM_HAVE_LIBDEFLATE
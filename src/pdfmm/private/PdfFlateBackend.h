@@ -0,0 +1,55 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef PDF_FLATE_BACKEND_H
+#define PDF_FLATE_BACKEND_H
+
+#include <pdfmm/base/PdfOutputStream.h>
+
+namespace mm {
+
+/** The deflate codec used by PdfFlateFilter to produce and
+ * consume zlib streams. The implementation is selected at build
+ * time: libdeflate is used when available, zlib otherwise
+ *
+ * Backends may buffer the input and write the output only when the
+ * encoding/decoding ends, so the output stream must be the same for
+ * all the calls of a session. The libdeflate backend buffers only
+ * streams of a few MiB: bigger ones are streamed with zlib
+ */
+class PdfFlateBackend
+{
+protected:
+    PdfFlateBackend();
+
+public:
+    virtual ~PdfFlateBackend();
+
+    /** Create the backend selected at build time
+     */
+    static std::unique_ptr<PdfFlateBackend> Create();
+
+public:
+    /** Begin a new encoding session, aborting any session in progress
+     * \param level a level in the range [0, 9] or PdfCompressionLevel::Default
+     */
+    virtual void BeginEncode(PdfCompressionLevel level) = 0;
+    virtual void EncodeBlock(const char* buffer, size_t len, OutputStream& output) = 0;
+    virtual void EndEncode(OutputStream& output) = 0;
+
+    /** Begin a new decoding session, aborting any session in progress
+     */
+    virtual void BeginDecode() = 0;
+    virtual void DecodeBlock(const char* buffer, size_t len, OutputStream& output) = 0;
+    virtual void EndDecode(OutputStream& output) = 0;
+
+private:
+    PdfFlateBackend(const PdfFlateBackend&) = delete;
+    PdfFlateBackend& operator=(const PdfFlateBackend&) = delete;
+};
+
+}
+
+#endif // PDF_FLATE_BACKEND_H
@@ -0,0 +1,79 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#include <pdfmm/private/PdfDeclarationsPrivate.h>
+#include "PdfSpillStream.h"
+
+using namespace std;
+using namespace mm;
+
+constexpr size_t COPY_BUFFER_SIZE = 65536;
+
+PdfSpillStream::PdfSpillStream(size_t threshold) :
+    m_threshold(threshold),
+    m_length(0),
+    m_file(nullptr)
+{
+}
+
+PdfSpillStream::~PdfSpillStream()
+{
+    if (m_file != nullptr)
+        fclose(m_file);
+}
+
+void PdfSpillStream::CopyTo(OutputStream& stream)
+{
+    if (m_file == nullptr)
+    {
+        stream.Write(m_buffer.data(), m_buffer.size());
+        return;
+    }
+
+    if (fflush(m_file) != 0 || fseek(m_file, 0, SEEK_SET) != 0)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to rewind the temporary file");
+
+    // Reuse the memory buffer, it's not used anymore
+    m_buffer.resize(COPY_BUFFER_SIZE);
+    size_t read;
+    while ((read = fread(m_buffer.data(), 1, m_buffer.size(), m_file)) != 0)
+        stream.Write(m_buffer.data(), read);
+
+    if (ferror(m_file) != 0)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to read the temporary file");
+
+    // Continue appending after the data
+    if (fseek(m_file, 0, SEEK_END) != 0)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to seek the temporary file");
+}
+
+void PdfSpillStream::writeBuffer(const char* buffer, size_t size)
+{
+    if (m_file == nullptr)
+    {
+        if (m_buffer.size() + size <= m_threshold)
+        {
+            m_buffer.append(buffer, size);
+            m_length += size;
+            return;
+        }
+
+        // The data is over the threshold: move it to a temporary file
+        m_file = std::tmpfile();
+        if (m_file == nullptr)
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to create a temporary file");
+
+        if (fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size())
+            PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to write the temporary file");
+
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+    }
+
+    if (fwrite(buffer, 1, size, m_file) != size)
+        PDFMM_RAISE_ERROR_INFO(PdfErrorCode::InvalidDeviceOperation, "Unable to write the temporary file");
+
+    m_length += size;
+}
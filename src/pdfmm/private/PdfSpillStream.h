@@ -0,0 +1,51 @@
+/**
+ * SPDX-FileCopyrightText: (C) 2022 Francesco Pretto <ceztko@gmail.com>
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+ */
+
+#ifndef PDF_SPILL_STREAM_H
+#define PDF_SPILL_STREAM_H
+
+#include <pdfmm/base/PdfOutputStream.h>
+
+#include <cstdio>
+
+namespace mm {
+
+/** An output stream that keeps the data in memory until it
+ * grows over a threshold, then moves it to a temporary file
+ * that is deleted when the stream is destroyed
+ */
+class PdfSpillStream final : public OutputStream
+{
+public:
+    /**
+     * \param threshold the maximum size of the data held in memory
+     */
+    PdfSpillStream(size_t threshold);
+    ~PdfSpillStream();
+
+public:
+    /** Copy all the data written so far to the given stream
+     */
+    void CopyTo(OutputStream& stream);
+
+    size_t GetLength() const { return m_length; }
+
+protected:
+    void writeBuffer(const char* buffer, size_t size) override;
+
+private:
+    PdfSpillStream(const PdfSpillStream&) = delete;
+    PdfSpillStream& operator=(const PdfSpillStream&) = delete;
+
+private:
+    size_t m_threshold;
+    size_t m_length;
+    charbuff m_buffer;
+    FILE* m_file;
+};
+
+}
+
+#endif // PDF_SPILL_STREAM_H
@@ -0,0 +1,132 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include "BenchUtils.h"
+
+#include <random>
+
+using namespace std;
+using namespace mm;
+
+constexpr unsigned RANDOM_SEED = 5489;
+
+static const char* s_words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+    "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore",
+    "et", "dolore", "magna", "aliqua", "enim", "ad", "minim", "veniam",
+    "quis", "nostrud", "exercitation", "ullamco", "laboris", "nisi",
+    "aliquip", "ex", "ea", "commodo", "consequat", "duis", "aute", "irure",
+};
+
+static string generateLine(minstd_rand& random, unsigned wordCount);
+
+void BenchUtils::CreateTextDocument(PdfMemDocument& doc, unsigned pageCount, unsigned linesPerPage)
+{
+    minstd_rand random(RANDOM_SEED);
+    auto font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+    for (unsigned i = 0; i < pageCount; i++)
+    {
+        auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        PdfPainter painter;
+        painter.SetCanvas(page);
+        painter.GetTextState().SetFont(*font, 10);
+        double y = page.GetRect().GetHeight() - 40;
+        double step = (y - 40) / linesPerPage;
+        for (unsigned j = 0; j < linesPerPage; j++)
+        {
+            painter.DrawText(generateLine(random, 10), 40, y);
+            y -= step;
+        }
+        painter.FinishDrawing();
+    }
+}
+
+void BenchUtils::CreateObjectsDocument(PdfMemDocument& doc, unsigned objectCount)
+{
+    minstd_rand random(RANDOM_SEED);
+    auto& objects = doc.GetObjects();
+
+    // Reference all the objects from the catalog, so
+    // they are not collected when saving
+    auto& root = objects.CreateArrayObject();
+    doc.GetCatalog().GetDictionary().AddKeyIndirect("BenchObjects", root);
+    auto& rootArr = root.GetArray();
+    for (unsigned i = 0; i < objectCount; i++)
+    {
+        auto& obj = objects.CreateDictionaryObject("BenchObject");
+        auto& dict = obj.GetDictionary();
+        dict.AddKey("Index", (int64_t)i);
+        dict.AddKey("Value", (double)random() / random.max());
+        dict.AddKey("Name", PdfName(s_words[random() % std::size(s_words)]));
+        dict.AddKey("Text", PdfString(generateLine(random, 4)));
+        dict.AddKey("Flag", (random() % 2) == 0);
+
+        PdfArray arr;
+        for (unsigned j = 0; j < 6; j++)
+            arr.Add((int64_t)(random() % 1000));
+        dict.AddKey("Numbers", arr);
+
+        if (i != 0)
+            dict.AddKey("Prev", rootArr[i - 1]);
+
+        rootArr.Add(obj.GetIndirectReference());
+    }
+}
+
+void BenchUtils::SaveDocument(charbuff& buffer, PdfMemDocument& doc, PdfSaveOptions opts)
+{
+    buffer.clear();
+    BufferStreamDevice device(buffer);
+    doc.Save(device, opts);
+}
+
+void BenchUtils::GenerateText(charbuff& buffer, size_t size)
+{
+    minstd_rand random(RANDOM_SEED);
+    buffer.clear();
+    buffer.reserve(size);
+    while (buffer.size() < size)
+    {
+        buffer.append(generateLine(random, 12));
+        buffer.push_back('\n');
+    }
+
+    buffer.resize(size);
+}
+
+void BenchUtils::GeneratePngPredictedRows(charbuff& buffer, unsigned width, unsigned height)
+{
+    minstd_rand random(RANDOM_SEED);
+    buffer.clear();
+    buffer.reserve((size_t)(width * 3 + 1) * height);
+    for (unsigned i = 0; i < height; i++)
+    {
+        // Cycle through None, Sub, Up, Average and Paeth
+        buffer.push_back((char)(i % 5));
+        for (unsigned j = 0; j < width; j++)
+        {
+            // Smooth gradients with some noise
+            buffer.push_back((char)((i + j) % 256));
+            buffer.push_back((char)((i * 2 + random() % 8) % 256));
+            buffer.push_back((char)((j * 3 + random() % 8) % 256));
+        }
+    }
+}
+
+string generateLine(minstd_rand& random, unsigned wordCount)
+{
+    string ret;
+    for (unsigned i = 0; i < wordCount; i++)
+    {
+        if (i != 0)
+            ret.push_back(' ');
+
+        ret.append(s_words[random() % std::size(s_words)]);
+    }
+
+    return ret;
+}
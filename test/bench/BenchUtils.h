@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <PdfTest.h>
+
+namespace mm
+{
+    /**
+     * This class generates the synthetic inputs used by the
+     * benchmarks. All the data is generated with a fixed seed,
+     * so results of different runs are comparable
+     */
+    class BenchUtils final
+    {
+    public:
+        /** Create a document with pages filled with lines of text
+         * drawn with a standard 14 font
+         */
+        static void CreateTextDocument(PdfMemDocument& doc, unsigned pageCount, unsigned linesPerPage);
+
+        /** Create a document with many small indirect objects
+         * (dictionaries, arrays, strings, names and numbers)
+         */
+        static void CreateObjectsDocument(PdfMemDocument& doc, unsigned objectCount);
+
+        /** Serialize the document to a buffer
+         */
+        static void SaveDocument(charbuff& buffer, PdfMemDocument& doc,
+            PdfSaveOptions opts = PdfSaveOptions::None);
+
+        /** Generate compressible text-like data
+         */
+        static void GenerateText(charbuff& buffer, size_t size);
+
+        /** Generate RGB image rows, each one prefixed by its
+         * PNG predictor type byte
+         */
+        static void GeneratePngPredictedRows(charbuff& buffer, unsigned width, unsigned height);
+    };
+}
+
+#endif // BENCH_UTILS_H
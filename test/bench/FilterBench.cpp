@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include "BenchUtils.h"
+
+using namespace std;
+using namespace mm;
+
+// Benchmark names report the decoded size: divide
+// it by the mean time to get the throughput
+constexpr size_t TEXT_SIZE = 8 * 1024 * 1024;
+constexpr unsigned IMAGE_WIDTH = 1024;
+constexpr unsigned IMAGE_HEIGHT = 1024;
+
+TEST_CASE("benchFlate")
+{
+    charbuff data;
+    BenchUtils::GenerateText(data, TEXT_SIZE);
+    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
+    charbuff encoded;
+    filter->EncodeTo(encoded, data);
+
+    charbuff decoded;
+    BENCHMARK(utls::Format("Flate encode {} MiB", TEXT_SIZE / (1024 * 1024)))
+    {
+        charbuff buffer;
+        filter->EncodeTo(buffer, data);
+        return buffer.size();
+    };
+
+    BENCHMARK(utls::Format("Flate decode {} MiB", TEXT_SIZE / (1024 * 1024)))
+    {
+        decoded.clear();
+        filter->DecodeTo(decoded, encoded);
+        return decoded.size();
+    };
+    REQUIRE(decoded.size() == data.size());
+    REQUIRE(std::equal(decoded.begin(), decoded.end(), data.begin()));
+}
+
+TEST_CASE("benchLZW")
+{
+    charbuff data;
+    BenchUtils::GenerateText(data, TEXT_SIZE);
+    auto filter = PdfFilterFactory::Create(PdfFilterType::LZWDecode);
+    charbuff encoded;
+    filter->EncodeTo(encoded, data);
+
+    charbuff decoded;
+    BENCHMARK(utls::Format("LZW encode {} MiB", TEXT_SIZE / (1024 * 1024)))
+    {
+        charbuff buffer;
+        filter->EncodeTo(buffer, data);
+        return buffer.size();
+    };
+
+    BENCHMARK(utls::Format("LZW decode {} MiB", TEXT_SIZE / (1024 * 1024)))
+    {
+        decoded.clear();
+        filter->DecodeTo(decoded, encoded);
+        return decoded.size();
+    };
+    REQUIRE(decoded.size() == data.size());
+    REQUIRE(std::equal(decoded.begin(), decoded.end(), data.begin()));
+}
+
+TEST_CASE("benchPredictor")
+{
+    charbuff rows;
+    BenchUtils::GeneratePngPredictedRows(rows, IMAGE_WIDTH, IMAGE_HEIGHT);
+    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
+    charbuff encoded;
+    filter->EncodeTo(encoded, rows);
+
+    PdfDictionary decodeParms;
+    decodeParms.AddKey("Predictor", (int64_t)15);
+    decodeParms.AddKey("Colors", (int64_t)3);
+    decodeParms.AddKey("BitsPerComponent", (int64_t)8);
+    decodeParms.AddKey("Columns", (int64_t)IMAGE_WIDTH);
+
+    // Decoding without the predictor gives the baseline
+    // of the flate decoding alone
+    charbuff decoded;
+    BENCHMARK(utls::Format("Flate decode {}x{} RGB", IMAGE_WIDTH, IMAGE_HEIGHT))
+    {
+        decoded.clear();
+        filter->DecodeTo(decoded, encoded);
+        return decoded.size();
+    };
+
+    BENCHMARK(utls::Format("Flate decode {}x{} RGB with PNG predictor", IMAGE_WIDTH, IMAGE_HEIGHT))
+    {
+        decoded.clear();
+        filter->DecodeTo(decoded, encoded, &decodeParms);
+        return decoded.size();
+    };
+    REQUIRE(decoded.size() == (size_t)IMAGE_WIDTH * 3 * IMAGE_HEIGHT);
+}
@@ -0,0 +1,105 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include "BenchUtils.h"
+
+using namespace std;
+using namespace mm;
+
+constexpr unsigned OBJECT_COUNT = 20000;
+
+static const charbuff& getObjectsDocument();
+
+TEST_CASE("benchTokenizer")
+{
+    auto& buffer = getObjectsDocument();
+    BENCHMARK(utls::Format("Tokenize {} KiB", buffer.size() / 1024))
+    {
+        SpanStreamDevice device(buffer);
+        PdfTokenizer tokenizer;
+        string_view token;
+        PdfTokenType type;
+        unsigned count = 0;
+        while (tokenizer.TryReadNextToken(device, token, type))
+            count++;
+
+        return count;
+    };
+}
+
+TEST_CASE("benchParse")
+{
+    auto& buffer = getObjectsDocument();
+    BENCHMARK(utls::Format("Parse {} objects", OBJECT_COUNT))
+    {
+        PdfIndirectObjectList objects;
+        PdfParser parser(objects);
+        SpanStreamDevice device(buffer);
+        parser.Parse(device, false);
+        return objects.GetSize();
+    };
+
+    BENCHMARK(utls::Format("Parse {} objects on demand", OBJECT_COUNT))
+    {
+        PdfIndirectObjectList objects;
+        PdfParser parser(objects);
+        SpanStreamDevice device(buffer);
+        parser.Parse(device, true);
+        return objects.GetSize();
+    };
+
+    BENCHMARK(utls::Format("Load document {} objects", OBJECT_COUNT))
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer);
+        return doc.GetObjects().GetSize();
+    };
+}
+
+TEST_CASE("benchSave")
+{
+    PdfMemDocument doc;
+    BenchUtils::CreateObjectsDocument(doc, OBJECT_COUNT);
+    charbuff buffer;
+
+    BENCHMARK(utls::Format("Save {} objects", OBJECT_COUNT))
+    {
+        BenchUtils::SaveDocument(buffer, doc, PdfSaveOptions::NoModifyDateUpdate);
+        return buffer.size();
+    };
+
+    BENCHMARK(utls::Format("Save {} objects with XRef stream", OBJECT_COUNT))
+    {
+        buffer.clear();
+        BufferStreamDevice device(buffer);
+        PdfWriter writer(doc.GetObjects(), doc.GetTrailer().GetObject());
+        writer.SetPdfVersion(PdfVersion::V1_5);
+        writer.SetSaveOptions(PdfSaveOptions::NoModifyDateUpdate);
+        writer.SetUseXRefStream(true);
+        writer.Write(device);
+        return buffer.size();
+    };
+
+    BENCHMARK(utls::Format("Save {} objects with object streams", OBJECT_COUNT))
+    {
+        BenchUtils::SaveDocument(buffer, doc, PdfSaveOptions::NoModifyDateUpdate | PdfSaveOptions::ObjectStreams);
+        return buffer.size();
+    };
+}
+
+const charbuff& getObjectsDocument()
+{
+    static charbuff s_buffer;
+    if (s_buffer.empty())
+    {
+        PdfMemDocument doc;
+        BenchUtils::CreateObjectsDocument(doc, OBJECT_COUNT);
+        BenchUtils::SaveDocument(s_buffer, doc);
+    }
+
+    return s_buffer;
+}
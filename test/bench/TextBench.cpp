@@ -0,0 +1,61 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include "BenchUtils.h"
+
+using namespace std;
+using namespace mm;
+
+constexpr unsigned PAGE_COUNT = 20;
+constexpr unsigned LINES_PER_PAGE = 60;
+
+TEST_CASE("benchTextExtraction")
+{
+    charbuff buffer;
+    {
+        PdfMemDocument doc;
+        BenchUtils::CreateTextDocument(doc, PAGE_COUNT, LINES_PER_PAGE);
+        BenchUtils::SaveDocument(buffer, doc);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    auto& pages = doc.GetPages();
+    vector<PdfTextEntry> entries;
+    BENCHMARK(utls::Format("Extract text {} pages", PAGE_COUNT))
+    {
+        entries.clear();
+        for (unsigned i = 0; i < pages.GetCount(); i++)
+            pages.GetPageAt(i).ExtractTextTo(entries);
+
+        return entries.size();
+    };
+    REQUIRE(entries.size() == PAGE_COUNT * LINES_PER_PAGE);
+}
+
+TEST_CASE("benchTrueTypeSubset")
+{
+    auto metrics = PdfFontManager::GetFontMetrics("LiberationSans");
+    if (metrics == nullptr || metrics->GetFontFileType() != PdfFontFileType::TrueType)
+    {
+        WARN("No TrueType font found, skipping benchmark");
+        return;
+    }
+
+    // Subset the first 200 glyphs
+    vector<unsigned> gids;
+    for (unsigned i = 0; i < std::min(200u, metrics->GetGlyphCount()); i++)
+        gids.push_back(i);
+
+    string output;
+    BENCHMARK(utls::Format("Subset {} glyphs", gids.size()))
+    {
+        output.clear();
+        PdfFontTrueTypeSubset::BuildFont(output, *metrics, gids);
+        return output.size();
+    };
+}
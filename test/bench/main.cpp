@@ -0,0 +1,26 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include <catch.hpp>
+
+#include "BenchUtils.h"
+
+using namespace std;
+using namespace mm;
+
+int main(int argc, char* argv[])
+{
+    // The fonts directory is used only by the font benchmarks,
+    // which are skipped if no suitable font can be found
+    auto fontPath = TestUtils::GetTestInputPath() / "Fonts";
+    if (fs::exists(fontPath))
+        PdfCommon::AddFontDirectory(fontPath.u8string());
+
+    PdfCommon::SetMaxLoggingSeverity(PdfLogSeverity::Warning);
+    return Catch::Session().run(argc, argv);
+}
@@ -0,0 +1,85 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include <PdfTest.h>
+
+using namespace std;
+using namespace mm;
+
+TEST_CASE("testOperatorLookup")
+{
+    for (unsigned i = (unsigned)PdfOperator::w; i <= (unsigned)PdfOperator::EX; i++)
+    {
+        auto name = GetPdfOperatorName((PdfOperator)i);
+        REQUIRE(name.size() != 0);
+        PdfOperator op;
+        REQUIRE(TryGetPdfOperator(name, op));
+        REQUIRE(op == (PdfOperator)i);
+    }
+
+    PdfOperator op;
+    REQUIRE(!TryGetPdfOperator("", op));
+    REQUIRE(op == PdfOperator::Unknown);
+    REQUIRE(!TryGetPdfOperator("Tx", op));
+    REQUIRE(!TryGetPdfOperator("SCNX", op));
+    REQUIRE(!TryGetPdfOperator("true", op));
+    REQUIRE(!TryGetPdfOperator("B**", op));
+    REQUIRE(GetPdfOperatorName(PdfOperator::Unknown).size() == 0);
+}
+
+TEST_CASE("testParsedContents")
+{
+    string_view contents = "q 1 0 0 1 10.5 20 cm BT /F1 12 Tf (Hello) Tj [(A) -50 (B)] TJ ET "
+        "BI /W 1 /H 1 ID \x01\x02 EI foo Q";
+
+    PdfParsedContents parsed(std::make_shared<SpanStreamDevice>(contents));
+    REQUIRE(parsed.GetSize() == 11);
+
+    auto cm = parsed[1];
+    REQUIRE(cm.GetType() == PdfContentType::Operator);
+    REQUIRE(cm.GetOperator() == PdfOperator::cm);
+    REQUIRE(cm.GetKeyword() == "cm");
+    REQUIRE(cm.GetOperandCount() == 6);
+    REQUIRE(cm.GetNumber(0) == 20);
+    REQUIRE(cm.GetReal(1) == 10.5);
+    ASSERT_THROW_WITH_ERROR_CODE(cm.GetNumber(1), PdfErrorCode::InvalidDataType);
+    REQUIRE(cm.GetReal(5) == 1);
+    ASSERT_THROW_WITH_ERROR_CODE(cm.GetReal(6), PdfErrorCode::ValueOutOfRange);
+
+    auto tf = parsed[3];
+    REQUIRE(tf.GetOperator() == PdfOperator::Tf);
+    REQUIRE(tf.GetReal(0) == 12);
+    REQUIRE(!tf.IsNumberOrReal(1));
+    REQUIRE(tf.GetVariant(1).GetName() == "F1");
+
+    auto tj = parsed[5];
+    REQUIRE(tj.GetOperator() == PdfOperator::TJ);
+    REQUIRE(tj.GetOperand(0).GetArray().GetSize() == 3);
+
+    auto imageDict = parsed[7];
+    REQUIRE(imageDict.GetType() == PdfContentType::ImageDictionary);
+    REQUIRE(imageDict.GetInlineImageDictionary().MustFindKey("W").GetNumber() == 1);
+
+    auto imageData = parsed[8];
+    REQUIRE(imageData.GetType() == PdfContentType::ImageData);
+    auto data = imageData.GetInlineImageData();
+    REQUIRE(string_view(data.data(), data.size()) == "\x01\x02 ");
+
+    auto keyword = parsed[9];
+    REQUIRE(keyword.GetType() == PdfContentType::UnexpectedKeyword);
+    REQUIRE(keyword.GetKeyword() == "foo");
+
+    // The contents can be walked more times
+    for (unsigned i = 0; i < 2; i++)
+    {
+        vector<string_view> keywords;
+        for (auto operation : parsed)
+            keywords.push_back(operation.GetKeyword());
+
+        REQUIRE(keywords == vector<string_view>{ "q", "cm", "BT", "Tf", "Tj", "TJ", "ET", { }, { }, "foo", "Q" });
+    }
+}
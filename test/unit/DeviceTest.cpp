@@ -35,3 +35,36 @@ TEST_CASE("testSaveIncremental")
     doc.SaveUpdate(testPath);
     doc.Load(testPath);
 }
+
+TEST_CASE("testMappedFileDevice")
+{
+    string_view testString = "Hello World Mapped!";
+    auto testPath = TestUtils::GetTestOutputFilePath("testMappedFileDevice.txt");
+    {
+        FileStreamDevice output(testPath, FileMode::Create);
+        output.Write(testString);
+    }
+
+    MappedFileStreamDevice device(testPath);
+    REQUIRE(device.GetLength() == testString.size());
+
+    char ch;
+    REQUIRE(device.Peek(ch));
+    REQUIRE(ch == 'H');
+    REQUIRE(device.ReadChar() == 'H');
+    REQUIRE(device.GetPosition() == 1);
+
+    device.Seek(6);
+    char buffer[6];
+    device.Read(buffer, 6);
+    REQUIRE(string_view(buffer, 6) == "World ");
+
+    device.Seek(-7, SeekDirection::End);
+    string read(7, '\0');
+    bool eof;
+    REQUIRE(device.Read(read.data(), 100, eof) == 7);
+    REQUIRE(eof);
+    REQUIRE(read == "Mapped!");
+    REQUIRE(device.Eof());
+    REQUIRE(!device.Peek(ch));
+}
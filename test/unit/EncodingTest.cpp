@@ -10,6 +10,7 @@
 
 #include <ostream>
 #include <iostream>
+#include <thread>
 
 using namespace std;
 using namespace mm;
@@ -253,6 +254,46 @@ TEST_CASE("testUnicodeNames", "[.]")
     REQUIRE(codeCount == 65421);
 }
 
+TEST_CASE("testGlyphNameLookups")
+{
+    // Expected values are the ones found scanning the glyph
+    // list tables in order, so for names and code points defined
+    // more than once the first entry of the table wins
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("space"sv) == U'\x0020');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("hyphen"sv) == U'\x002D');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("macron"sv) == U'\x00AF');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("mu"sv) == U'\x00B5');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("Scedilla"sv) == U'\x015E');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("exclamsmall"sv) == U'\x0021');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("dollaroldstyle"sv) == U'\x0024');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("!"sv) == U'\x0021');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("a9"sv) == U'\x2720');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("a99"sv) == U'\x275D');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("uni0041"sv) == U'\x0041');
+    REQUIRE(PdfDifferenceEncoding::NameToCodePoint("notaglyph"sv) == U'\0');
+
+    // Names listed twice in the canonical table
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x0020') == "space");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x00A0') == "space");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x002D') == "hyphen");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x00AD') == "hyphen");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x00AF') == "macron");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x02C9') == "macron");
+
+    // Code points with several names in the complete list
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x0021') == "exclam");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x0024') == "dollar");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x0026') == "ampersand");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\xF721') == "exclamsmall");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\xF724') == "dollaroldstyle");
+
+    // Code points found only in the complete list
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x2720') == "a9");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x275D') == "a99");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x2721') == "a10");
+    REQUIRE(PdfDifferenceEncoding::CodePointToName(U'\x0378') == "uni0378");
+}
+
 TEST_CASE("testGetCharCode")
 {
     auto winAnsiEncoding = PdfEncodingFactory::CreateWinAnsiEncoding();
@@ -270,6 +311,36 @@ TEST_CASE("testGetCharCode")
     outofRangeHelper(differenceEncoding);
 }
 
+TEST_CASE("testCharCodeMapConcurrentLookup")
+{
+    // The lookup tree is built lazily by the first
+    // lookup, which may happen on several threads
+    PdfCharCodeMap map;
+    for (unsigned i = 0; i < 256; i++)
+        map.PushMapping(PdfCharCode(i), (codepoint)(0x400 + i));
+
+    vector<unsigned> failures(4);
+    vector<thread> threads;
+    for (unsigned i = 0; i < failures.size(); i++)
+    {
+        threads.emplace_back([&map, &failures, i]()
+        {
+            for (unsigned j = 0; j < 256; j++)
+            {
+                PdfCharCode code;
+                if (!map.TryGetCharCode((codepoint)(0x400 + j), code) || code.Code != j)
+                    failures[i]++;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (unsigned count : failures)
+        REQUIRE(count == 0);
+}
+
 TEST_CASE("testToUnicodeParse")
 {
     string_view toUnicode =
@@ -40,6 +40,150 @@ TEST_CASE("testCCITT")
         INFO("!!! ePdfFilter_CCITTFaxDecode not implemented skipping test!");
 }
 
+TEST_CASE("testLZW")
+{
+    // Example from the PDF Reference 1.7, 3.3.3 LZWDecode Filter
+    const char expected[] = { 0x2D, 0x2D, 0x2D, 0x2D, 0x2D, 0x41, 0x2D, 0x2D, 0x2D, 0x42 };
+    const unsigned char encoded[] = { 0x80, 0x0B, 0x60, 0x50, 0x22, 0x0C, 0x0C, 0x85, 0x01 };
+
+    unique_ptr<PdfFilter> filter = PdfFilterFactory::Create(PdfFilterType::LZWDecode);
+    charbuff buffer;
+    filter->DecodeTo(buffer, bufferview((const char*)encoded, std::size(encoded)));
+    REQUIRE(buffer == bufferview(expected, std::size(expected)));
+
+    buffer.clear();
+    filter->EncodeTo(buffer, bufferview(expected, std::size(expected)));
+    REQUIRE(buffer == bufferview((const char*)encoded, std::size(encoded)));
+
+    // Encode enough data to grow the code length up
+    // to 12 bits and clear the table, then decode
+    // feeding the filter one byte at a time
+    string data;
+    for (unsigned i = 0; i < 100000; i++)
+        data.push_back((char)((i * 7 + i / 13) % 31));
+
+    charbuff encodedData;
+    filter->EncodeTo(encodedData, data);
+    REQUIRE(encodedData.size() < data.size());
+
+    buffer.clear();
+    StringStreamDevice output(buffer);
+    filter->BeginDecode(output);
+    for (size_t i = 0; i < encodedData.size(); i++)
+        filter->DecodeBlock(bufferview(encodedData.data() + i, 1));
+    filter->EndDecode();
+    REQUIRE(buffer == data);
+}
+
+TEST_CASE("testFlateCompressionLevel")
+{
+    string data;
+    for (unsigned i = 0; i < 100000; i++)
+        data.push_back((char)((i * 7 + i / 13) % 31));
+
+    charbuff stored;
+    charbuff fast;
+    charbuff best;
+    PdfFilterFactory::Create(PdfFilterType::FlateDecode, PdfCompressionLevel::NoCompression)->EncodeTo(stored, data);
+    PdfFilterFactory::Create(PdfFilterType::FlateDecode, PdfCompressionLevel::BestSpeed)->EncodeTo(fast, data);
+    PdfFilterFactory::Create(PdfFilterType::FlateDecode, PdfCompressionLevel::BestCompression)->EncodeTo(best, data);
+    REQUIRE(stored.size() > data.size());
+    REQUIRE(fast.size() < data.size());
+    REQUIRE(best.size() <= fast.size());
+
+    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
+    for (auto& encoded : { stored, fast, best })
+    {
+        charbuff buffer;
+        filter->DecodeTo(buffer, encoded);
+        REQUIRE(buffer == data);
+    }
+
+    auto invalid = PdfFilterFactory::Create(PdfFilterType::FlateDecode, (PdfCompressionLevel)10);
+    charbuff buffer;
+    ASSERT_THROW_WITH_ERROR_CODE(invalid->EncodeTo(buffer, data), PdfErrorCode::ValueOutOfRange);
+
+    // The level of the document is used when compressing on save,
+    // unless the stream has its own level
+    auto save = [&](PdfCompressionLevel documentLevel, PdfCompressionLevel streamLevel)
+    {
+        PdfMemDocument doc;
+        doc.SetCompressionLevel(documentLevel);
+        auto& obj = doc.GetObjects().CreateDictionaryObject();
+        obj.GetOrCreateStream().SetCompressionLevel(streamLevel);
+        obj.GetOrCreateStream().SetData(data, true);
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("Test", obj);
+        charbuff output;
+        StringStreamDevice device(output);
+        doc.Save(device);
+        return output.size();
+    };
+
+    size_t defaultSize = save(PdfCompressionLevel::Default, PdfCompressionLevel::Default);
+    REQUIRE(defaultSize < data.size());
+    REQUIRE(save(PdfCompressionLevel::NoCompression, PdfCompressionLevel::Default) > data.size());
+    REQUIRE(save(PdfCompressionLevel::NoCompression, PdfCompressionLevel::BestCompression) < data.size());
+}
+
+TEST_CASE("testFlateLargeStream")
+{
+    // Streams of several MiB must be encoded and decoded
+    // incrementally, writing the output before the end
+    string data;
+    for (unsigned i = 0; i < 10 * 1024 * 1024; i++)
+        data.push_back((char)((i * 7 + i / 13) % 31));
+
+    constexpr size_t BlockSize = 1024 * 1024;
+    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode, PdfCompressionLevel::NoCompression);
+    charbuff encoded;
+    StringStreamDevice encodedOutput(encoded);
+    filter->BeginEncode(encodedOutput);
+    for (size_t i = 0; i < data.size(); i += BlockSize)
+        filter->EncodeBlock(bufferview(data.data() + i, BlockSize));
+    REQUIRE(encoded.size() != 0);
+    filter->EndEncode();
+    REQUIRE(encoded.size() > data.size());
+
+    charbuff decoded;
+    StringStreamDevice decodedOutput(decoded);
+    filter->BeginDecode(decodedOutput);
+    for (size_t i = 0; i < encoded.size(); i += BlockSize)
+        filter->DecodeBlock(bufferview(encoded.data() + i, std::min(BlockSize, encoded.size() - i)));
+    REQUIRE(decoded.size() != 0);
+    filter->EndDecode();
+    REQUIRE(decoded == data);
+}
+
+TEST_CASE("testPngPredictors")
+{
+    // Rows using all the PNG predictors, each prefixed by its tag
+    const char encoded[] = {
+        0, 10, 20, 30, 40,  // None
+        1, 1, 2, 3, 4,      // Sub
+        2, 1, 1, 1, 1,      // Up
+        3, 2, 2, 2, 2,      // Average
+        4, 1, 1, 1, 1,      // Paeth
+    };
+    const char expected[] = {
+        10, 20, 30, 40,
+        1, 3, 6, 10,
+        2, 4, 7, 11,
+        3, 5, 8, 11,
+        4, 6, 9, 12,
+    };
+
+    PdfDictionary decodeParms;
+    decodeParms.AddKey("Predictor", (int64_t)15);
+    decodeParms.AddKey("Columns", (int64_t)4);
+
+    unique_ptr<PdfFilter> filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
+    charbuff compressed;
+    filter->EncodeTo(compressed, bufferview(encoded, std::size(encoded)));
+    charbuff decoded;
+    filter->DecodeTo(decoded, compressed, &decodeParms);
+    REQUIRE(decoded == bufferview(expected, std::size(expected)));
+}
+
 void testFilter(PdfFilterType filterType, const bufferview& view)
 {
     charbuff encoded;
@@ -8,11 +8,197 @@
 
 #include <PdfTest.h>
 
+#include <thread>
+
 #include <pdfmm/private/FreetypePrivate.h>
 
 using namespace std;
 using namespace mm;
 
+static string getGlyphOutline(FT_Face face, unsigned gid);
+static charbuff createCFFFont(const string_view& charString);
+
+TEST_CASE("testCFFSubset")
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    auto font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+
+    {
+        PdfPainter painter;
+        painter.SetCanvas(page);
+        painter.GetTextState().SetFont(*font, 30.0);
+        painter.DrawText("Hello World \xc3\x80\xc3\x89", 100, 600);
+        painter.FinishDrawing();
+    }
+
+    charbuff buffer;
+    StringStreamDevice device(buffer);
+    doc.Save(device);
+
+    PdfMemDocument doc2;
+    doc2.LoadFromBuffer(buffer);
+    const PdfObject* fontFile = nullptr;
+    for (auto obj : doc2.GetObjects())
+    {
+        if (obj->IsDictionary() && (fontFile = obj->GetDictionary().FindKey("FontFile3")) != nullptr)
+            break;
+    }
+
+    REQUIRE(fontFile != nullptr);
+    REQUIRE(fontFile->GetDictionary().MustFindKey("Subtype").GetName() == "CIDFontType0C");
+
+    charbuff subsetData;
+    fontFile->MustGetStream().CopyTo(subsetData);
+    auto fontData = font->GetMetrics().GetOrLoadFontFileData();
+    REQUIRE(subsetData.size() < fontData.size() / 4);
+
+    auto face = CreateFreeTypeFace(fontData);
+    auto subsetFace = CreateFreeTypeFace(subsetData);
+
+    // Glyphs in the subset are indexed by CID
+    auto& usedGIDs = font->GetUsedGIDs();
+    REQUIRE(subsetFace->num_glyphs == (FT_Long)usedGIDs.size() + 1);
+    for (auto& pair : usedGIDs)
+        REQUIRE(getGlyphOutline(subsetFace, pair.second.Id) == getGlyphOutline(face, pair.first));
+
+    FT_Done_Face(subsetFace);
+    FT_Done_Face(face);
+}
+
+TEST_CASE("testCFFSubsetFixedOperand")
+{
+    // A 16.16 fixed operand ending exactly at the end of
+    // the charstring is valid, a truncated one is not
+    string charString = { (char)255, 0, 1, 0, 0 };
+    auto metrics = PdfFontMetricsFreetype::FromBuffer(
+        std::make_shared<charbuff>(createCFFFont(charString)));
+    REQUIRE(metrics->GetFontFileType() == PdfFontFileType::Type1CCF);
+    string output;
+    PdfFontCFFSubset::BuildFont(output, *metrics, { { 1, 1 } });
+    REQUIRE(output.size() != 0);
+
+    charString.pop_back();
+    metrics = PdfFontMetricsFreetype::FromBuffer(
+        std::make_shared<charbuff>(createCFFFont(charString)));
+    REQUIRE_THROWS_AS(PdfFontCFFSubset::BuildFont(output, *metrics, { { 1, 1 } }), PdfError);
+}
+
+TEST_CASE("testSharedFontMetrics")
+{
+    PdfMemDocument doc1;
+    auto font1 = doc1.GetFonts().GetFont("LiberationSans");
+    REQUIRE(font1 != nullptr);
+
+    PdfMemDocument doc2;
+    auto font2 = doc2.GetFonts().GetFont("LiberationSans");
+    REQUIRE(font2 != nullptr);
+
+    // Fonts loaded from the same file share the same metrics
+    REQUIRE(font1 != font2);
+    REQUIRE(&font1->GetMetrics() == &font2->GetMetrics());
+    REQUIRE(PdfFontManager::GetFontMetrics("LiberationSans").get() == &font1->GetMetrics());
+}
+
+TEST_CASE("testSharedFontMetricsConcurrentLookup")
+{
+    auto metrics = PdfFontManager::GetFontMetrics("LiberationSans");
+    REQUIRE(metrics != nullptr);
+
+    // Compute the expected values on a separate face
+    auto metricsCopy = PdfFontMetricsFreetype::FromMetrics(*metrics);
+    FT_Face face = metricsCopy->GetOrLoadFace();
+    REQUIRE(FT_Select_Charmap(face, FT_ENCODING_UNICODE) == 0);
+    vector<unsigned> gids;
+    vector<double> widths;
+    for (char32_t codePoint = 0; codePoint < 0x500; codePoint++)
+    {
+        unsigned gid = FT_Get_Char_Index(face, codePoint);
+        gids.push_back(gid);
+        REQUIRE(FT_Load_Glyph(face, gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) == 0);
+        widths.push_back(face->glyph->metrics.horiAdvance / (double)face->units_per_EM);
+    }
+
+    atomic<unsigned> errorCount(0);
+    vector<thread> threads;
+    for (unsigned i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            for (char32_t codePoint = 0; codePoint < 0x500; codePoint++)
+            {
+                unsigned gid;
+                double width;
+                if (metrics->TryGetGID(codePoint, gid) != (gids[codePoint] != 0)
+                    || gid != gids[codePoint]
+                    || !metrics->TryGetGlyphWidth(gid, width)
+                    || width != widths[codePoint])
+                {
+                    errorCount++;
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(errorCount == 0);
+    double width;
+    REQUIRE(!metrics->TryGetGlyphWidth(metrics->GetGlyphCount(), width));
+}
+
+// Create a bare name-keyed CFF font with a .notdef
+// glyph and a glyph with the given charstring
+charbuff createCFFFont(const string_view& charString)
+{
+    auto writeInt = [](string& output, unsigned value)
+    {
+        output.push_back(29);
+        output.push_back((char)(value >> 24));
+        output.push_back((char)(value >> 16));
+        output.push_back((char)(value >> 8));
+        output.push_back((char)value);
+    };
+
+    // Header, Name INDEX with "Test"
+    string font = { 1, 0, 4, 1, 0, 1, 1, 1, 5, 'T', 'e', 's', 't' };
+
+    // Top DICT INDEX: CharStrings and Private offsets, the
+    // String INDEX and the Global Subr INDEX are empty
+    constexpr unsigned TopDictSize = 17;
+    unsigned charStringsOffset = (unsigned)font.size() + 5 + TopDictSize + 4;
+    unsigned privateOffset = charStringsOffset + 6 + 1 + (unsigned)charString.size();
+    string topDict;
+    writeInt(topDict, charStringsOffset);
+    topDict.push_back(17);
+    writeInt(topDict, 2);
+    writeInt(topDict, privateOffset);
+    topDict.push_back(18);
+    font.append({ 0, 1, 1, 1, (char)(TopDictSize + 1) });
+    font.append(topDict);
+    font.append({ 0, 0, 0, 0 });
+
+    // CharStrings INDEX: .notdef with "endchar" and the test glyph
+    font.append({ 0, 2, 1, 1, 2, (char)(2 + charString.size()), 14 });
+    font.append(charString);
+
+    // Private DICT: defaultWidthX 0
+    font.append({ (char)139, 20 });
+    return charbuff(font);
+}
+
+string getGlyphOutline(FT_Face face, unsigned gid)
+{
+    REQUIRE(FT_Load_Glyph(face, gid, FT_LOAD_NO_SCALE) == 0);
+    auto& outline = face->glyph->outline;
+    string ret = utls::Format("{} ", face->glyph->metrics.horiAdvance);
+    for (int i = 0; i < outline.n_points; i++)
+        ret.append(utls::Format("{},{},{} ", outline.points[i].x, outline.points[i].y, (int)outline.tags[i]));
+
+    return ret;
+}
+
 #ifdef PDFMM_HAVE_FONTCONFIG
 
 #include <fontconfig/fontconfig.h>
@@ -101,6 +101,45 @@ TEST_CASE("testFromEscaped")
     TestFromEscape("Length#20With#20Spaces", "Length With Spaces");
 }
 
+TEST_CASE("testInternedNames")
+{
+    // Names constructed in different ways share the same data
+    PdfName name1("Type");
+    PdfName name2 = PdfName::FromEscaped("Type");
+    PdfName name3 = PdfName::FromRaw(string_view("Type"));
+    REQUIRE(name1.GetRawData().data() == PdfName::KeyType.GetRawData().data());
+    REQUIRE(name2.GetRawData().data() == PdfName::KeyType.GetRawData().data());
+    REQUIRE(name3.GetRawData().data() == PdfName::KeyType.GetRawData().data());
+    REQUIRE(name1 == name2);
+    REQUIRE(name1 != PdfName::KeySubtype);
+    REQUIRE(std::hash<PdfName>()(name1) == std::hash<PdfName>()(name2));
+
+    // Names that are not well-known are not interned,
+    // but still compare equal
+    PdfName subset1("ABCDEF+Arial");
+    PdfName subset2 = PdfName::FromEscaped("ABCDEF#2BArial");
+    REQUIRE(subset1.GetRawData().data() != subset2.GetRawData().data());
+    REQUIRE(subset1 == subset2);
+    REQUIRE(std::hash<PdfName>()(subset1) == std::hash<PdfName>()(subset2));
+
+    string longStr(100, 'A');
+    PdfName long1(longStr);
+    PdfName long2 = PdfName::FromRaw(longStr);
+    REQUIRE(long1.GetRawData().data() != long2.GetRawData().data());
+    REQUIRE(long1 == long2);
+    REQUIRE(std::hash<PdfName>()(long1) == std::hash<PdfName>()(long2));
+    REQUIRE(long1 != PdfName::KeyType);
+
+    // Non ascii names keep the utf8 representation
+    PdfName utf8Name("Andr\xC3\xA9");
+    REQUIRE(utf8Name.GetString() == "Andr\xC3\xA9");
+    REQUIRE(PdfName::FromRaw(utf8Name.GetRawData()) == utf8Name);
+    REQUIRE(PdfName::FromRaw(utf8Name.GetRawData()).GetString() == "Andr\xC3\xA9");
+
+    REQUIRE(PdfName().IsNull());
+    REQUIRE(PdfName() == PdfName::KeyNull);
+}
+
 //
 // Test encoding of names.
 // pszString : internal representation, ie unencoded name
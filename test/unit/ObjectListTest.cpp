@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include <PdfTest.h>
+
+using namespace std;
+using namespace mm;
+
+TEST_CASE("testObjectLookup")
+{
+    PdfMemDocument doc;
+    auto& objects = doc.GetObjects();
+    auto& obj1 = objects.CreateDictionaryObject();
+    auto& obj2 = objects.CreateArrayObject();
+    auto ref1 = obj1.GetIndirectReference();
+    auto ref2 = obj2.GetIndirectReference();
+
+    REQUIRE(objects.GetObject(ref1) == &obj1);
+    REQUIRE(objects.GetObject(ref2) == &obj2);
+
+    // Same object number, different generation
+    REQUIRE(objects.GetObject(PdfReference(ref1.ObjectNumber(), ref1.GenerationNumber() + 1)) == nullptr);
+    // Out of range object number
+    REQUIRE(objects.GetObject(PdfReference(objects.GetObjectCount() + 1000, 0)) == nullptr);
+
+    unsigned size = objects.GetSize();
+    auto removed = objects.RemoveObject(ref1);
+    REQUIRE(removed.get() == &obj1);
+    REQUIRE(objects.GetObject(ref1) == nullptr);
+    REQUIRE(objects.GetSize() == size - 1);
+
+    // The removed object number is reused with an incremented generation
+    auto& obj3 = objects.CreateDictionaryObject();
+    REQUIRE(obj3.GetIndirectReference().ObjectNumber() == ref1.ObjectNumber());
+    REQUIRE(obj3.GetIndirectReference().GenerationNumber() == ref1.GenerationNumber() + 1);
+    REQUIRE(objects.GetObject(obj3.GetIndirectReference()) == &obj3);
+    REQUIRE(objects.GetObject(ref1) == nullptr);
+
+    auto replaced = objects.ReplaceObject(ref2, new PdfObject(PdfDictionary()));
+    REQUIRE(replaced.get() == &obj2);
+    REQUIRE(objects.MustGetObject(ref2).IsDictionary());
+    REQUIRE(objects.GetSize() == size);
+}
+
+TEST_CASE("testObjectIteration")
+{
+    PdfMemDocument doc;
+    auto& objects = doc.GetObjects();
+    vector<PdfReference> refs;
+    for (unsigned i = 0; i < 100; i++)
+        refs.push_back(objects.CreateDictionaryObject().GetIndirectReference());
+
+    // Leave some holes in the list
+    for (unsigned i = 0; i < refs.size(); i += 3)
+        (void)objects.RemoveObject(refs[i]);
+
+    unsigned count = 0;
+    uint32_t prevObjNum = 0;
+    for (auto obj : objects)
+    {
+        REQUIRE(obj != nullptr);
+        REQUIRE(obj->GetIndirectReference().ObjectNumber() > prevObjNum);
+        prevObjNum = obj->GetIndirectReference().ObjectNumber();
+        count++;
+    }
+    REQUIRE(count == objects.GetSize());
+    REQUIRE(count == objects.size());
+
+    unsigned reverseCount = 0;
+    prevObjNum = numeric_limits<uint32_t>::max();
+    for (auto it = objects.rbegin(); it != objects.rend(); it++)
+    {
+        REQUIRE((*it)->GetIndirectReference().ObjectNumber() < prevObjNum);
+        prevObjNum = (*it)->GetIndirectReference().ObjectNumber();
+        reverseCount++;
+    }
+    REQUIRE(reverseCount == count);
+}
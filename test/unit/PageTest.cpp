@@ -35,3 +35,19 @@ TEST_CASE("testEmptyContentsStream")
     auto& pageObj = page2.GetObject();
     REQUIRE(!pageObj.GetDictionary().HasKey("Contents"));
 }
+
+TEST_CASE("testResourcesAfterAddingKeys")
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    auto& resources = page.GetOrCreateResources();
+
+    // Adding keys to the page dictionary must not
+    // invalidate the cached resources dictionary
+    auto& dict = page.GetObject().GetDictionary();
+    for (unsigned i = 0; i < 64; i++)
+        dict.AddKey(PdfName(utls::Format("Key{}", i)), PdfObject(static_cast<int64_t>(i)));
+
+    resources.GetDictionary().AddKey("Test", PdfObject(true));
+    REQUIRE(dict.MustFindKey("Resources").GetDictionary().HasKey("Test"));
+}
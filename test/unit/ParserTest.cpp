@@ -21,6 +21,7 @@
 #include <limits>
 
 #include <sstream>
+#include <thread>
 
 #include <PdfTest.h>
 
@@ -28,6 +29,7 @@ using namespace std;
 using namespace mm;
 
 static string generateXRefEntries(size_t count);
+static string generateObjects(unsigned objectCount, unsigned brokenObjNum = 0);
 static bool canOutOfMemoryKillUnitTests();
 static void testReadXRefSubsection();
 static size_t getStackOverflowDepth();
@@ -1983,6 +1985,409 @@ TEST_CASE("testSaveIncrementalRoundTrip")
     }
 }
 
+TEST_CASE("testLoadObjectsConcurrently")
+{
+    // Generate a document with enough objects to be split
+    // in several chunks among the loading threads
+    constexpr unsigned objectCount = 1000;
+    string buffer = generateObjects(objectCount);
+
+    PdfIndirectObjectList serialObjects;
+    PdfParser serialParser(serialObjects);
+    SpanStreamDevice serialDevice(buffer);
+    serialParser.Parse(serialDevice, false);
+
+    PdfIndirectObjectList objects;
+    PdfParser parser(objects);
+    parser.SetLoadThreadCount(4);
+    SpanStreamDevice device(buffer);
+    parser.Parse(device, false);
+
+    REQUIRE(serialObjects.GetSize() == objectCount);
+    REQUIRE(objects.GetSize() == objectCount);
+    string expected;
+    string actual;
+    for (auto obj : serialObjects)
+    {
+        auto other = objects.GetObject(obj->GetIndirectReference());
+        REQUIRE(other != nullptr);
+        obj->ToString(expected);
+        other->ToString(actual);
+        REQUIRE(actual == expected);
+        REQUIRE(obj->HasStream() == other->HasStream());
+        if (obj->HasStream())
+            REQUIRE(obj->GetStream()->GetCopy() == other->GetStream()->GetCopy());
+    }
+}
+
+TEST_CASE("testLoadObjectsConcurrentlyBroken")
+{
+    // The error raised by an object parsed in a
+    // worker thread must reach the caller
+    string buffer = generateObjects(1000, 500);
+
+    PdfIndirectObjectList serialObjects;
+    PdfParser serialParser(serialObjects);
+    SpanStreamDevice serialDevice(buffer);
+    REQUIRE_THROWS_AS(serialParser.Parse(serialDevice, false), PdfError);
+
+    PdfIndirectObjectList objects;
+    PdfParser parser(objects);
+    parser.SetLoadThreadCount(4);
+    SpanStreamDevice device(buffer);
+    try
+    {
+        parser.Parse(device, false);
+        FAIL("Should throw exception");
+    }
+    catch (PdfError& error)
+    {
+        // The error tells which object failed to load
+        bool found = false;
+        for (auto& info : error.GetCallstack())
+        {
+            if (info.GetInformation().find("Error while loading object 500 0 R") != string::npos)
+                found = true;
+        }
+        REQUIRE(found);
+    }
+}
+
+TEST_CASE("testLoadFrozenConcurrently")
+{
+    charbuff buffer;
+    vector<PdfReference> refs;
+    {
+        PdfMemDocument doc;
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        for (unsigned i = 0; i < 1000; i++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject("Test");
+            obj.GetDictionary().AddKey("Index", (int64_t)i);
+            if (i % 2 == 0)
+                obj.GetOrCreateStream().SetData(utls::Format("Stream {}", i));
+            doc.GetCatalog().GetDictionary().AddKey(PdfName(utls::Format("Test{}", i)), obj.GetIndirectReference());
+            refs.push_back(obj.GetIndirectReference());
+        }
+
+        StringStreamDevice device(buffer);
+        doc.Save(device, PdfSaveOptions::ObjectStreams);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    doc.Freeze();
+
+    // All the threads load the same objects, plain
+    // and compressed in object streams, at once
+    atomic<unsigned> errorCount(0);
+    vector<thread> threads;
+    for (unsigned i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&]()
+        {
+            for (unsigned j = 0; j < refs.size(); j++)
+            {
+                auto& obj = doc.GetObjects().MustGetObject(refs[j]);
+                if (obj.GetDictionary().MustFindKey("Index").GetNumber() != (int64_t)j)
+                    errorCount++;
+
+                if (j % 2 == 0 && obj.MustGetStream().GetCopy() != utls::Format("Stream {}", j))
+                    errorCount++;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(errorCount == 0);
+}
+
+TEST_CASE("testLoadCompressedObjectsOnDemand")
+{
+    // Generate a document with the catalog, the pages and another
+    // object compressed in an object stream, referenced by an XRef stream
+    ostringstream oss;
+    oss << "%PDF-1.5\n";
+
+    string catalog = "<< /Type /Catalog /Pages 2 0 R >> ";
+    string pages = "<< /Type /Pages /Kids [ ] /Count 0 >> ";
+    string objects = catalog + pages + "<< /Value 42 >>";
+    string header = utls::Format("1 0 2 {} 4 {} ", catalog.length(), catalog.length() + pages.length());
+    size_t objStmOffset = oss.tellp();
+    oss << "3 0 obj\n";
+    oss << "<< /Type /ObjStm /N 3 /First " << header.length() << " /Length " << header.length() + objects.length() << " >>\n";
+    oss << "stream\n";
+    oss << header << objects << "\n";
+    oss << "endstream\n";
+    oss << "endobj\n";
+
+    size_t xrefOffset = oss.tellp();
+    string xrefEntries;
+    xrefEntries += "00 00000000 FFFF\n";
+    xrefEntries += "02 00000003 0000\n";
+    xrefEntries += "02 00000003 0001\n";
+    xrefEntries += utls::Format("01 {:08X} 0000\n", objStmOffset);
+    // Wrong index in the object stream, the object must be searched
+    xrefEntries += "02 00000003 0007\n";
+    xrefEntries += utls::Format("01 {:08X} 0000\n", xrefOffset);
+    oss << "5 0 obj\n";
+    oss << "<< /Type /XRef /Size 6 /W [ 1 4 2 ] /Root 1 0 R /Filter /ASCIIHexDecode /Length " << xrefEntries.length() << " >>\n";
+    oss << "stream\n";
+    oss << xrefEntries;
+    oss << "endstream\n";
+    oss << "endobj\n";
+    oss << "startxref\n" << xrefOffset << "\n%%EOF\n";
+    string buffer = oss.str();
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    auto& objs = doc.GetObjects();
+    auto obj = objs.GetObject(PdfReference(4, 0));
+    REQUIRE(obj != nullptr);
+    REQUIRE(!obj->IsDelayedLoadDone());
+    REQUIRE(obj->GetDictionary().MustFindKey("Value").GetNumber() == 42);
+    REQUIRE(obj->IsDelayedLoadDone());
+    REQUIRE(doc.GetPages().GetCount() == 0);
+    REQUIRE(objs.MustGetObject(PdfReference(1, 0)).GetDictionary().MustFindKey("Type").GetName() == "Catalog");
+
+    // Test loading all objects immediately. Remove /Root, as
+    // the catalog can't be resolved without a document. The
+    // XRef stream offset is not affected by the removal
+    string key = "/Root 1 0 R ";
+    buffer.erase(buffer.find(key), key.length());
+    PdfIndirectObjectList objects2;
+    PdfParser parser(objects2);
+    SpanStreamDevice device(buffer);
+    parser.Parse(device, false);
+    obj = objects2.GetObject(PdfReference(4, 0));
+    REQUIRE(obj != nullptr);
+    REQUIRE(obj->IsDelayedLoadDone());
+    REQUIRE(obj->GetDictionary().MustFindKey("Value").GetNumber() == 42);
+
+    // A compressed object removed from the list can't be
+    // loaded anymore after the list has been cleared
+    PdfMemDocument doc2;
+    doc2.LoadFromBuffer(oss.str());
+    auto removed = doc2.GetObjects().RemoveObject(PdfReference(4, 0));
+    REQUIRE(removed != nullptr);
+    REQUIRE(!removed->IsDelayedLoadDone());
+    doc2.LoadFromBuffer(oss.str());
+    ASSERT_THROW_WITH_ERROR_CODE(removed->GetDictionary(), PdfErrorCode::InvalidHandle);
+}
+
+TEST_CASE("testSaveObjectStreamsRoundTrip")
+{
+    auto testRoundTrip = [](bool encrypted)
+    {
+        charbuff buffer;
+        vector<PdfReference> refs;
+        {
+            PdfMemDocument doc;
+            doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+            if (encrypted)
+                doc.SetEncrypted("user", "owner");
+
+            for (unsigned i = 0; i < 250; i++)
+            {
+                auto& obj = doc.GetObjects().CreateDictionaryObject("Test");
+                obj.GetDictionary().AddKey("Index", (int64_t)i);
+                obj.GetDictionary().AddKey("Text", PdfString(utls::Format("String {}", i)));
+                if (i % 50 == 0)
+                    obj.GetOrCreateStream().SetData(utls::Format("Stream data {}", i));
+
+                // Reference the objects from the catalog to
+                // prevent them to be garbage collected
+                doc.GetCatalog().GetDictionary().AddKey(PdfName(utls::Format("Test{}", i)), obj.GetIndirectReference());
+                refs.push_back(obj.GetIndirectReference());
+            }
+
+            StringStreamDevice device(buffer);
+            doc.Save(device, PdfSaveOptions::ObjectStreams);
+        }
+
+        REQUIRE(string_view(buffer.data(), buffer.size()).find("/ObjStm") != string_view::npos);
+
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer, encrypted ? "user" : "");
+        REQUIRE(doc.GetPages().GetCount() == 1);
+        for (unsigned i = 0; i < refs.size(); i++)
+        {
+            auto& obj = doc.GetObjects().MustGetObject(refs[i]);
+            REQUIRE(obj.GetDictionary().MustFindKey("Index").GetNumber() == (int64_t)i);
+            REQUIRE(obj.GetDictionary().MustFindKey("Text").GetString().GetString() == utls::Format("String {}", i));
+            if (i % 50 == 0)
+                REQUIRE(obj.MustGetStream().GetCopy() == utls::Format("Stream data {}", i));
+        }
+    };
+
+    testRoundTrip(false);
+    testRoundTrip(true);
+}
+
+TEST_CASE("testSaveObjectStreamsVersion")
+{
+    // Object streams require PDF 1.5, also if a lower
+    // version is set before or after the save options
+    PdfMemDocument doc;
+    doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    doc.GetMetadata().SetPdfVersion(PdfVersion::V1_3);
+    charbuff buffer;
+    StringStreamDevice device(buffer);
+    doc.Save(device, PdfSaveOptions::ObjectStreams);
+    REQUIRE(buffer.substr(0, 8) == "%PDF-1.5");
+
+    PdfMemDocument doc2;
+    doc2.LoadFromBuffer(buffer);
+    REQUIRE(doc2.GetMetadata().GetPdfVersion() == PdfVersion::V1_5);
+
+    PdfWriter writer(doc.GetObjects(), doc.GetTrailer().GetObject());
+    writer.SetSaveOptions(PdfSaveOptions::ObjectStreams);
+    writer.SetPdfVersion(PdfVersion::V1_4);
+    REQUIRE(writer.GetPdfVersion() == PdfVersion::V1_5);
+    writer.SetPdfVersion(PdfVersion::V1_7);
+    REQUIRE(writer.GetPdfVersion() == PdfVersion::V1_7);
+
+    writer.SetUseXRefStream(false);
+    writer.SetPdfVersion(PdfVersion::V1_4);
+    REQUIRE(writer.GetPdfVersion() == PdfVersion::V1_4);
+}
+
+TEST_CASE("testSaveParallelCompress")
+{
+    auto getData = [](unsigned i)
+    {
+        string data;
+        for (unsigned j = 0; j < 1000; j++)
+            data.append(utls::Format("Stream {} line {}\n", i, j));
+        return data;
+    };
+
+    auto save = [&](PdfSaveOptions opts)
+    {
+        PdfMemDocument doc;
+        // The /ID is computed from the Info dictionary, so a fixed
+        // creation date makes the whole output reproducible
+        doc.GetMetadata().SetCreationDate(PdfDate(chrono::seconds(1000000000), chrono::minutes(0)));
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        for (unsigned i = 0; i < 100; i++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject("Test");
+            obj.GetDictionary().AddKey("Index", (int64_t)i);
+            obj.GetOrCreateStream().SetData(getData(i));
+            doc.GetCatalog().GetDictionary().AddKey(PdfName(utls::Format("Test{}", i)), obj.GetIndirectReference());
+        }
+
+        charbuff buffer;
+        StringStreamDevice device(buffer);
+        doc.Save(device, opts | PdfSaveOptions::NoModifyDateUpdate);
+        return buffer;
+    };
+
+    for (auto opts : { PdfSaveOptions::None, PdfSaveOptions::ObjectStreams })
+    {
+        // The compressed streams are the same of a sequential
+        // save, so the output is identical
+        charbuff expected = save(opts);
+        REQUIRE(save(opts) == expected);
+        charbuff buffer = save(opts | PdfSaveOptions::ParallelCompress);
+        REQUIRE(buffer == expected);
+
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer);
+        REQUIRE(doc.GetPages().GetCount() == 1);
+        for (unsigned i = 0; i < 100; i++)
+        {
+            auto& obj = doc.GetCatalog().GetDictionary().MustFindKey(PdfName(utls::Format("Test{}", i)));
+            REQUIRE(obj.GetDictionary().MustFindKey("Index").GetNumber() == (int64_t)i);
+            auto& stream = obj.MustGetStream();
+            REQUIRE(stream.GetFilters().size() == 1);
+            REQUIRE(stream.GetCopy() == getData(i));
+        }
+    }
+}
+
+TEST_CASE("testLoadWithArenaAllocation")
+{
+    charbuff buffer;
+    vector<PdfReference> refs;
+    {
+        PdfMemDocument doc;
+        doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        for (unsigned i = 0; i < 1000; i++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject("Test");
+            obj.GetDictionary().AddKey("Index", (int64_t)i);
+            PdfArray arr;
+            arr.Add(PdfString(utls::Format("String {}", i)));
+            arr.Add(PdfName(utls::Format("Name{}", i)));
+            obj.GetDictionary().AddKey("Array", arr);
+            doc.GetCatalog().GetDictionary().AddKey(PdfName(utls::Format("Test{}", i)), obj.GetIndirectReference());
+            refs.push_back(obj.GetIndirectReference());
+        }
+
+        StringStreamDevice device(buffer);
+        doc.Save(device, PdfSaveOptions::ObjectStreams);
+    }
+
+    {
+        PdfMemDocument doc;
+        doc.SetUseArenaAllocation(true);
+        doc.LoadFromBuffer(buffer);
+        REQUIRE(doc.GetPages().GetCount() == 1);
+        for (unsigned i = 0; i < refs.size(); i++)
+        {
+            auto& obj = doc.GetObjects().MustGetObject(refs[i]);
+            REQUIRE(obj.GetDictionary().MustFindKey("Index").GetNumber() == (int64_t)i);
+            auto& arr = obj.GetDictionary().MustFindKey("Array").GetArray();
+            REQUIRE(arr[0].GetString().GetString() == utls::Format("String {}", i));
+            REQUIRE(arr[1].GetName().GetString() == utls::Format("Name{}", i));
+        }
+
+        // Copies of the objects don't use the arena
+        unique_ptr<PdfObject> removed = doc.GetObjects().RemoveObject(refs[10]);
+        REQUIRE(removed != nullptr);
+        PdfObject copy(*removed);
+        removed.reset();
+
+        // Loading again frees the previous arena
+        doc.LoadFromBuffer(buffer);
+        REQUIRE(doc.GetObjects().MustGetObject(refs[10]).GetDictionary().MustFindKey("Index").GetNumber() == 10);
+        REQUIRE(copy.GetDictionary().MustFindKey("Array").GetArray()[1].GetName() == "Name10");
+    }
+}
+
+TEST_CASE("testArenaAllocation")
+{
+    PdfArena arena;
+    REQUIRE(arena.GetSize() == 0);
+    {
+        PdfArenaScope scope(&arena);
+        unique_ptr<PdfObject> obj1(new PdfObject(PdfDictionary()));
+        size_t size = arena.GetSize();
+        REQUIRE(size != 0);
+
+        // Objects are bump allocated in the chunk of the thread
+        unique_ptr<PdfObject> obj2(new PdfObject(PdfArray()));
+        REQUIRE(arena.GetSize() == size);
+        REQUIRE((char*)obj2.get() > (char*)obj1.get());
+
+        // Every thread allocates in its own chunk
+        std::thread([&arena]()
+        {
+            PdfArenaScope scope(&arena);
+            unique_ptr<PdfObject> obj3(new PdfObject(PdfDictionary()));
+        }).join();
+        REQUIRE(arena.GetSize() == 2 * size);
+
+        // Objects are allocated on the global heap outside arena scopes
+        PdfArenaScope heapScope(nullptr);
+        unique_ptr<PdfObject> obj4(new PdfObject(PdfDictionary()));
+        REQUIRE(arena.GetSize() == 2 * size);
+    }
+}
+
 // CVE-2018-8002, CVE-2021-30470
 TEST_CASE("testNestedArrays")
 {
@@ -2699,6 +3104,41 @@ TEST_CASE("testLoopingOutlines")
     }
 }
 
+string generateObjects(unsigned objectCount, unsigned brokenObjNum)
+{
+    ostringstream oss;
+    vector<size_t> offsets;
+    oss << "%PDF-1.7\n";
+    for (unsigned i = 1; i <= objectCount; i++)
+    {
+        offsets.push_back(oss.str().length());
+        if (i == brokenObjNum)
+            oss << i << " 0 broken\n";
+        else
+            oss << i << " 0 obj\n";
+        oss << "<< /Index " << i << " /Name /Name" << i << " /Values [ 1.5 (Str) <414243> " << i << " 0 R ]";
+        if (i % 10 == 0)
+        {
+            string data = utls::Format("Stream data {}", i);
+            oss << " /Length " << data.length() << " >>\nstream\n" << data << "\nendstream\n";
+        }
+        else
+        {
+            oss << " >>\n";
+        }
+        oss << "endobj\n";
+    }
+
+    size_t xrefOffset = oss.str().length();
+    oss << "xref\n0 " << objectCount + 1 << "\n";
+    oss << "0000000000 65535 f\r\n";
+    for (size_t offset : offsets)
+        oss << utls::Format("{:010d} 00000 n\r\n", offset);
+    oss << "trailer << /Size " << objectCount + 1 << " >>\n";
+    oss << "startxref\n" << xrefOffset << "\n%%EOF\n";
+    return oss.str();
+}
+
 string generateXRefEntries(size_t count)
 {
     string strXRefEntries;
@@ -0,0 +1,250 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include <PdfTest.h>
+
+using namespace std;
+using namespace mm;
+
+namespace
+{
+    // A signer that just collects the signed data
+    class TestSigner : public PdfSigner
+    {
+    public:
+        TestSigner(unsigned id = 0)
+            : Id(id), DryRunCount(0) { }
+
+        void Reset() override
+        {
+            Data.clear();
+        }
+
+        void AppendData(const bufferview& data) override
+        {
+            Data.append(data.data(), data.size());
+        }
+
+        void ComputeSignature(charbuff& buffer, bool dryrun) override
+        {
+            if (dryrun)
+            {
+                buffer.resize(32);
+                DryRunCount++;
+            }
+            else
+                buffer = utls::Format("Signer {} signed {} bytes", Id, Data.size());
+        }
+
+        string GetSignatureSubFilter() const override
+        {
+            return "adbe.pkcs7.detached";
+        }
+
+        string GetSignatureType() const override
+        {
+            return "Sig";
+        }
+
+    public:
+        unsigned Id;
+        unsigned DryRunCount;
+        charbuff Data;
+    };
+
+    // A write only device that can't seek
+    class SequentialDevice : public OutputStreamDevice
+    {
+    public:
+        SequentialDevice(charbuff& buffer)
+            : m_buffer(&buffer) { }
+
+        size_t GetLength() const override { return m_buffer->size(); }
+
+        size_t GetPosition() const override { return m_buffer->size(); }
+
+        bool Eof() const override { return true; }
+
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override
+        {
+            m_buffer->append(buffer, size);
+        }
+
+    private:
+        charbuff* m_buffer;
+    };
+}
+
+static void createDocument(charbuff& buffer);
+static void testSignedDocument(const charbuff& original, const charbuff& signedDoc, const TestSigner& signer);
+
+TEST_CASE("testSignDocument")
+{
+    charbuff original;
+    createDocument(original);
+
+    // Sign the document in place
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(original);
+        auto& signature = static_cast<PdfSignature&>(doc.GetAcroForm()->GetFieldAt(0));
+        charbuff buffer = original;
+        ContainerStreamDevice<charbuff> device(buffer);
+        TestSigner signer;
+        SignDocument(doc, device, signer, signature);
+        testSignedDocument(original, buffer, signer);
+    }
+
+    // Sign a file in place
+    {
+        auto path = TestUtils::GetTestOutputFilePath("testSignDocument.pdf");
+        {
+            FileStreamDevice output(path, FileMode::Create);
+            output.Write(original);
+        }
+
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(original);
+        auto& signature = static_cast<PdfSignature&>(doc.GetAcroForm()->GetFieldAt(0));
+        TestSigner signer;
+        {
+            FileStreamDevice device(path, FileMode::Open, DeviceAccess::ReadWrite);
+            SignDocument(doc, device, signer, signature);
+        }
+
+        charbuff buffer;
+        utls::ReadTo(buffer, path);
+        testSignedDocument(original, buffer, signer);
+    }
+
+    // Sign the document to a write only device
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(original);
+        auto& signature = static_cast<PdfSignature&>(doc.GetAcroForm()->GetFieldAt(0));
+        charbuff buffer;
+        SequentialDevice output(buffer);
+        ContainerStreamDevice<charbuff> input(original);
+        TestSigner signer;
+        SignDocument(doc, input, output, signer, signature);
+        testSignedDocument(original, buffer, signer);
+    }
+
+    // Sign the document with more signers at once
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(original);
+        auto& signature = static_cast<PdfSignature&>(doc.GetAcroForm()->GetFieldAt(0));
+        ContainerStreamDevice<charbuff> input(original);
+        vector<TestSigner> signers;
+        vector<charbuff> buffers(20);
+        vector<unique_ptr<SequentialDevice>> devices;
+        vector<PdfSigner*> signerPtrs;
+        vector<OutputStreamDevice*> outputs;
+        for (unsigned i = 0; i < buffers.size(); i++)
+        {
+            signers.push_back(TestSigner(i));
+            devices.push_back(std::make_unique<SequentialDevice>(buffers[i]));
+            outputs.push_back(devices[i].get());
+        }
+
+        for (auto& signer : signers)
+            signerPtrs.push_back(&signer);
+
+        SignDocumentBatch(doc, input, signerPtrs, outputs, signature);
+        for (unsigned i = 0; i < buffers.size(); i++)
+            testSignedDocument(original, buffers[i], signers[i]);
+    }
+}
+
+TEST_CASE("testSignatureSize")
+{
+    charbuff original;
+    createDocument(original);
+    auto sign = [&](TestSigner& signer)
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(original);
+        auto& signature = static_cast<PdfSignature&>(doc.GetAcroForm()->GetFieldAt(0));
+        charbuff buffer;
+        SequentialDevice output(buffer);
+        ContainerStreamDevice<charbuff> input(original);
+        SignDocument(doc, input, output, signer, signature);
+        testSignedDocument(original, buffer, signer);
+    };
+
+    // The size inferred with the dry run is reused
+    TestSigner signer;
+    sign(signer);
+    sign(signer);
+    REQUIRE(signer.DryRunCount == 1);
+    REQUIRE(signer.GetSignatureSize() == 32);
+
+    // A precomputed size skips the dry run
+    TestSigner presized;
+    presized.SetSignatureSize(64);
+    sign(presized);
+    REQUIRE(presized.DryRunCount == 0);
+
+    // The signature must fit the precomputed size
+    TestSigner undersized;
+    undersized.SetSignatureSize(8);
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(original);
+    auto& signature = static_cast<PdfSignature&>(doc.GetAcroForm()->GetFieldAt(0));
+    charbuff buffer;
+    SequentialDevice output(buffer);
+    ContainerStreamDevice<charbuff> input(original);
+    REQUIRE_THROWS(SignDocument(doc, input, output, undersized, signature));
+}
+
+void createDocument(charbuff& buffer)
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+    (void)page.CreateField<PdfSignature>("Signature", PdfRect());
+
+    // Add enough data to be hashed in more steps
+    string data;
+    for (unsigned i = 0; data.size() < 3000000; i++)
+        data.append(utls::Format("Data {}\n", i));
+
+    auto& obj = doc.GetObjects().CreateDictionaryObject();
+    obj.GetOrCreateStream().SetData(data, true);
+    doc.GetCatalog().GetDictionary().AddKeyIndirect("Test", obj);
+    StringStreamDevice device(buffer);
+    doc.Save(device, PdfSaveOptions::NoFlateCompress);
+    REQUIRE(buffer.size() > 3000000);
+}
+
+void testSignedDocument(const charbuff& original, const charbuff& signedDoc, const TestSigner& signer)
+{
+    REQUIRE(signedDoc.size() > original.size());
+    REQUIRE(string_view(signedDoc.data(), original.size()) == original);
+
+    string_view view(signedDoc.data(), signedDoc.size());
+    size_t pos = view.find("/ByteRange");
+    REQUIRE(pos != string_view::npos);
+    size_t byteRange[4];
+    REQUIRE(std::sscanf(view.data() + pos, "/ByteRange[ %zu %zu %zu %zu]",
+        &byteRange[0], &byteRange[1], &byteRange[2], &byteRange[3]) == 4);
+    REQUIRE(byteRange[0] == 0);
+    REQUIRE(byteRange[2] + byteRange[3] == signedDoc.size());
+
+    // The signed data is everything but the /Contents
+    string expected(view.substr(0, byteRange[1]));
+    expected.append(view.substr(byteRange[2], byteRange[3]));
+    REQUIRE(signer.Data == expected);
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(signedDoc);
+    auto& signature = doc.GetAcroForm()->GetFieldAt(0).GetDictionary().MustFindKey("V").GetDictionary();
+    auto contents = signature.MustFindKey("Contents").GetString().GetRawData();
+    auto expectedContents = utls::Format("Signer {} signed {} bytes", signer.Id, expected.size());
+    REQUIRE(string_view(contents.data(), contents.size()).substr(0, expectedContents.size()) == expectedContents);
+}
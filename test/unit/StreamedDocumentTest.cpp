@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2022 by Francesco Pretto <ceztko@gmail.com>
+ *
+ * Licensed under GNU Library General Public 2.0 or later.
+ * Some rights reserved. See COPYING, AUTHORS.
+ */
+
+#include <PdfTest.h>
+
+using namespace std;
+using namespace mm;
+
+static string getStreamData(unsigned index, size_t size);
+
+TEST_CASE("testStreamedDocument")
+{
+    auto test = [](PdfSaveOptions opts, PdfEncrypt* encrypt)
+    {
+        charbuff buffer;
+        vector<PdfReference> refs;
+        {
+            auto device = std::make_shared<StringStreamDevice>(buffer);
+            PdfStreamedDocument doc(device, PdfVersion::V1_5, encrypt, opts);
+            for (unsigned i = 0; i < 10; i++)
+            {
+                auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+                PdfPainter painter;
+                painter.SetCanvas(page);
+                painter.DrawLine(0, 0, 100, 100 + i);
+                painter.FinishDrawing();
+
+                // Flush half of the pages, which are released
+                if (i % 2 == 0)
+                {
+                    doc.FlushPage(page);
+                    REQUIRE(page.GetObject().GetDictionary().GetSize() == 1);
+
+                    // The cached wrappers are dropped and the
+                    // page can't be modified anymore
+                    REQUIRE(page.GetResources() == nullptr);
+                    REQUIRE(page.GetContents() == nullptr);
+                    ASSERT_THROW_WITH_ERROR_CODE(page.GetOrCreateResources(), PdfErrorCode::InvalidHandle);
+                    PdfPainter flushedPainter;
+                    flushedPainter.SetCanvas(page);
+                    ASSERT_THROW_WITH_ERROR_CODE(flushedPainter.DrawLine(0, 0, 100, 100), PdfErrorCode::InvalidHandle);
+                }
+            }
+
+            // Write streams concurrently, the second one big
+            // enough to be spilled to a temporary file
+            auto& obj1 = doc.GetObjects().CreateDictionaryObject("Test");
+            auto& obj2 = doc.GetObjects().CreateDictionaryObject("Test");
+            auto& obj3 = doc.GetObjects().CreateDictionaryObject("Test");
+            auto& obj4 = doc.GetObjects().CreateDictionaryObject("Test");
+            refs = { obj1.GetIndirectReference(), obj2.GetIndirectReference(), obj3.GetIndirectReference(), obj4.GetIndirectReference() };
+            {
+                auto output1 = obj1.GetOrCreateStream().GetOutputStream();
+                auto output2 = obj2.GetOrCreateStream().GetOutputStreamRaw();
+                output1.Write(getStreamData(1, 1000));
+                output2.Write(getStreamData(2, 3000000));
+
+                // Flushed while the device is busy, so it's
+                // written after the stream of the first object
+                obj4.GetDictionary().AddKey("Value", PdfString("Flushed"));
+                doc.FlushObject(obj4);
+            }
+
+            // Written streams are released and can't be written again
+            REQUIRE(obj1.GetDictionary().GetSize() == 1);
+            ASSERT_THROW_WITH_ERROR_CODE(obj1.MustGetStream().GetOutputStream(), PdfErrorCode::NotImplemented);
+
+            // The stream of the last object is never written
+            (void)obj3.GetOrCreateStream();
+            doc.Close();
+        }
+
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(buffer, encrypt == nullptr ? "" : "user");
+        REQUIRE(doc.GetPages().GetCount() == 10);
+        for (unsigned i = 0; i < 10; i++)
+        {
+            auto contents = doc.GetPages().GetPageAt(i).GetContents()->GetCopy();
+            REQUIRE(string_view(contents.data(), contents.size()).find(utls::Format("100 {} l", 100 + i)) != string_view::npos);
+        }
+
+        REQUIRE(doc.GetObjects().MustGetObject(refs[0]).MustGetStream().GetCopy() == getStreamData(1, 1000));
+        REQUIRE(doc.GetObjects().MustGetObject(refs[1]).MustGetStream().GetCopy() == getStreamData(2, 3000000));
+        REQUIRE(doc.GetObjects().MustGetObject(refs[2]).MustGetStream().GetLength() == 0);
+        REQUIRE(doc.GetObjects().MustGetObject(refs[3]).GetDictionary().MustFindKey("Value").GetString().GetString() == "Flushed");
+    };
+
+    auto encrypt = PdfEncrypt::Create("user", "owner");
+    for (auto opts : { PdfSaveOptions::None, PdfSaveOptions::ObjectStreams })
+    {
+        test(opts, nullptr);
+        test(opts, encrypt.get());
+    }
+}
+
+string getStreamData(unsigned index, size_t size)
+{
+    string ret;
+    while (ret.size() < size)
+        ret.append(utls::Format("Stream {} offset {}\n", index, ret.size()));
+
+    return ret;
+}
@@ -8,6 +8,8 @@
 
 #include <PdfTest.h>
 
+#include <thread>
+
 using namespace std;
 using namespace mm;
 
@@ -32,3 +34,240 @@ TEST_CASE("TextExtraction1")
     ASSERT_EQUAL(entries[3].X, 29.000000232);
     ASSERT_EQUAL(entries[3].Y, 664.872605318981);
 }
+
+static void createTestDocument(charbuff& buffer, unsigned pageCount);
+
+TEST_CASE("TextExtractionFrozen")
+{
+    constexpr unsigned PageCount = 16;
+    charbuff buffer;
+    createTestDocument(buffer, PageCount);
+
+    auto extractText = [](PdfMemDocument& doc)
+    {
+        doc.Freeze();
+        REQUIRE(doc.IsFrozen());
+
+        // Extract the text of all the pages from multiple threads at once
+        vector<vector<PdfTextEntry>> results(PageCount);
+        vector<std::thread> threads;
+        for (unsigned i = 0; i < 4; i++)
+        {
+            threads.emplace_back([&doc, &results, i]() {
+                for (unsigned j = i; j < PageCount; j += 4)
+                    doc.GetPages().GetPageAt(j).ExtractTextTo(results[j]);
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (unsigned i = 0; i < PageCount; i++)
+        {
+            auto& entries = results[i];
+            REQUIRE(entries.size() == 2);
+            REQUIRE(entries[0].Text == "Page " + std::to_string(i));
+            REQUIRE(entries[1].Text == "Hello World");
+        }
+    };
+
+    // Objects are read from separate views of the buffer
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    extractText(doc);
+
+    // Reads from the shared file device are serialized
+    auto path = TestUtils::GetTestOutputFilePath("TextExtractionFrozen.pdf");
+    {
+        FileStreamDevice output(path, FileMode::Create);
+        output.Write(buffer);
+    }
+    PdfMemDocument fileDoc;
+    fileDoc.LoadFromDevice(std::make_shared<FileStreamDevice>(path));
+    extractText(fileDoc);
+}
+
+TEST_CASE("TextExtractionDocument")
+{
+    constexpr unsigned PageCount = 16;
+    charbuff buffer;
+    createTestDocument(buffer, PageCount);
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    vector<PdfTextEntry> entries;
+    doc.ExtractTextTo(entries, { }, { }, 4);
+    REQUIRE(!doc.IsFrozen());
+    REQUIRE(entries.size() == PageCount * 2);
+    for (unsigned i = 0; i < PageCount; i++)
+    {
+        REQUIRE(entries[i * 2].Page == (int)i);
+        REQUIRE(entries[i * 2].Text == "Page " + std::to_string(i));
+        REQUIRE(entries[i * 2 + 1].Page == (int)i);
+        REQUIRE(entries[i * 2 + 1].Text == "Hello World");
+    }
+
+    entries.clear();
+    doc.ExtractTextTo(entries, 3, 5, "Page", { }, 2);
+    REQUIRE(entries.size() == 5);
+    for (unsigned i = 0; i < 5; i++)
+        REQUIRE(entries[i].Text == "Page " + std::to_string(i + 3));
+
+    entries.clear();
+    ASSERT_THROW_WITH_ERROR_CODE(doc.ExtractTextTo(entries, 10, 7), PdfErrorCode::PageNotFound);
+
+    // The document is unfrozen also when the extraction fails
+    PdfTextExtractParams params;
+    params.Flags = PdfTextExtractFlags::RegexPattern;
+    REQUIRE_THROWS(doc.ExtractTextTo(entries, "[", params, 2));
+    REQUIRE(!doc.IsFrozen());
+}
+
+TEST_CASE("TextExtractionXObjectForm")
+{
+    charbuff buffer;
+    {
+        PdfMemDocument doc;
+        auto font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+        auto form = doc.CreateXObjectForm(PdfRect(0, 0, 200, 50));
+        PdfPainter painter;
+        painter.SetCanvas(*form);
+        painter.GetTextState().SetFont(*font, 12);
+        painter.DrawText("Header", 10, 10);
+        painter.FinishDrawing();
+
+        auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        painter.SetCanvas(page);
+        for (unsigned i = 0; i < 3; i++)
+            painter.DrawXObject(*form, 100, 100 + i * 200);
+
+        painter.FinishDrawing();
+        StringStreamDevice device(buffer);
+        doc.Save(device);
+    }
+
+    // The form is read every time it's invoked, even if it's decoded once
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    vector<PdfTextEntry> entries;
+    doc.GetPages().GetPageAt(0).ExtractTextTo(entries);
+    REQUIRE(entries.size() == 3);
+    for (unsigned i = 0; i < 3; i++)
+    {
+        REQUIRE(entries[i].Text == "Header");
+        ASSERT_EQUAL(entries[i].X, 110);
+        ASSERT_EQUAL(entries[i].Y, 110 + i * 200);
+    }
+}
+
+TEST_CASE("TextExtractionBigXObjectForm")
+{
+    charbuff buffer;
+    {
+        PdfMemDocument doc;
+        auto font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+        auto form = doc.CreateXObjectForm(PdfRect(0, 0, 200, 50));
+        PdfPainter painter;
+        painter.SetCanvas(*form);
+        painter.GetTextState().SetFont(*font, 12);
+        painter.DrawText("Header", 10, 10);
+        painter.FinishDrawing();
+
+        // Make the contents of the form bigger than the
+        // cache of the reader, splitting them in two parts
+        auto& stream = form->GetObject().MustGetStream();
+        auto contents = stream.GetCopy();
+        string bigContents = contents;
+        bigContents.append(17 * 1048576, ' ');
+        bigContents.append(contents);
+        stream.SetData(bigContents);
+
+        auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        painter.SetCanvas(page);
+        for (unsigned i = 0; i < 2; i++)
+            painter.DrawXObject(*form, 100, 100 + i * 200);
+
+        painter.FinishDrawing();
+        StringStreamDevice device(buffer);
+        doc.Save(device);
+    }
+
+    // The form is too big to be cached, and it's read incrementally
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    vector<PdfTextEntry> entries;
+    doc.GetPages().GetPageAt(0).ExtractTextTo(entries);
+    REQUIRE(entries.size() == 4);
+    for (unsigned i = 0; i < 4; i++)
+    {
+        REQUIRE(entries[i].Text == "Header");
+        ASSERT_EQUAL(entries[i].X, 110);
+        ASSERT_EQUAL(entries[i].Y, 110 + (i / 2) * 200);
+    }
+}
+
+TEST_CASE("TextSearchPattern")
+{
+    size_t pos;
+    PdfTextSearchPattern literal("World");
+    REQUIRE(literal.IsMatch("Hello World"));
+    REQUIRE(!literal.IsMatch("Hello world"));
+    REQUIRE(literal.TryFind("Hello World!", pos));
+    REQUIRE(pos == 6);
+    REQUIRE(!literal.TryFind("Worl", pos));
+
+    PdfTextSearchPattern ignoreCase("WORLD", PdfTextExtractFlags::IgnoreCase);
+    REQUIRE(ignoreCase.IsMatch("hello world"));
+    REQUIRE(ignoreCase.TryFind("Hello wOrLd", pos));
+    REQUIRE(pos == 6);
+
+    PdfTextSearchPattern wholeWord("world", PdfTextExtractFlags::IgnoreCase | PdfTextExtractFlags::MatchWholeWord);
+    REQUIRE(wholeWord.IsMatch("World"));
+    REQUIRE(!wholeWord.IsMatch("Hello World"));
+    REQUIRE(wholeWord.TryFind("Hello World, bye", pos));
+    REQUIRE(pos == 6);
+    REQUIRE(!wholeWord.TryFind("Hello Worlds", pos));
+
+    PdfTextSearchPattern regex("^Page [0-9]+$", PdfTextExtractFlags::RegexPattern);
+    REQUIRE(regex.IsRegex());
+    REQUIRE(regex.IsMatch("Page 12"));
+    REQUIRE(!regex.IsMatch("Page 12 of 20"));
+    ASSERT_THROW_WITH_ERROR_CODE(PdfTextSearchPattern("a", PdfTextExtractFlags::RegexPattern | PdfTextExtractFlags::MatchWholeWord),
+        PdfErrorCode::NotImplemented);
+
+    // The same compiled pattern can be used for multiple pages
+    charbuff buffer;
+    createTestDocument(buffer, 3);
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(buffer);
+    PdfTextSearchPattern pattern("hello", PdfTextExtractFlags::IgnoreCase);
+    PdfTextExtractParams params;
+    params.Flags = PdfTextExtractFlags::ExtractSubstring;
+    for (unsigned i = 0; i < 3; i++)
+    {
+        vector<PdfTextEntry> entries;
+        doc.GetPages().GetPageAt(i).ExtractTextTo(entries, pattern, params);
+        REQUIRE(entries.size() == 1);
+        REQUIRE(entries[0].Text == "Hello");
+        ASSERT_EQUAL(entries[0].X, 100);
+    }
+}
+
+void createTestDocument(charbuff& buffer, unsigned pageCount)
+{
+    PdfMemDocument doc;
+    auto font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+    for (unsigned i = 0; i < pageCount; i++)
+    {
+        PdfPainter painter;
+        auto& page = doc.GetPages().CreatePage(PdfPage::CreateStandardPageSize(PdfPageSize::A4));
+        painter.SetCanvas(page);
+        painter.GetTextState().SetFont(*font, 12);
+        painter.DrawText("Page " + std::to_string(i), 100, 600);
+        painter.DrawText("Hello World", 100, 500);
+        painter.FinishDrawing();
+    }
+
+    StringStreamDevice device(buffer);
+    doc.Save(device);
+}
@@ -171,6 +171,38 @@ TEST_CASE("testComments")
     TestStreamIsNextToken(pszBuffer, pszTokens);
 }
 
+TEST_CASE("testContiguousDevice")
+{
+    // Tokens scanned on contiguous memory devices must match the
+    // ones read character by character from non contiguous devices
+    string buffer = "613 0 obj% Comment after a token\r\n"
+        "<</Length 141/Filter[/ASCII85Decode/FlateDecode]>>\n"
+        "{ (string) <4E6F> }%\nendobj ";
+    buffer.append(PdfTokenizer::BufferSize + 10, 'a');
+    buffer.append(" % Trailing comment\n>");
+
+    SpanStreamDevice spanDevice(buffer);
+    istringstream stream(buffer);
+    StandardStreamDevice streamDevice(stream);
+    PdfTokenizer spanTokenizer;
+    PdfTokenizer streamTokenizer;
+    string_view spanToken;
+    string_view streamToken;
+    PdfTokenType spanTokenType;
+    PdfTokenType streamTokenType;
+    while (true)
+    {
+        bool gotToken = spanTokenizer.TryReadNextToken(spanDevice, spanToken, spanTokenType);
+        REQUIRE(gotToken == streamTokenizer.TryReadNextToken(streamDevice, streamToken, streamTokenType));
+        REQUIRE(spanDevice.GetPosition() == streamDevice.GetPosition());
+        if (!gotToken)
+            break;
+
+        REQUIRE(spanToken == streamToken);
+        REQUIRE(spanTokenType == streamTokenType);
+    }
+}
+
 TEST_CASE("testLocale")
 {
     // Test with a locale thate uses "," instead of "." for doubles 
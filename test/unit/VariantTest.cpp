@@ -169,6 +169,72 @@ TEST_CASE("testIsDirtyFalse")
     TestObjectsDirty(objBool, objNum, objReal, objStr, objRef, objArray, objDict, objStream, objVariant, false);
 }
 
+TEST_CASE("testDictionaryKeys")
+{
+    PdfDictionary dict;
+    const char* keys[] = { "Type", "Kids", "Annots", "Count", "Zeta", "Parent", "A", "Resources", "MediaBox" };
+    for (auto key : keys)
+        dict.AddKey(PdfName(key), PdfObject(PdfDictionary()));
+
+    // Keys are iterated in sorted order
+    REQUIRE(dict.GetSize() == std::size(keys));
+    string prev;
+    for (auto& pair : dict)
+    {
+        REQUIRE(prev < pair.first.GetString());
+        prev = pair.first.GetString();
+
+        // Values moved by insertions keep the parent
+        REQUIRE(pair.second.GetParent() == &dict);
+        REQUIRE(pair.second.GetDictionary().GetOwner() == &pair.second);
+    }
+
+    // Replacing an existing key doesn't add a new entry
+    dict.AddKey("Count", PdfObject(static_cast<int64_t>(5)));
+    REQUIRE(dict.GetSize() == std::size(keys));
+    REQUIRE(dict.GetKeyAs<int64_t>("Count") == 5);
+
+    REQUIRE(dict.HasKey("Annots"));
+    REQUIRE(!dict.HasKey("Annot"));
+    REQUIRE(dict.GetKey("Zet") == nullptr);
+    REQUIRE(dict.RemoveKey("Annots"));
+    REQUIRE(!dict.RemoveKey("Annots"));
+    REQUIRE(!dict.HasKey("Annots"));
+    REQUIRE(dict.GetSize() == std::size(keys) - 1);
+    for (auto& pair : dict)
+        REQUIRE(pair.second.GetParent() == &dict);
+
+    // Parsed dictionaries with duplicated keys keep the last value
+    PdfVariant variant;
+    PdfTokenizer tokenizer;
+    SpanStreamDevice device("<< /B 1 /A 2 /B 3 >>"sv);
+    tokenizer.ReadNextVariant(device, variant);
+    REQUIRE(variant.GetDictionary().GetSize() == 2);
+    REQUIRE(variant.GetDictionary().begin()->first == "A");
+    REQUIRE(variant.GetDictionary().GetKeyAs<int64_t>("B") == 3);
+
+    // Values don't move when other keys are added or removed
+    auto& value = dict.MustGetKey("Kids");
+    for (unsigned i = 0; i < 64; i++)
+        dict.AddKey(PdfName(utls::Format("Key{}", i)), PdfObject(static_cast<int64_t>(i)));
+
+    REQUIRE(dict.RemoveKey("A"));
+    REQUIRE(&dict.MustGetKey("Kids") == &value);
+    REQUIRE(value.GetParent() == &dict);
+    value.GetDictionary().AddKey("Test", PdfObject(true));
+    REQUIRE(dict.MustGetKey("Kids").GetDictionary().HasKey("Test"));
+
+    // Parsed keys are sorted
+    SpanStreamDevice device2("<< /C 1 /B 2 /A 3 >>"sv);
+    tokenizer.ReadNextVariant(device2, variant);
+    prev.clear();
+    for (auto& pair : variant.GetDictionary())
+    {
+        REQUIRE(prev < pair.first.GetString());
+        prev = pair.first.GetString();
+    }
+}
+
 void TestObjectsDirty(
     const PdfObject& objBool,
     const PdfObject& objNum,